@@ -1,7 +1,9 @@
 /*
 Fast Fourier/Cosine/Sine Transform
     dimension   :one
-    data length :power of 2
+    data length :power of 2 
+                 (cdft, rdft plans: also 2^a*3^b*5^c*7^d, mixed radix, 
+                  and any other length, chirp-z)
     decimation  :frequency
     radix       :split-radix
     data        :inplace
@@ -20,13 +22,49 @@ function prototypes
     void ddst(int, int, double *, int *, double *);
     void dfct(int, double *, double *, int *, double *);
     void dfst(int, double *, double *, int *, double *);
+    void cdfts(int, int, double *, double *, int *, double *);
+    void cdftst(int, int, double *, int, double *, int *, double *);
+    void rdftst(int, int, double *, int, double *, int *, double *);
+    void cdfto(int, int, double *, double *, int *, double *);
+    void rdftb(int, int, double *, int *, double *);
+    struct fft_plan *cdft_plan_create(int, int);
+    struct fft_plan *rdft_plan_create(int, int);
+    struct fft_plan *ddct_plan_create(int, int);
+    struct fft_plan *ddst_plan_create(int, int);
+    struct fft_plan *dfct_plan_create(int);
+    struct fft_plan *dfst_plan_create(int);
+    int fft_plan_exec(struct fft_plan *, double *);
+    int fft_plan_exec_many(struct fft_plan *, int, double *, int, int);
+    void fft_plan_destroy(struct fft_plan *);
+    void cdft_threads_set(int, int, int);
+    void cdft_threads_get(int *, int *, int *);
+    void cdft_threads_calibrate(void);
+    void cdft_threads_for(int, int, int, int, double *, 
+        void (*)(void *, int, int, double *), void *);
 macro definitions
     USE_CDFT_PTHREADS : default=not defined
         CDFT_THREADS_BEGIN_N  : must be >= 512, default=8192
         CDFT_4THREADS_BEGIN_N : must be >= 512, default=65536
-    USE_CDFT_WINTHREADS : default=not defined
+    USE_CDFT_WINTHREADS : default=not defined (Windows Vista or later)
         CDFT_THREADS_BEGIN_N  : must be >= 512, default=32768
         CDFT_4THREADS_BEGIN_N : must be >= 512, default=524288
+    CDFT_MAX_THREADS : default=0 (= number of processors)
+        upper limit of the threads working on one cdft; above 
+        CDFT_4THREADS_BEGIN_N the thread count doubles each time 
+        n grows by 4, up to this limit
+        (the worker threads are started on first use and kept 
+        for later transforms; the split-radix subtrees and the 
+        rows of the bit reversal are scheduled by work stealing)
+    USE_CDFT_SIMD : default=defined for gcc/clang on x86
+        x86 SSE2, AVX2/FMA, AVX-512 kernels, selected once at load 
+        time (cpuid, in a constructor); the environment variable 
+        CDFT_ISA=scalar, sse2, avx2 or avx512 limits the selection 
+        (for A/B testing)
+    NO_CDFT_SIMD : default=not defined
+        do not define USE_CDFT_SIMD (portable C only)
+    CDFTO_BEGIN_N : default=262144 
+        cdfto of length 2*n >= CDFTO_BEGIN_N bit reverses a[] -> b[] 
+        (USE_CDFT_SIMD, b[] on 64 bytes) instead of copying a[] 
 
 
 -------- Complex DFT (Discrete Fourier Transform) --------
@@ -276,6 +314,235 @@ macro definitions
         .
 
 
+-------- Complex DFT, split format (separate Re/Im arrays) --------
+    [definition]
+        <case1>
+            X[k] = sum_j=0^n-1 x[j]*exp(2*pi*i*j*k/n), 0<=k<n
+        <case2>
+            X[k] = sum_j=0^n-1 x[j]*exp(-2*pi*i*j*k/n), 0<=k<n
+    [usage]
+        <case1>
+            ip[0] = 0; // first time only
+            cdfts(n, 1, ar, ai, ip, w);
+        <case2>
+            ip[0] = 0; // first time only
+            cdfts(n, -1, ar, ai, ip, w);
+    [parameters]
+        n              :data length (int)
+                        n >= 1, n = power of 2
+                        (number of complex data, not 2*n as in cdft)
+        ar[0...n-1]    :input/output data, real part (double *)
+        ai[0...n-1]    :input/output data, imaginary part (double *)
+                        input data
+                            ar[j] = Re(x[j]), ai[j] = Im(x[j]), 0<=j<n
+                        output data
+                            ar[k] = Re(X[k]), ai[k] = Im(X[k]), 0<=k<n
+        ip[0]          :length of the cos/sin table (int *)
+        w[0...2*n-1]   :cos/sin table (double *)
+                        w[],ip[] are initialized if ip[0] != n.
+    [remark]
+        The butterflies (radix 4, and radix 2 for odd log2(n)) 
+        run on the split arrays; there is no interleaving copy 
+        and no shuffle in the SIMD kernel.
+        w[],ip[] are not compatible with the other routines.
+        Inverse of 
+            cdfts(n, -1, ar, ai, ip, w);
+        is 
+            cdfts(n, 1, ar, ai, ip, w);
+            for (j = 0; j <= n - 1; j++) {
+                ar[j] *= 1.0 / n;
+                ai[j] *= 1.0 / n;
+            }
+        .
+
+
+-------- Complex DFT / Real DFT, strided data --------
+    [usage]
+        ip[0] = 0; // first time only
+        cdftst(2*n, isgn, a, s, t, ip, w);
+            // same as cdft(2*n, isgn, x, ip, w) on 
+            // x[2*j] = a[j*s], x[2*j+1] = a[j*s+1], 0<=j<n
+        ip[0] = 0; // first time only
+        rdftst(n, isgn, a, s, t, ip, w);
+            // same as rdft(n, isgn, x, ip, w) on 
+            // x[j] = a[j*s], 0<=j<n
+    [parameters]
+        2*n, n, isgn   :as in cdft, rdft
+        a[...]         :input/output data (double *)
+        s              :distance between two data in a[] (int)
+                        cdftst: s >= 2 (s == 2: same as cdft)
+                        rdftst: s >= 1 (s == 1: same as rdft)
+        t[0...2*n-1]   :work area (double *) (rdftst: t[0...n-1])
+        ip[], w[]      :as in cdft, rdft (compatible)
+    [remark]
+        The first pass (radix 4 butterfly or rdft butterfly) 
+        reads a[] into t[] and the last pass (bit reversal or 
+        rdft butterfly) writes t[] back to a[]; there is no 
+        separate gather or scatter copy for 2*n, n > 32.
+
+
+-------- Complex DFT, out of place --------
+    [usage]
+        ip[0] = 0; // first time only
+        cdfto(2*n, isgn, a, b, ip, w);
+            // b[] = the output of cdft(2*n, isgn, a, ip, w)
+    [parameters]
+        2*n, isgn      :as in cdft
+        a[0...2*n-1]   :input data (double *)
+                        destroyed if the bit reversal a[] -> b[] 
+                        is used (see remark), else unchanged
+        b[0...2*n-1]   :output data (double *)
+        ip[], w[]      :as in cdft (compatible)
+    [remark]
+        Below CDFTO_BEGIN_N cdfto is a copy a[] -> b[] and cdft in 
+        b[]. From CDFTO_BEGIN_N up, with USE_CDFT_SIMD and b[] 
+        aligned on 64 bytes, the butterflies are done in a[] and 
+        the bit reversal a[] -> b[] (in tiles as in cdfts, with 
+        streaming stores) replaces both the copy and bitrv2, so 
+        one pass through the data is saved against copy + cdft. 
+        The saving only pays when the data does not fit in the 
+        cache, hence CDFTO_BEGIN_N.
+
+
+-------- Real DFT, bit reversed order --------
+    [usage]
+        ip[0] = 0; // first time only
+        rdftb(n, 1, a, ip, w);
+            // a[] = the output of rdft(n, 1, a, ip, w) in bit
+            //       reversed order
+        rdftb(n, -1, a, ip, w);
+            // inverse of rdftb(n, 1, a, ip, w) (scaled by n/2
+            // as in rdft)
+    [parameters]
+        n, isgn        :as in rdft
+        a[0...n-1]     :input/output data (double *)
+                        isgn >= 0:
+                            a[0], a[1] as in rdft, and
+                            a[2*p], a[2*p+1], 0<p<n/2,
+                            = a[2*k], a[2*k+1] of rdft,
+                            k: bit reverse of p (log2(n/2) bits)
+                        isgn < 0: input in the same order
+        ip[], w[]      :as in rdft (compatible with rdft, ddct, ...)
+    [remark]
+        No bit reversal is done: the forward transform is the
+        split-radix decimation in frequency of rdft without
+        bitrv2, and the inverse is a decimation in time that
+        takes the bit reversed input. For a convolution, which
+        only multiplies the spectra element by element,
+        rdftb(n, 1, ...), the products and rdftb(n, -1, ...)
+        give the same result as with rdft.
+        With threads, both directions are split over the worker 
+        threads as in cdft.
+
+
+-------- Plan (tables and kernel path prepared in advance) --------
+    [usage]
+        struct fft_plan *p;
+        p = rdft_plan_create(n, 1);  // NULL if out of memory
+        for (...) {
+            fft_plan_exec(p, a);     // same as rdft(n, 1, a, ip, w);
+        }
+        fft_plan_destroy(p);
+    [usage: many transforms of one size]
+        fft_plan_exec_many(p, howmany, a, stride, dist);
+            // same as
+            // for (i = 0; i < howmany; i++) {
+            //     gather x[] from &a[i * dist] with stride;
+            //     fft_plan_exec(p, x);
+            //     scatter x[] back;
+            // }
+    [parameters]
+        n, isgn        :as in cdft, rdft, ddct, ddst, dfct, dfst
+                        (isgn is fixed when the plan is created)
+                        cdft_plan_create, rdft_plan_create also take 
+                        any even n (2*n in cdft): 
+                        n = 2*2^a*3^b*5^c*7^d (a,b,c,d >= 0) 
+                        by mixed radix, the other n by chirp-z
+        a[...]         :input/output data (double *)
+        howmany        :number of transforms (int)
+        stride         :distance between two data of one 
+                        transform in a[] (int)
+                        the j-th datum is a[i * dist + j * stride] 
+                        (cdft: and a[i * dist + j * stride + 1] 
+                        as the real and imaginary part)
+                        contiguous data: 1 (cdft: 2)
+        dist           :distance between the first data of two 
+                        transforms in a[] (int)
+        fft_plan_exec, fft_plan_exec_many return 0, or -1 if a 
+        work area could not be allocated (then a[] is unchanged).
+    [remark]
+        The cos/sin table (ip[], 64-byte aligned w[]) is made 
+        once per kind and size and then shared, read-only, by 
+        all plans of that kind and size (it is kept until exit). 
+        The butterfly routines for n are chosen at creation, so 
+        fft_plan_exec does not check or regrow any table. 
+        Plans may be created and executed by any number of 
+        threads at the same time, and one plan may be executed 
+        by several threads at once: a plan is read-only during 
+        fft_plan_exec, and the work area t[] of dfct, dfst, mixed 
+        radix and chirp-z plans is allocated per call. The radix 
+        3, 5, 7 twiddles of mixed radix plans and the chirp-z 
+        tables are shared like the cos/sin table. 
+        With compilers other than GCC/Clang outside Windows, the 
+        tables are published with C11 <stdatomic.h>, else under a 
+        mutex with USE_CDFT_PTHREADS; a pre-C11 compiler without 
+        it must create plans one thread at a time.
+        A mixed radix plan runs radix 3, 5, 7 butterfly stages 
+        (decimation in frequency, depth first) down to blocks of 
+        length 2^a, which are transformed by the split-radix 
+        routines; the first stage writes to t[] and the blocks are 
+        stored back to a[] in digit reversed order, so there is no 
+        separate permutation pass.
+        A chirp-z (Bluestein) plan computes the DFT of length n/2 
+        as a cyclic convolution of length 2^m >= n-1 by two 
+        split-radix FFTs of 2^m points; the chirp and the FFT of 
+        the convolution kernel are made once per length and sign 
+        and shared by the plans like the cos/sin tables; t[] 
+        holds 2*2^m doubles.
+        fft_plan_exec_many runs the transforms back to back on 
+        the same table; non-contiguous data are copied through a 
+        work area. With threads, a batch of transforms of 
+        n <= begin_n of cdft_threads_set is split into ranges 
+        of transforms that are run by the worker threads (the 
+        larger ones are threaded one by one as in cdft).
+
+
+-------- Thread settings (USE_CDFT_PTHREADS, USE_CDFT_WINTHREADS) --------
+    [usage]
+        cdft_threads_set(begin_n, begin4_n, max_threads);
+        cdft_threads_get(&begin_n, &begin4_n, &max_threads);
+        cdft_threads_calibrate();
+    [parameters]
+        begin_n        :cdft of length n > begin_n is threaded (int)
+                        (initial value: CDFT_THREADS_BEGIN_N)
+        begin4_n       :n > begin4_n uses 4 or more threads (int)
+                        (initial value: CDFT_4THREADS_BEGIN_N)
+        max_threads    :upper limit of the threads (int)
+                        0 means the number of processors
+                        (initial value: CDFT_MAX_THREADS)
+        cdft_threads_set leaves the values < 0 (begin_n and 
+        begin4_n: <= 0) unchanged.
+    [remark]
+        The environment variables CDFT_THREADS_BEGIN_N, 
+        CDFT_4THREADS_BEGIN_N and CDFT_MAX_THREADS override the 
+        initial values; they are read at the first transform.
+        cdft_threads_calibrate times cdft of n <= 2^21 with 1, 2 
+        and 4+ threads on this machine and sets begin_n and 
+        begin4_n to the crossover points (a few seconds).
+        Do not call cdft_threads_set or cdft_threads_calibrate 
+        while other threads are running transforms.
+        Without threads, cdft_threads_get returns INT_MAX, 
+        INT_MAX, 1 and the other two do nothing.
+    [usage: items of a multi-dimensional transform]
+        cdft_threads_for(n, m, nitem, nwk, t, func, arg);
+            // runs func(arg, k0, k1, tk) on ranges k0...k1-1 
+            // of the items 0...nitem-1 on the worker threads, 
+            // if n * m * nitem is large enough and n <= begin_n 
+            // (an item: m transforms of data length n); each 
+            // range has a work area tk[0...nwk-1] (the first 
+            // one is t). Without threads, func(arg, 0, nitem, t).
+
+
 Appendix :
     The cos/sin table is recalculated when the larger table required.
     w[] and ip[] are compatible with all routines.
@@ -635,6 +902,193 @@ void dfst(int n, double *a, double *t, int *ip, double *w)
 }
 
 
+void cdfts(int n, int isgn, double *ar, double *ai, int *ip, double *w)
+{
+    void makewts(int n, int *ip, double *w);
+    void cftssub(int n, double *ar, double *ai, int isgn, double *w);
+    
+    if (n != ip[0]) {
+        makewts(n, ip, w);
+    }
+    if (n > 1) {
+        cftssub(n, ar, ai, isgn, w);
+    }
+}
+
+
+void cdftst(int n, int isgn, double *a, int s, double *t, int *ip, 
+    double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    void cdft(int n, int isgn, double *a, int *ip, double *w);
+    void cftsub_st(int n, int isgn, double *ar, double *ai, int s, 
+        double *b, int nw, double *w);
+    void bitrv2_st(int n, int isgn, double *b, double *ar, double *ai, 
+        int s);
+    int j, nw;
+    
+    if (s == 2) {
+        cdft(n, isgn, a, ip, w);
+        return;
+    }
+    nw = ip[0];
+    if (n > (nw << 2)) {
+        nw = n >> 2;
+        makewt(nw, ip, w);
+    }
+    if (n > 32) {
+        cftsub_st(n, isgn, a, a + 1, s, t, nw, w);
+        bitrv2_st(n, isgn, t, a, a + 1, s);
+        return;
+    }
+    for (j = 0; j < n; j += 2) {
+        t[j] = a[(long) (j >> 1) * s];
+        t[j + 1] = a[(long) (j >> 1) * s + 1];
+    }
+    cdft(n, isgn, t, ip, w);
+    for (j = 0; j < n; j += 2) {
+        a[(long) (j >> 1) * s] = t[j];
+        a[(long) (j >> 1) * s + 1] = t[j + 1];
+    }
+}
+
+
+void rdftst(int n, int isgn, double *a, int s, double *t, int *ip, 
+    double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    void makect(int nc, int *ip, double *c);
+    void rdft(int n, int isgn, double *a, int *ip, double *w);
+    void cftsub_st(int n, int isgn, double *ar, double *ai, int s, 
+        double *b, int nw, double *w);
+    void bitrv2_st(int n, int isgn, double *b, double *ar, double *ai, 
+        int s);
+    void rftfsub_st(int n, double *b, int nc, double *c, double *a, 
+        int s);
+    void rftbsub_st(int n, double *a, int s, int nc, double *c, 
+        double *b);
+#ifdef USE_CDFT_THREADS
+    void bitrv2_th(int n, int *ip, double *a);
+#else
+    void bitrv2(int n, int *ip, double *a);
+#endif /* USE_CDFT_THREADS */
+    int j, nw, nc;
+    
+    if (s == 1) {
+        rdft(n, isgn, a, ip, w);
+        return;
+    }
+    nw = ip[0];
+    if (n > (nw << 2)) {
+        nw = n >> 2;
+        makewt(nw, ip, w);
+    }
+    nc = ip[1];
+    if (n > (nc << 2)) {
+        nc = n >> 2;
+        makect(nc, ip, w + nw);
+    }
+    if (n <= 32) {
+        for (j = 0; j < n; j++) {
+            t[j] = a[(long) j * s];
+        }
+        rdft(n, isgn, t, ip, w);
+        for (j = 0; j < n; j++) {
+            a[(long) j * s] = t[j];
+        }
+    } else if (isgn >= 0) {
+        cftsub_st(n, 1, a, a + s, 2 * s, t, nw, w);
+#ifdef USE_CDFT_THREADS
+        bitrv2_th(n, ip, t);
+#else
+        bitrv2(n, ip, t);
+#endif /* USE_CDFT_THREADS */
+        rftfsub_st(n, t, nc, w + nw, a, s);
+    } else {
+        rftbsub_st(n, a, s, nc, w + nw, t);
+        cftsub_st(n, -1, t, t + 1, 2, t, nw, w);
+        bitrv2_st(n, -1, t, a, a + s, 2 * s);
+    }
+}
+
+
+#ifndef CDFTO_BEGIN_N  /* cdfto: bit reversal a[] -> b[] from this n */
+#define CDFTO_BEGIN_N 262144
+#endif
+
+
+void cdfto(int n, int isgn, double *a, double *b, int *ip, double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    void cdft(int n, int isgn, double *a, int *ip, double *w);
+    int cftsubo(int n, int isgn, double *a, double *b, int nw, double *w);
+    int j, nw;
+    
+    if (n >= CDFTO_BEGIN_N && n > 32) {
+        nw = ip[0];
+        if (n > (nw << 2)) {
+            nw = n >> 2;
+            makewt(nw, ip, w);
+        }
+        if (cftsubo(n, isgn, a, b, nw, w) == 0) {
+            return;
+        }
+    }
+    for (j = 0; j < n; j++) {
+        b[j] = a[j];
+    }
+    cdft(n, isgn, b, ip, w);
+}
+
+
+void rdftb(int n, int isgn, double *a, int *ip, double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    void makect(int nc, int *ip, double *c);
+    void cftfsubr(int n, double *a, int nw, double *w);
+    void cftbsubr(int n, double *a, int nw, double *w);
+    void rftfsubr(int n, double *a, int nc, double *c);
+    void rftbsubr(int n, double *a, int nc, double *c);
+    void bitrvr(int n, double *a);
+    int nw, nc;
+    double xi;
+    
+    if (n <= 32) {
+        /* rdft and an explicit reordering */
+        if (isgn < 0) {
+            bitrvr(n, a);
+        }
+        rdft(n, isgn, a, ip, w);
+        if (isgn >= 0) {
+            bitrvr(n, a);
+        }
+        return;
+    }
+    nw = ip[0];
+    if (n > (nw << 2)) {
+        nw = n >> 2;
+        makewt(nw, ip, w);
+    }
+    nc = ip[1];
+    if (n > (nc << 2)) {
+        nc = n >> 2;
+        makect(nc, ip, w + nw);
+    }
+    if (isgn >= 0) {
+        cftfsubr(n, a, nw, w);
+        rftfsubr(n, a, nc, w + nw);
+        xi = a[0] - a[1];
+        a[0] += a[1];
+        a[1] = xi;
+    } else {
+        a[1] = 0.5 * (a[0] - a[1]);
+        a[0] -= a[1];
+        rftbsubr(n, a, nc, w + nw);
+        cftbsubr(n, a, nw, w);
+    }
+}
+
+
 /* -------- initializing routines -------- */
 
 
@@ -740,6 +1194,30 @@ void makect(int nc, int *ip, double *c)
 }
 
 
+void makewts(int n, int *ip, double *w)
+{
+    int j, l, m, s;
+    double delta;
+    
+    ip[0] = n;
+    delta = 8 * atan(1.0) / n;
+    s = 1;
+    for (l = n; l >= 8; l >>= 2) {
+        m = l >> 2;
+        for (j = 0; j < m; j++) {
+            w[j] = cos(delta * j * s);
+            w[m + j] = sin(delta * j * s);
+            w[2 * m + j] = cos(2 * delta * j * s);
+            w[3 * m + j] = sin(2 * delta * j * s);
+            w[4 * m + j] = cos(3 * delta * j * s);
+            w[5 * m + j] = sin(3 * delta * j * s);
+        }
+        w += 6 * m;
+        s <<= 2;
+    }
+}
+
+
 /* -------- child routines -------- */
 
 
@@ -754,6 +1232,7 @@ void makect(int nc, int *ip, double *c)
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #define cdft_thread_t pthread_t
 #define cdft_thread_create(thp,func,argp) { \
     if (pthread_create(thp, NULL, func, (void *) argp) != 0) { \
@@ -761,12 +1240,19 @@ void makect(int nc, int *ip, double *c)
         exit(1); \
     } \
 }
-#define cdft_thread_wait(th) { \
-    if (pthread_join(th, NULL) != 0) { \
-        fprintf(stderr, "cdft thread error\n"); \
-        exit(1); \
-    } \
-}
+#define cdft_thread_detach(th) pthread_detach(th)
+#define cdft_mutex_t pthread_mutex_t
+#define CDFT_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define cdft_mutex_lock(mp) pthread_mutex_lock(mp)
+#define cdft_mutex_unlock(mp) pthread_mutex_unlock(mp)
+#define cdft_cond_t pthread_cond_t
+#define CDFT_COND_INITIALIZER PTHREAD_COND_INITIALIZER
+#define cdft_cond_wait(cp,mp) pthread_cond_wait(cp, mp)
+#define cdft_cond_signal(cp) pthread_cond_signal(cp)
+#define cdft_cond_broadcast(cp) pthread_cond_broadcast(cp)
+#define cdft_once_t pthread_once_t
+#define CDFT_ONCE_INIT PTHREAD_ONCE_INIT
+#define cdft_once(op,func) pthread_once(op, func)
 #endif /* USE_CDFT_PTHREADS */
 
 
@@ -790,13 +1276,100 @@ void makect(int nc, int *ip, double *c)
         exit(1); \
     } \
 }
-#define cdft_thread_wait(th) { \
-    WaitForSingleObject(th, INFINITE); \
-    CloseHandle(th); \
+#define cdft_thread_detach(th) CloseHandle(th)
+#define cdft_mutex_t SRWLOCK
+#define CDFT_MUTEX_INITIALIZER SRWLOCK_INIT
+#define cdft_mutex_lock(mp) AcquireSRWLockExclusive(mp)
+#define cdft_mutex_unlock(mp) ReleaseSRWLockExclusive(mp)
+#define cdft_cond_t CONDITION_VARIABLE
+#define CDFT_COND_INITIALIZER CONDITION_VARIABLE_INIT
+#define cdft_cond_wait(cp,mp) SleepConditionVariableSRW(cp, mp, INFINITE, 0)
+#define cdft_cond_signal(cp) WakeConditionVariable(cp)
+#define cdft_cond_broadcast(cp) WakeAllConditionVariable(cp)
+#define cdft_once_t INIT_ONCE
+#define CDFT_ONCE_INIT INIT_ONCE_STATIC_INIT
+#define cdft_once(op,func) \
+    InitOnceExecuteOnce(op, cdft_once_call, (PVOID) (func), NULL)
+static BOOL CALLBACK cdft_once_call(PINIT_ONCE op, PVOID func, PVOID *ctx)
+{
+    (*(void (*)(void)) func)();
+    return TRUE;
 }
 #endif /* USE_CDFT_WINTHREADS */
 
 
+#ifdef USE_CDFT_THREADS
+#ifndef CDFT_MAX_THREADS
+#define CDFT_MAX_THREADS 0
+#endif
+/* 
+   run-time settings: the environment is read once, by the first 
+   transform or cdft_threads_set/get (cdft_threads_once) 
+*/
+int cdft_threads_begin_n = CDFT_THREADS_BEGIN_N;
+int cdft_4threads_begin_n = CDFT_4THREADS_BEGIN_N;
+int cdft_max_threads = CDFT_MAX_THREADS;
+cdft_once_t cdft_threads_once = CDFT_ONCE_INIT;
+#endif /* USE_CDFT_THREADS */
+
+
+#if !defined(USE_CDFT_SIMD) && !defined(NO_CDFT_SIMD) && \
+    defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define USE_CDFT_SIMD
+#endif
+#ifdef USE_CDFT_SIMD
+#include <stdlib.h>
+#include <string.h>
+#include <immintrin.h>
+typedef struct cdft_simd_st {
+    void (*cftmdl1)(int n, double *a, double *w);
+    void (*cftmdl2)(int n, double *a, double *w);
+    void (*cftf161)(double *a, double *w);
+    void (*cftf162)(double *a, double *w);
+    void (*cftf081)(double *a, double *w);
+    void (*cftf082)(double *a, double *w);
+    void (*cftsmdl)(int n, int l, double *ar, double *ai, int isgn, 
+        double *w);
+    void (*cftbmdlr)(int n, double *a, double *w);
+} cdft_simd_t;
+/* kernel table, NULL entries use the C code; set once by 
+   cdft_simd_select before main (the scalar table until then) */
+static const cdft_simd_t cdft_simd_scalar = {
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+const cdft_simd_t *cdft_simd = &cdft_simd_scalar;
+#define cdft_target(isa) __attribute__((target(isa)))
+/* w * x and conj(w) * x, 1 complex number per __m128d 
+   (sgn = {-0.0, 0.0}) */
+#define cdft_sse2_cmul(w, x, sgn) _mm_add_pd( \
+    _mm_mul_pd(x, _mm_unpacklo_pd(w, w)), _mm_xor_pd( \
+    _mm_mul_pd(_mm_shuffle_pd(x, x, 1), _mm_unpackhi_pd(w, w)), sgn))
+#define cdft_sse2_cmulconj(w, x, sgn) _mm_sub_pd( \
+    _mm_mul_pd(x, _mm_unpacklo_pd(w, w)), _mm_xor_pd( \
+    _mm_mul_pd(_mm_shuffle_pd(x, x, 1), _mm_unpackhi_pd(w, w)), sgn))
+/* i * x */
+#define cdft_sse2_imul(x, sgn) _mm_xor_pd(_mm_shuffle_pd(x, x, 1), sgn)
+#define cdft_sse2_swap(x) _mm_shuffle_pd(x, x, 1)
+/* w * x and conj(w) * x, 2 complex numbers per __m256d */
+#define cdft_avx2_cmul(w, x) _mm256_fmaddsub_pd(x, \
+    _mm256_movedup_pd(w), \
+    _mm256_mul_pd(_mm256_permute_pd(x, 0x5), _mm256_permute_pd(w, 0xf)))
+#define cdft_avx2_cmulconj(w, x) _mm256_fmsubadd_pd(x, \
+    _mm256_movedup_pd(w), \
+    _mm256_mul_pd(_mm256_permute_pd(x, 0x5), _mm256_permute_pd(w, 0xf)))
+/* i * x (sgn = {-0.0, 0.0, -0.0, 0.0}) */
+#define cdft_avx2_imul(x, sgn) _mm256_xor_pd(_mm256_permute_pd(x, 0x5), sgn)
+/* w * x, 4 complex numbers per __m512d */
+#define cdft_avx512_cmul(w, x) _mm512_fmaddsub_pd(x, \
+    _mm512_movedup_pd(w), \
+    _mm512_mul_pd(_mm512_permute_pd(x, 0x55), _mm512_permute_pd(w, 0xff)))
+/* i * x (z = zero) */
+#define cdft_avx512_imul(x, z) \
+    _mm512_mask_sub_pd(_mm512_permute_pd(x, 0x55), 0x55, z, \
+    _mm512_permute_pd(x, 0x55))
+#endif /* USE_CDFT_SIMD */
+
+
 void cftfsub(int n, double *a, int *ip, int nw, double *w)
 {
     void bitrv2(int n, int *ip, double *a);
@@ -812,13 +1385,18 @@ void cftfsub(int n, double *a, int *ip, int nw, double *w)
     void cftx020(double *a);
 #ifdef USE_CDFT_THREADS
     void cftrec4_th(int n, double *a, int nw, double *w);
+    void bitrv2_th(int n, int *ip, double *a);
+    void cdft_threads_init(void);
 #endif /* USE_CDFT_THREADS */
     
+#ifdef USE_CDFT_THREADS
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+#endif /* USE_CDFT_THREADS */
     if (n > 8) {
         if (n > 32) {
             cftf1st(n, a, &w[nw - (n >> 2)]);
 #ifdef USE_CDFT_THREADS
-            if (n > CDFT_THREADS_BEGIN_N) {
+            if (n > 512 && n > cdft_threads_begin_n) {
                 cftrec4_th(n, a, nw, w);
             } else 
 #endif /* USE_CDFT_THREADS */
@@ -829,7 +1407,11 @@ void cftfsub(int n, double *a, int *ip, int nw, double *w)
             } else {
                 cftfx41(n, a, nw, w);
             }
+#ifdef USE_CDFT_THREADS
+            bitrv2_th(n, ip, a);
+#else
             bitrv2(n, ip, a);
+#endif /* USE_CDFT_THREADS */
         } else if (n == 32) {
             cftf161(a, &w[nw - 8]);
             bitrv216(a);
@@ -860,13 +1442,18 @@ void cftbsub(int n, double *a, int *ip, int nw, double *w)
     void cftx020(double *a);
 #ifdef USE_CDFT_THREADS
     void cftrec4_th(int n, double *a, int nw, double *w);
+    void bitrv2conj_th(int n, int *ip, double *a);
+    void cdft_threads_init(void);
 #endif /* USE_CDFT_THREADS */
     
+#ifdef USE_CDFT_THREADS
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+#endif /* USE_CDFT_THREADS */
     if (n > 8) {
         if (n > 32) {
             cftb1st(n, a, &w[nw - (n >> 2)]);
 #ifdef USE_CDFT_THREADS
-            if (n > CDFT_THREADS_BEGIN_N) {
+            if (n > 512 && n > cdft_threads_begin_n) {
                 cftrec4_th(n, a, nw, w);
             } else 
 #endif /* USE_CDFT_THREADS */
@@ -877,7 +1464,11 @@ void cftbsub(int n, double *a, int *ip, int nw, double *w)
             } else {
                 cftfx41(n, a, nw, w);
             }
+#ifdef USE_CDFT_THREADS
+            bitrv2conj_th(n, ip, a);
+#else
             bitrv2conj(n, ip, a);
+#endif /* USE_CDFT_THREADS */
         } else if (n == 32) {
             cftf161(a, &w[nw - 8]);
             bitrv216neg(a);
@@ -893,7 +1484,167 @@ void cftbsub(int n, double *a, int *ip, int nw, double *w)
 }
 
 
+void cftfsubr(int n, double *a, int nw, double *w)
+{
+    void cftf1st(int n, double *a, double *w);
+    void cftrec4(int n, double *a, int nw, double *w);
+    void cftleaf(int n, int isplt, double *a, int nw, double *w);
+    void cftfx41(int n, double *a, int nw, double *w);
+#ifdef USE_CDFT_THREADS
+    void cftrec4_th(int n, double *a, int nw, double *w);
+    void cdft_threads_init(void);
+#endif /* USE_CDFT_THREADS */
+    
+#ifdef USE_CDFT_THREADS
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+#endif /* USE_CDFT_THREADS */
+    /* cftfsub (n > 32) without bitrv2 */
+    cftf1st(n, a, &w[nw - (n >> 2)]);
+#ifdef USE_CDFT_THREADS
+    if (n > 512 && n > cdft_threads_begin_n) {
+        cftrec4_th(n, a, nw, w);
+    } else 
+#endif /* USE_CDFT_THREADS */
+    if (n > 512) {
+        cftrec4(n, a, nw, w);
+    } else if (n > 128) {
+        cftleaf(n, 1, a, nw, w);
+    } else {
+        cftfx41(n, a, nw, w);
+    }
+}
+
+
+void cftbsubr(int n, double *a, int nw, double *w)
+{
+    void cftbrecr(int n, double *a, int nw, double *w);
+#ifdef USE_CDFT_THREADS
+    void cftbrecr_th(int n, double *a, int nw, double *w);
+    void cdft_threads_init(void);
+#endif /* USE_CDFT_THREADS */
+    
+#ifdef USE_CDFT_THREADS
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+#endif /* USE_CDFT_THREADS */
+    /* cftbsub (n > 32) of the input in bit reversed order */
+#ifdef USE_CDFT_THREADS
+    if (n > 512 && n > cdft_threads_begin_n) {
+        cftbrecr_th(n, a, nw, w);
+    } else 
+#endif /* USE_CDFT_THREADS */
+    cftbrecr(n, a, nw, w);
+}
+
+
+int cftsubo(int n, int isgn, double *a, double *b, int nw, double *w)
+{
+#ifdef USE_CDFT_SIMD
+    void cftf1st(int n, double *a, double *w);
+    void cftb1st(int n, double *a, double *w);
+    void cftrec4(int n, double *a, int nw, double *w);
+    void cftleaf(int n, int isplt, double *a, int nw, double *w);
+    void cftfx41(int n, double *a, int nw, double *w);
+    void bitrv2o(int n, int isgn, double *a, double *b);
+#ifdef USE_CDFT_THREADS
+    void cftrec4_th(int n, double *a, int nw, double *w);
+    void cdft_threads_init(void);
+#endif /* USE_CDFT_THREADS */
+    
+    /* a[] is left as it is (return -1) if b[] can not take the 
+       streaming stores of bitrv2o (not on 64 bytes, no SSE2 kernels) */
+    if (((size_t) b & 63) != 0 || cdft_simd->cftmdl1 == NULL) {
+        return -1;
+    }
+#ifdef USE_CDFT_THREADS
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+#endif /* USE_CDFT_THREADS */
+    /* cftfsub, cftbsub (n > 32) in a[], the bit reversal a[] -> b[] */
+    if (isgn >= 0) {
+        cftf1st(n, a, &w[nw - (n >> 2)]);
+    } else {
+        cftb1st(n, a, &w[nw - (n >> 2)]);
+    }
+#ifdef USE_CDFT_THREADS
+    if (n > 512 && n > cdft_threads_begin_n) {
+        cftrec4_th(n, a, nw, w);
+    } else 
+#endif /* USE_CDFT_THREADS */
+    if (n > 512) {
+        cftrec4(n, a, nw, w);
+    } else if (n > 128) {
+        cftleaf(n, 1, a, nw, w);
+    } else {
+        cftfx41(n, a, nw, w);
+    }
+    bitrv2o(n, isgn, a, b);
+    return 0;
+#else
+    return -1;
+#endif /* USE_CDFT_SIMD */
+}
+
+
+#ifdef USE_CDFT_SIMD
+__attribute__((constructor)) void cdft_simd_select(void)
+{
+    void cftmdl1_sse2(int n, double *a, double *w);
+    void cftmdl2_sse2(int n, double *a, double *w);
+    void cftmdl1_avx2(int n, double *a, double *w);
+    void cftmdl2_avx2(int n, double *a, double *w);
+    void cftf161_avx512(double *a, double *w);
+    void cftf162_avx512(double *a, double *w);
+    void cftf081_avx512(double *a, double *w);
+    void cftf082_avx512(double *a, double *w);
+    void cftsmdl_avx2(int n, int l, double *ar, double *ai, int isgn, 
+        double *w);
+    void cftbmdlr_avx2(int n, double *a, double *w);
+    static const char *isaname[4] = {"scalar", "sse2", "avx2", "avx512"};
+    static const cdft_simd_t isatab[4] = {
+        {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL}, 
+        {cftmdl1_sse2, cftmdl2_sse2, NULL, NULL, NULL, NULL, NULL, NULL}, 
+        {cftmdl1_avx2, cftmdl2_avx2, NULL, NULL, NULL, NULL, 
+            cftsmdl_avx2, cftbmdlr_avx2}, 
+        {cftmdl1_avx2, cftmdl2_avx2, 
+            cftf161_avx512, cftf162_avx512, 
+            cftf081_avx512, cftf082_avx512, cftsmdl_avx2, cftbmdlr_avx2}
+    };
+    int isa, i;
+    char *env;
+    
+    __builtin_cpu_init();
+    isa = 0;
+    if (__builtin_cpu_supports("sse2")) {
+        isa = 1;
+        if (__builtin_cpu_supports("avx2") && 
+            __builtin_cpu_supports("fma")) {
+            isa = 2;
+            if (__builtin_cpu_supports("avx512f")) {
+                isa = 3;
+            }
+        }
+    }
+    env = getenv("CDFT_ISA");
+    if (env != NULL) {
+        for (i = 0; i < isa; i++) {
+            if (strcmp(env, isaname[i]) == 0) {
+                isa = i;
+            }
+        }
+    }
+    cdft_simd = &isatab[isa];
+}
+#endif /* USE_CDFT_SIMD */
+
+
 void bitrv2(int n, int *ip, double *a)
+{
+    void bitrv2x(int n, int *ip, double *a, int ks, int ke);
+    
+    bitrv2x(n, ip, a, 0, n);
+}
+
+
+void bitrv2x(int n, int *ip, double *a, int ks, int ke)
 {
     int j, j1, k, k1, l, m, nh, nm;
     double xr, xi, yr, yi;
@@ -902,10 +1653,13 @@ void bitrv2(int n, int *ip, double *a)
     for (l = n >> 2; l > 8; l >>= 2) {
         m <<= 1;
     }
+    if (ke > m) {
+        ke = m;
+    }
     nh = n >> 1;
     nm = 4 * m;
     if (l == 8) {
-        for (k = 0; k < m; k++) {
+        for (k = ks; k < ke; k++) {
             for (j = 0; j < k; j++) {
                 j1 = 4 * j + 2 * ip[m + k];
                 k1 = 4 * k + 2 * ip[m + j];
@@ -1131,7 +1885,7 @@ void bitrv2(int n, int *ip, double *a)
             a[k1 + 1] = xi;
         }
     } else {
-        for (k = 0; k < m; k++) {
+        for (k = ks; k < ke; k++) {
             for (j = 0; j < k; j++) {
                 j1 = 4 * j + ip[m + k];
                 k1 = 4 * k + ip[m + j];
@@ -1241,6 +1995,14 @@ void bitrv2(int n, int *ip, double *a)
 
 
 void bitrv2conj(int n, int *ip, double *a)
+{
+    void bitrv2conjx(int n, int *ip, double *a, int ks, int ke);
+    
+    bitrv2conjx(n, ip, a, 0, n);
+}
+
+
+void bitrv2conjx(int n, int *ip, double *a, int ks, int ke)
 {
     int j, j1, k, k1, l, m, nh, nm;
     double xr, xi, yr, yi;
@@ -1249,10 +2011,13 @@ void bitrv2conj(int n, int *ip, double *a)
     for (l = n >> 2; l > 8; l >>= 2) {
         m <<= 1;
     }
+    if (ke > m) {
+        ke = m;
+    }
     nh = n >> 1;
     nm = 4 * m;
     if (l == 8) {
-        for (k = 0; k < m; k++) {
+        for (k = ks; k < ke; k++) {
             for (j = 0; j < k; j++) {
                 j1 = 4 * j + 2 * ip[m + k];
                 k1 = 4 * k + 2 * ip[m + j];
@@ -1482,7 +2247,7 @@ void bitrv2conj(int n, int *ip, double *a)
             a[k1 + 3] = -a[k1 + 3];
         }
     } else {
-        for (k = 0; k < m; k++) {
+        for (k = ks; k < ke; k++) {
             for (j = 0; j < k; j++) {
                 j1 = 4 * j + ip[m + k];
                 k1 = 4 * k + ip[m + j];
@@ -2194,107 +2959,577 @@ void cftb1st(int n, double *a, double *w)
 
 
 #ifdef USE_CDFT_THREADS
-struct cdft_arg_st {
-    int n0;
-    int n;
-    double *a;
+#define CDFT_DEQUE_SIZE 64
+
+struct cdft_job_st {
     int nw;
     double *w;
+    int *ip;
+    int grain;
+    int nthread;
+    int pending;
+    struct fft_plan *plan;
+    int stride;
+    int dist;
+    void (*loop)(void *arg, int k0, int k1, double *t);
+    void *arg;
+};
+typedef struct cdft_job_st cdft_job_t;
+
+/* 
+   a task of cftrec_task is a split-radix subtree: the butterfly 
+   stage of its root (cftmdl1 if isplt != 0, cftmdl2 otherwise) 
+   and then the four subtrees of length n/4; 
+   a task of cftbrec_task is a subtree of cftbrecr: the subtrees 
+   of length n/2, n/4, n/4 and then the butterfly stage of its root 
+   (cdft_pool_join waits for the subtrees run by other threads); 
+   a task of bitrv2_task, bitrv2conj_task is the rows k0...k1-1 
+   of the bit reversal; 
+   a task of fft_batch_task is the transforms k0...k1-1 of 
+   fft_plan_exec_many with the work area b; 
+   a task of cdft_loop_task is the items k0...k1-1 of 
+   cdft_threads_for with the work area b 
+*/
+struct cdft_task_st {
+    void (*func)(int id, struct cdft_task_st *tk);
+    int n;
+    int isplt;
+    int mdl;
+    int k0;
+    int k1;
+    double *a;
+    double *b;
+    cdft_job_t *job;
+};
+typedef struct cdft_task_st cdft_task_t;
+
+/* 
+   one deque per worker thread and per calling thread: the owner 
+   pushes and pops at the tail, the others steal from the head 
+*/
+struct cdft_deque_st {
+    int used;
+    int head;
+    int tail;
+    cdft_task_t task[CDFT_DEQUE_SIZE];
 };
-typedef struct cdft_arg_st cdft_arg_t;
+typedef struct cdft_deque_st cdft_deque_t;
+
+/* 
+   persistent worker threads, started on first use and parked 
+   on cdft_pool_work between transforms; all fields below are 
+   guarded by cdft_pool_mutex 
+*/
+cdft_mutex_t cdft_pool_mutex = CDFT_MUTEX_INITIALIZER;
+cdft_cond_t cdft_pool_work = CDFT_COND_INITIALIZER;
+cdft_cond_t cdft_pool_done = CDFT_COND_INITIALIZER;
+cdft_deque_t *cdft_pool_deque = NULL;
+int cdft_pool_ndeque = 0;
+int cdft_pool_nthread = 0;
 
 
 void cftrec4_th(int n, double *a, int nw, double *w)
 {
-    void *cftrec1_th(void *p);
-    void *cftrec2_th(void *p);
-    int i, idiv4, m, nthread;
-    cdft_thread_t th[4];
-    cdft_arg_t ag[4];
+    void cftrec4(int n, double *a, int nw, double *w);
+    int cdft_threads_n(int n);
+    int cdft_pool_open(int *nthread);
+    void cdft_pool_close(int id, cdft_job_t *job);
+    void cftrec_task(int id, cdft_task_t *tk);
+    int id, nthread;
+    cdft_job_t job;
+    cdft_task_t tk;
     
-    nthread = 2;
-    idiv4 = 0;
-    m = n >> 1;
-    if (n > CDFT_4THREADS_BEGIN_N) {
-        nthread = 4;
-        idiv4 = 1;
-        m >>= 1;
+    nthread = cdft_threads_n(n);
+    id = cdft_pool_open(&nthread);
+    if (id < 0) {
+        cftrec4(n, a, nw, w);
+        return;
     }
-    for (i = 0; i < nthread; i++) {
-        ag[i].n0 = n;
-        ag[i].n = m;
-        ag[i].a = &a[i * m];
-        ag[i].nw = nw;
-        ag[i].w = w;
-        if (i != idiv4) {
-            cdft_thread_create(&th[i], cftrec1_th, &ag[i]);
+    job.nw = nw;
+    job.w = w;
+    job.grain = n / (nthread << 4);
+    if (job.grain < 2048) {
+        job.grain = 2048;
+    }
+    job.nthread = nthread;
+    job.pending = 0;
+    tk.func = cftrec_task;
+    tk.n = n;
+    tk.isplt = 1;
+    tk.mdl = 0;
+    tk.a = a;
+    tk.job = &job;
+    cftrec_task(id, &tk);
+    cdft_pool_close(id, &job);
+}
+
+
+void cftrec_task(int id, cdft_task_t *tk)
+{
+    void cftrecx(int n, int isplt, double *a, int nw, double *w);
+    void cftmdl1(int n, double *a, double *w);
+    void cftmdl2(int n, double *a, double *w);
+    int cdft_pool_push(int id, cdft_task_t *tk);
+    int i, m, n, nw, pushed[4];
+    double *a, *w;
+    cdft_task_t ch[4];
+    
+    n = tk->n;
+    a = tk->a;
+    nw = tk->job->nw;
+    w = tk->job->w;
+    if (tk->mdl != 0) {
+        if (tk->isplt != 0) {
+            cftmdl1(n, a, &w[nw - (n >> 1)]);
         } else {
-            cdft_thread_create(&th[i], cftrec2_th, &ag[i]);
+            cftmdl2(n, a, &w[nw - n]);
+        }
+    }
+    m = n >> 2;
+    if (m < tk->job->grain) {
+        cftrecx(n, tk->isplt, a, nw, w);
+        return;
+    }
+    for (i = 0; i < 4; i++) {
+        ch[i].func = cftrec_task;
+        ch[i].n = m;
+        ch[i].isplt = 1;
+        ch[i].mdl = 1;
+        ch[i].a = &a[i * m];
+        ch[i].job = tk->job;
+    }
+    ch[1].isplt = 0;
+    ch[3].isplt = tk->isplt;
+    cdft_mutex_lock(&cdft_pool_mutex);
+    for (i = 3; i > 0; i--) {
+        pushed[i] = cdft_pool_push(id, &ch[i]);
+        /* wake no more workers than the job asked for */
+        if (pushed[i] != 0 && ++tk->job->pending < tk->job->nthread) {
+            cdft_cond_signal(&cdft_pool_work);
         }
     }
-    for (i = 0; i < nthread; i++) {
-        cdft_thread_wait(th[i]);
+    cdft_mutex_unlock(&cdft_pool_mutex);
+    cftrec_task(id, &ch[0]);
+    /* the deque was full: run the rest here */
+    for (i = 1; i < 4; i++) {
+        if (pushed[i] == 0) {
+            cftrec_task(id, &ch[i]);
+        }
     }
 }
 
 
-void *cftrec1_th(void *p)
+void cftbrecr_th(int n, double *a, int nw, double *w)
 {
-    int cfttree(int n, int j, int k, double *a, int nw, double *w);
-    void cftleaf(int n, int isplt, double *a, int nw, double *w);
-    void cftmdl1(int n, double *a, double *w);
-    int isplt, j, k, m, n, n0, nw;
-    double *a, *w;
+    void cftbrecr(int n, double *a, int nw, double *w);
+    int cdft_threads_n(int n);
+    int cdft_pool_open(int *nthread);
+    void cdft_pool_close(int id, cdft_job_t *job);
+    void cftbrec_task(int id, cdft_task_t *tk);
+    int id, nthread;
+    cdft_job_t job;
+    cdft_task_t tk;
     
-    n0 = ((cdft_arg_t *) p)->n0;
-    n = ((cdft_arg_t *) p)->n;
-    a = ((cdft_arg_t *) p)->a;
-    nw = ((cdft_arg_t *) p)->nw;
-    w = ((cdft_arg_t *) p)->w;
-    m = n0;
-    while (m > 512) {
-        m >>= 2;
-        cftmdl1(m, &a[n - m], &w[nw - (m >> 1)]);
+    nthread = cdft_threads_n(n);
+    id = cdft_pool_open(&nthread);
+    if (id < 0) {
+        cftbrecr(n, a, nw, w);
+        return;
     }
-    cftleaf(m, 1, &a[n - m], nw, w);
-    k = 0;
-    for (j = n - m; j > 0; j -= m) {
-        k++;
-        isplt = cfttree(m, j, k, a, nw, w);
-        cftleaf(m, isplt, &a[j - m], nw, w);
+    job.nw = nw;
+    job.w = w;
+    job.grain = n / (nthread << 4);
+    if (job.grain < 2048) {
+        job.grain = 2048;
     }
-    return (void *) 0;
+    job.nthread = nthread;
+    job.pending = 0;
+    tk.func = cftbrec_task;
+    tk.n = n;
+    tk.a = a;
+    tk.job = &job;
+    cftbrec_task(id, &tk);
+    cdft_pool_close(id, &job);
 }
 
 
-void *cftrec2_th(void *p)
+void cftbrec_task(int id, cdft_task_t *tk)
 {
-    int cfttree(int n, int j, int k, double *a, int nw, double *w);
-    void cftleaf(int n, int isplt, double *a, int nw, double *w);
-    void cftmdl2(int n, double *a, double *w);
-    int isplt, j, k, m, n, n0, nw;
+    void cftbrecr(int n, double *a, int nw, double *w);
+    void cftbmdlr(int n, double *a, double *w);
+    void cftblstr(int n, double *a, double *w);
+    int cdft_pool_push(int id, cdft_task_t *tk);
+    void cdft_pool_join(int id, cdft_job_t *job);
+    int i, m, n, nw, pushed[3];
     double *a, *w;
+    cdft_job_t sub;
+    cdft_task_t ch[3];
     
-    n0 = ((cdft_arg_t *) p)->n0;
-    n = ((cdft_arg_t *) p)->n;
-    a = ((cdft_arg_t *) p)->a;
-    nw = ((cdft_arg_t *) p)->nw;
-    w = ((cdft_arg_t *) p)->w;
-    k = 1;
-    m = n0;
-    while (m > 512) {
-        m >>= 2;
-        k <<= 2;
-        cftmdl2(m, &a[n - m], &w[nw - m]);
+    n = tk->n;
+    a = tk->a;
+    nw = tk->job->nw;
+    w = tk->job->w;
+    m = n >> 2;
+    if (m < tk->job->grain) {
+        cftbrecr(n, a, nw, w);
+        return;
     }
-    cftleaf(m, 0, &a[n - m], nw, w);
-    k >>= 1;
-    for (j = n - m; j > 0; j -= m) {
-        k++;
-        isplt = cfttree(m, j, k, a, nw, w);
-        cftleaf(m, isplt, &a[j - m], nw, w);
+    /* the two subtrees of n/4 are tasks of sub, the root waits 
+       for them before its butterfly stage */
+    sub.nw = nw;
+    sub.w = w;
+    sub.grain = tk->job->grain;
+    sub.nthread = tk->job->nthread;
+    sub.pending = 0;
+    for (i = 0; i < 3; i++) {
+        ch[i].func = cftbrec_task;
+        ch[i].n = m;
+        ch[i].a = &a[(i + 1) * m];
+        ch[i].job = &sub;
+    }
+    ch[0].n = 2 * m;
+    ch[0].a = a;
+    cdft_mutex_lock(&cdft_pool_mutex);
+    for (i = 2; i > 0; i--) {
+        pushed[i] = cdft_pool_push(id, &ch[i]);
+        if (pushed[i] != 0 && ++sub.pending < sub.nthread) {
+            cdft_cond_signal(&cdft_pool_work);
+        }
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+    cftbrec_task(id, &ch[0]);
+    for (i = 1; i < 3; i++) {
+        if (pushed[i] == 0) {
+            cftbrec_task(id, &ch[i]);
+        }
+    }
+    cdft_pool_join(id, &sub);
+    if (n <= (nw << 1)) {
+        cftbmdlr(n, a, &w[nw - (n >> 1)]);
+    } else {
+        cftblstr(n, a, &w[nw - (n >> 2)]);
+    }
+}
+
+
+void bitrv2_th(int n, int *ip, double *a)
+{
+    void bitrv2(int n, int *ip, double *a);
+    void bitrv2_task(int id, cdft_task_t *tk);
+    void bitrv_th(int n, int *ip, double *a, 
+        void (*func)(int id, cdft_task_t *tk));
+    int cdft_threads_n(int n);
+    
+    if (n <= 512 || cdft_threads_n(n) < 2) {
+        bitrv2(n, ip, a);
+        return;
+    }
+    bitrv_th(n, ip, a, bitrv2_task);
+}
+
+
+void bitrv2conj_th(int n, int *ip, double *a)
+{
+    void bitrv2conj(int n, int *ip, double *a);
+    void bitrv2conj_task(int id, cdft_task_t *tk);
+    void bitrv_th(int n, int *ip, double *a, 
+        void (*func)(int id, cdft_task_t *tk));
+    int cdft_threads_n(int n);
+    
+    if (n <= 512 || cdft_threads_n(n) < 2) {
+        bitrv2conj(n, ip, a);
+        return;
+    }
+    bitrv_th(n, ip, a, bitrv2conj_task);
+}
+
+
+void bitrv_th(int n, int *ip, double *a, 
+    void (*func)(int id, cdft_task_t *tk))
+{
+    int cdft_threads_n(int n);
+    int cdft_pool_open(int *nthread);
+    void cdft_pool_close(int id, cdft_job_t *job);
+    int cdft_pool_push(int id, cdft_task_t *tk);
+    int i, id, l, m, nthread, ntask;
+    cdft_job_t job;
+    cdft_task_t tk;
+    
+    nthread = cdft_threads_n(n);
+    id = cdft_pool_open(&nthread);
+    if (id < 0) {
+        tk.n = n;
+        tk.a = a;
+        tk.k0 = 0;
+        tk.k1 = n;
+        tk.job = &job;
+        job.ip = ip;
+        (*func)(-1, &tk);
+        return;
+    }
+    m = 1;
+    for (l = n >> 2; l > 8; l >>= 2) {
+        m <<= 1;
+    }
+    job.ip = ip;
+    job.nthread = nthread;
+    job.pending = 0;
+    ntask = nthread << 1;
+    if (ntask > CDFT_DEQUE_SIZE) {
+        ntask = CDFT_DEQUE_SIZE;
+    }
+    /* row k swaps k elements: k0 = m * sqrt(i / ntask) balances */
+    tk.func = func;
+    tk.n = n;
+    tk.a = a;
+    tk.job = &job;
+    cdft_mutex_lock(&cdft_pool_mutex);
+    for (i = ntask - 1; i > 0; i--) {
+        tk.k0 = (int) (m * sqrt((double) i / ntask));
+        tk.k1 = (int) (m * sqrt((double) (i + 1) / ntask));
+        if (tk.k0 < tk.k1 && cdft_pool_push(id, &tk) != 0) {
+            if (++job.pending < nthread) {
+                cdft_cond_signal(&cdft_pool_work);
+            }
+        } else if (tk.k0 < tk.k1) {
+            cdft_mutex_unlock(&cdft_pool_mutex);
+            (*func)(id, &tk);
+            cdft_mutex_lock(&cdft_pool_mutex);
+        }
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+    tk.k0 = 0;
+    tk.k1 = (int) (m * sqrt(1.0 / ntask));
+    (*func)(id, &tk);
+    cdft_pool_close(id, &job);
+}
+
+
+void bitrv2_task(int id, cdft_task_t *tk)
+{
+    void bitrv2x(int n, int *ip, double *a, int ks, int ke);
+    
+    bitrv2x(tk->n, tk->job->ip, tk->a, tk->k0, tk->k1);
+}
+
+
+void bitrv2conj_task(int id, cdft_task_t *tk)
+{
+    void bitrv2conjx(int n, int *ip, double *a, int ks, int ke);
+    
+    bitrv2conjx(tk->n, tk->job->ip, tk->a, tk->k0, tk->k1);
+}
+
+
+int cdft_threads_n(int n)
+{
+    void cdft_threads_init(void);
+    int m, nthread;
+    
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+    nthread = 1;
+    if (n > cdft_threads_begin_n) {
+        nthread = 2;
+        if (n > cdft_4threads_begin_n) {
+            nthread = 4;
+            for (m = cdft_4threads_begin_n; m < (n >> 2); m <<= 2) {
+                nthread <<= 1;
+            }
+        }
+    }
+    return nthread;
+}
+
+
+int cdft_pool_open(int *nthread)
+{
+    void *cdft_pool_worker(void *p);
+    int cdft_pool_attach(void);
+    int cdft_ncpu(void);
+    cdft_thread_t th;
+    int id, i;
+    
+    cdft_mutex_lock(&cdft_pool_mutex);
+    if (cdft_max_threads <= 0) {
+        cdft_max_threads = cdft_ncpu();
+    }
+    if (*nthread > cdft_max_threads) {
+        *nthread = cdft_max_threads;
+    }
+    id = -1;
+    if (*nthread > 1) {
+        id = cdft_pool_attach();
+    }
+    while (id >= 0 && cdft_pool_nthread < *nthread - 1) {
+        i = cdft_pool_attach();
+        if (i < 0) {
+            break;
+        }
+        cdft_thread_create(&th, cdft_pool_worker, (size_t) i);
+        cdft_thread_detach(th);
+        cdft_pool_nthread++;
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+    return id;
+}
+
+
+void cdft_pool_close(int id, cdft_job_t *job)
+{
+    int cdft_pool_take(int id, cdft_task_t *tk);
+    void cftrec_task(int id, cdft_task_t *tk);
+    cdft_task_t tk;
+    
+    cdft_mutex_lock(&cdft_pool_mutex);
+    /* help with queued subtrees instead of sleeping */
+    while (job->pending > 0 || 
+        cdft_pool_deque[id].head < cdft_pool_deque[id].tail) {
+        if (cdft_pool_take(id, &tk) != 0) {
+            cdft_mutex_unlock(&cdft_pool_mutex);
+            (*tk.func)(id, &tk);
+            cdft_mutex_lock(&cdft_pool_mutex);
+            if (--tk.job->pending == 0) {
+                cdft_cond_broadcast(&cdft_pool_done);
+            }
+        } else {
+            cdft_cond_wait(&cdft_pool_done, &cdft_pool_mutex);
+        }
+    }
+    cdft_pool_deque[id].used = 0;
+    cdft_mutex_unlock(&cdft_pool_mutex);
+}
+
+
+void cdft_pool_join(int id, cdft_job_t *job)
+{
+    int cdft_pool_take(int id, cdft_task_t *tk);
+    cdft_task_t tk;
+    
+    cdft_mutex_lock(&cdft_pool_mutex);
+    /* as cdft_pool_close, but only until the tasks of job are done */
+    while (job->pending > 0) {
+        if (cdft_pool_take(id, &tk) != 0) {
+            cdft_mutex_unlock(&cdft_pool_mutex);
+            (*tk.func)(id, &tk);
+            cdft_mutex_lock(&cdft_pool_mutex);
+            if (--tk.job->pending == 0) {
+                cdft_cond_broadcast(&cdft_pool_done);
+            }
+        } else {
+            cdft_cond_wait(&cdft_pool_done, &cdft_pool_mutex);
+        }
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+}
+
+
+void *cdft_pool_worker(void *p)
+{
+    int cdft_pool_take(int id, cdft_task_t *tk);
+    void cftrec_task(int id, cdft_task_t *tk);
+    int id;
+    cdft_task_t tk;
+    
+    id = (int) (size_t) p;
+    cdft_mutex_lock(&cdft_pool_mutex);
+    for (;;) {
+        if (cdft_pool_take(id, &tk) == 0) {
+            cdft_cond_wait(&cdft_pool_work, &cdft_pool_mutex);
+            continue;
+        }
+        cdft_mutex_unlock(&cdft_pool_mutex);
+        (*tk.func)(id, &tk);
+        cdft_mutex_lock(&cdft_pool_mutex);
+        if (--tk.job->pending == 0) {
+            cdft_cond_broadcast(&cdft_pool_done);
+        }
+    }
+    return p;
+}
+
+
+int cdft_pool_attach(void)
+{
+    int i, nd;
+    cdft_deque_t *d;
+    
+    for (i = 0; i < cdft_pool_ndeque; i++) {
+        if (cdft_pool_deque[i].used == 0) {
+            break;
+        }
+    }
+    if (i == cdft_pool_ndeque) {
+        nd = 2 * cdft_pool_ndeque + 8;
+        d = (cdft_deque_t *) realloc(cdft_pool_deque, 
+            sizeof(cdft_deque_t) * nd);
+        if (d == NULL) {
+            return -1;
+        }
+        cdft_pool_deque = d;
+        for (; cdft_pool_ndeque < nd; cdft_pool_ndeque++) {
+            d[cdft_pool_ndeque].used = 0;
+        }
+    }
+    cdft_pool_deque[i].used = 1;
+    cdft_pool_deque[i].head = 0;
+    cdft_pool_deque[i].tail = 0;
+    return i;
+}
+
+
+int cdft_pool_push(int id, cdft_task_t *tk)
+{
+    cdft_deque_t *d;
+    
+    d = &cdft_pool_deque[id];
+    if (d->tail >= CDFT_DEQUE_SIZE) {
+        return 0;
+    }
+    d->task[d->tail++] = *tk;
+    return 1;
+}
+
+
+int cdft_pool_take(int id, cdft_task_t *tk)
+{
+    int i;
+    cdft_deque_t *d;
+    
+    d = &cdft_pool_deque[id];
+    if (d->head < d->tail) {
+        *tk = d->task[--d->tail];
+        if (d->head == d->tail) {
+            d->head = d->tail = 0;
+        }
+        return 1;
+    }
+    for (i = 1; i < cdft_pool_ndeque; i++) {
+        d = &cdft_pool_deque[(id + i) % cdft_pool_ndeque];
+        if (d->used != 0 && d->head < d->tail) {
+            *tk = d->task[d->head++];
+            if (d->head == d->tail) {
+                d->head = d->tail = 0;
+            }
+            return 1;
+        }
     }
-    return (void *) 0;
+    return 0;
+}
+
+
+int cdft_ncpu(void)
+{
+#ifdef USE_CDFT_WINTHREADS
+    SYSTEM_INFO si;
+    
+    GetSystemInfo(&si);
+    return (int) si.dwNumberOfProcessors;
+#else
+    long np;
+    
+    np = sysconf(_SC_NPROCESSORS_ONLN);
+    return np > 0 ? (int) np : 1;
+#endif
 }
 #endif /* USE_CDFT_THREADS */
 
@@ -2356,6 +3591,33 @@ int cfttree(int n, int j, int k, double *a, int nw, double *w)
 }
 
 
+void cftrecx(int n, int isplt, double *a, int nw, double *w)
+{
+    void cftleaf(int n, int isplt, double *a, int nw, double *w);
+    void cftmdl1(int n, double *a, double *w);
+    void cftmdl2(int n, double *a, double *w);
+    int m;
+    
+    if (n <= 512) {
+        cftleaf(n, isplt, a, nw, w);
+        return;
+    }
+    m = n >> 2;
+    cftmdl1(m, a, &w[nw - (m >> 1)]);
+    cftrecx(m, 1, a, nw, w);
+    cftmdl2(m, &a[m], &w[nw - m]);
+    cftrecx(m, 0, &a[m], nw, w);
+    cftmdl1(m, &a[2 * m], &w[nw - (m >> 1)]);
+    cftrecx(m, 1, &a[2 * m], nw, w);
+    if (isplt != 0) {
+        cftmdl1(m, &a[3 * m], &w[nw - (m >> 1)]);
+    } else {
+        cftmdl2(m, &a[3 * m], &w[nw - m]);
+    }
+    cftrecx(m, isplt, &a[3 * m], nw, w);
+}
+
+
 void cftleaf(int n, int isplt, double *a, int nw, double *w)
 {
     void cftmdl1(int n, double *a, double *w);
@@ -2421,12 +3683,26 @@ void cftleaf(int n, int isplt, double *a, int nw, double *w)
 }
 
 
+void cftleaf1(int n, double *a, int nw, double *w)
+{
+    void cftleaf(int n, int isplt, double *a, int nw, double *w);
+    
+    cftleaf(n, 1, a, nw, w);
+}
+
+
 void cftmdl1(int n, double *a, double *w)
 {
     int j, j0, j1, j2, j3, k, m, mh;
     double wn4r, wk1r, wk1i, wk3r, wk3i;
     double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
     
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftmdl1 != NULL) {
+        (*cdft_simd->cftmdl1)(n, a, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
     mh = n >> 3;
     m = 2 * mh;
     j1 = m;
@@ -2537,6 +3813,12 @@ void cftmdl2(int n, double *a, double *w)
     double wn4r, wk1r, wk1i, wk3r, wk3i, wd1r, wd1i, wd3r, wd3i;
     double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, y0r, y0i, y2r, y2i;
     
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftmdl2 != NULL) {
+        (*cdft_simd->cftmdl2)(n, a, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
     mh = n >> 3;
     m = 2 * mh;
     wn4r = w[1];
@@ -2665,59 +3947,351 @@ void cftmdl2(int n, double *a, double *w)
 }
 
 
-void cftfx41(int n, double *a, int nw, double *w)
+#ifdef USE_CDFT_SIMD
+/*
+    SSE2 and AVX2/FMA versions of cftmdl1, cftmdl2.
+    One (SSE2) or two (AVX2) neighbouring butterflies 
+    are done per vector. The j=0 and j=mh butterflies of 
+    the scalar routines are folded into the loop with 
+    their constant twiddles.
+*/
+
+
+cdft_target("sse2")
+void cftmdl1_sse2(int n, double *a, double *w)
 {
-    void cftf161(double *a, double *w);
-    void cftf162(double *a, double *w);
-    void cftf081(double *a, double *w);
-    void cftf082(double *a, double *w);
+    int j, j0, j1, j2, j3, m, mh;
+    double wn4r;
+    __m128d sgn, wk1, wk3, wk1n, wk3n, 
+        x0, x1, x2, x3, y0, y1, y2, y3;
     
-    if (n == 128) {
-        cftf161(a, &w[nw - 8]);
-        cftf162(&a[32], &w[nw - 32]);
-        cftf161(&a[64], &w[nw - 8]);
-        cftf161(&a[96], &w[nw - 8]);
-    } else {
-        cftf081(a, &w[nw - 8]);
-        cftf082(&a[16], &w[nw - 8]);
-        cftf081(&a[32], &w[nw - 8]);
-        cftf081(&a[48], &w[nw - 8]);
+    mh = n >> 3;
+    m = 2 * mh;
+    wn4r = w[1];
+    sgn = _mm_set_pd(0.0, -0.0);
+    wk1 = _mm_set_pd(0.0, 1.0);
+    wk3 = wk1;
+    for (j = 0; j < mh; j += 2) {
+        if (j + 2 < mh) {
+            wk1n = _mm_loadu_pd(&w[2 * j + 4]);
+            wk3n = _mm_loadu_pd(&w[2 * j + 6]);
+        } else {
+            wk1n = _mm_set1_pd(wn4r);
+            wk3n = _mm_set1_pd(-wn4r);
+        }
+        j1 = j + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm_loadu_pd(&a[j]);
+        x1 = _mm_loadu_pd(&a[j1]);
+        x2 = _mm_loadu_pd(&a[j2]);
+        x3 = _mm_loadu_pd(&a[j3]);
+        y0 = _mm_add_pd(x0, x2);
+        y1 = _mm_sub_pd(x0, x2);
+        y2 = _mm_add_pd(x1, x3);
+        y3 = cdft_sse2_imul(_mm_sub_pd(x1, x3), sgn);
+        _mm_storeu_pd(&a[j], _mm_add_pd(y0, y2));
+        _mm_storeu_pd(&a[j1], _mm_sub_pd(y0, y2));
+        x0 = _mm_add_pd(y1, y3);
+        x1 = _mm_sub_pd(y1, y3);
+        _mm_storeu_pd(&a[j2], cdft_sse2_cmul(wk1, x0, sgn));
+        _mm_storeu_pd(&a[j3], cdft_sse2_cmulconj(wk3, x1, sgn));
+        wk1 = cdft_sse2_swap(wk1n);
+        wk3 = cdft_sse2_swap(wk3n);
+        j0 = m - j - 2;
+        j1 = j0 + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm_loadu_pd(&a[j0]);
+        x1 = _mm_loadu_pd(&a[j1]);
+        x2 = _mm_loadu_pd(&a[j2]);
+        x3 = _mm_loadu_pd(&a[j3]);
+        y0 = _mm_add_pd(x0, x2);
+        y1 = _mm_sub_pd(x0, x2);
+        y2 = _mm_add_pd(x1, x3);
+        y3 = cdft_sse2_imul(_mm_sub_pd(x1, x3), sgn);
+        _mm_storeu_pd(&a[j0], _mm_add_pd(y0, y2));
+        _mm_storeu_pd(&a[j1], _mm_sub_pd(y0, y2));
+        x0 = _mm_add_pd(y1, y3);
+        x1 = _mm_sub_pd(y1, y3);
+        _mm_storeu_pd(&a[j2], cdft_sse2_cmul(wk1, x0, sgn));
+        _mm_storeu_pd(&a[j3], cdft_sse2_cmulconj(wk3, x1, sgn));
+        wk1 = wk1n;
+        wk3 = wk3n;
     }
 }
 
 
-void cftf161(double *a, double *w)
+cdft_target("sse2")
+void cftmdl2_sse2(int n, double *a, double *w)
 {
-    double wn4r, wk1r, wk1i, 
-        x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, 
-        y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i, 
-        y4r, y4i, y5r, y5i, y6r, y6i, y7r, y7i, 
-        y8r, y8i, y9r, y9i, y10r, y10i, y11r, y11i, 
-        y12r, y12i, y13r, y13i, y14r, y14i, y15r, y15i;
+    int j, j0, j1, j2, j3, m, mh;
+    double wn4r, wmr, wmi;
+    __m128d sgn, wk1, wk3, wd1, wd3, wk1n, wk3n, wd1n, wd3n, 
+        x0, x1, x2, x3, y0, y2;
     
+    mh = n >> 3;
+    m = 2 * mh;
     wn4r = w[1];
-    wk1r = w[2];
-    wk1i = w[3];
-    x0r = a[0] + a[16];
-    x0i = a[1] + a[17];
-    x1r = a[0] - a[16];
-    x1i = a[1] - a[17];
-    x2r = a[8] + a[24];
-    x2i = a[9] + a[25];
-    x3r = a[8] - a[24];
-    x3i = a[9] - a[25];
-    y0r = x0r + x2r;
-    y0i = x0i + x2i;
-    y4r = x0r - x2r;
-    y4i = x0i - x2i;
-    y8r = x1r - x3i;
-    y8i = x1i + x3r;
-    y12r = x1r + x3i;
-    y12i = x1i - x3r;
-    x0r = a[2] + a[18];
-    x0i = a[3] + a[19];
-    x1r = a[2] - a[18];
-    x1i = a[3] - a[19];
+    wmr = w[m];
+    wmi = w[m + 1];
+    sgn = _mm_set_pd(0.0, -0.0);
+    wk1 = _mm_set_pd(0.0, 1.0);
+    wk3 = wk1;
+    wd1 = _mm_set1_pd(wn4r);
+    wd3 = _mm_set1_pd(-wn4r);
+    for (j = 0; j < mh; j += 2) {
+        if (j + 2 < mh) {
+            wk1n = _mm_loadu_pd(&w[2 * j + 4]);
+            wk3n = _mm_loadu_pd(&w[2 * j + 6]);
+            wd1n = _mm_loadu_pd(&w[2 * m - 2 * j - 4]);
+            wd3n = _mm_loadu_pd(&w[2 * m - 2 * j - 2]);
+        } else {
+            wk1n = _mm_set_pd(wmi, wmr);
+            wk3n = _mm_set_pd(-wmr, wmi);
+            wd1n = wk1n;
+            wd3n = wk3n;
+        }
+        j1 = j + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm_loadu_pd(&a[j]);
+        x1 = _mm_loadu_pd(&a[j1]);
+        x2 = cdft_sse2_imul(_mm_loadu_pd(&a[j2]), sgn);
+        x3 = cdft_sse2_imul(_mm_loadu_pd(&a[j3]), sgn);
+        y0 = cdft_sse2_cmul(wk1, _mm_add_pd(x0, x2), sgn);
+        y2 = cdft_sse2_cmul(cdft_sse2_swap(wd1), _mm_add_pd(x1, x3), sgn);
+        _mm_storeu_pd(&a[j], _mm_add_pd(y0, y2));
+        _mm_storeu_pd(&a[j1], _mm_sub_pd(y0, y2));
+        y0 = cdft_sse2_cmulconj(wk3, _mm_sub_pd(x0, x2), sgn);
+        y2 = cdft_sse2_cmulconj(cdft_sse2_swap(wd3), _mm_sub_pd(x1, x3), sgn);
+        _mm_storeu_pd(&a[j2], _mm_add_pd(y0, y2));
+        _mm_storeu_pd(&a[j3], _mm_sub_pd(y0, y2));
+        j0 = m - j - 2;
+        j1 = j0 + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm_loadu_pd(&a[j0]);
+        x1 = _mm_loadu_pd(&a[j1]);
+        x2 = cdft_sse2_imul(_mm_loadu_pd(&a[j2]), sgn);
+        x3 = cdft_sse2_imul(_mm_loadu_pd(&a[j3]), sgn);
+        y0 = cdft_sse2_cmul(wd1n, _mm_add_pd(x0, x2), sgn);
+        y2 = cdft_sse2_cmul(cdft_sse2_swap(wk1n), _mm_add_pd(x1, x3), sgn);
+        _mm_storeu_pd(&a[j0], _mm_add_pd(y0, y2));
+        _mm_storeu_pd(&a[j1], _mm_sub_pd(y0, y2));
+        y0 = cdft_sse2_cmulconj(wd3n, _mm_sub_pd(x0, x2), sgn);
+        y2 = cdft_sse2_cmulconj(cdft_sse2_swap(wk3n), _mm_sub_pd(x1, x3), sgn);
+        _mm_storeu_pd(&a[j2], _mm_add_pd(y0, y2));
+        _mm_storeu_pd(&a[j3], _mm_sub_pd(y0, y2));
+        wk1 = wk1n;
+        wk3 = wk3n;
+        wd1 = wd1n;
+        wd3 = wd3n;
+    }
+}
+
+
+cdft_target("avx2,fma")
+void cftmdl1_avx2(int n, double *a, double *w)
+{
+    int j, j0, j1, j2, j3, m, mh;
+    double wn4r;
+    __m256d sgn, wk0, wk1, wk2, wt1, wt3, 
+        x0, x1, x2, x3, y0, y1, y2, y3;
+    
+    mh = n >> 3;
+    m = 2 * mh;
+    wn4r = w[1];
+    sgn = _mm256_set_pd(0.0, -0.0, 0.0, -0.0);
+    wk0 = _mm256_set_pd(0.0, 1.0, 0.0, 1.0);
+    for (j = 0; j < mh; j += 4) {
+        wk1 = _mm256_loadu_pd(&w[2 * j + 4]);
+        if (j + 4 < mh) {
+            wk2 = _mm256_loadu_pd(&w[2 * j + 8]);
+        } else {
+            wk2 = _mm256_set_pd(-wn4r, -wn4r, wn4r, wn4r);
+        }
+        wt1 = _mm256_permute2f128_pd(wk0, wk1, 0x20);
+        wt3 = _mm256_permute2f128_pd(wk0, wk1, 0x31);
+        j1 = j + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm256_loadu_pd(&a[j]);
+        x1 = _mm256_loadu_pd(&a[j1]);
+        x2 = _mm256_loadu_pd(&a[j2]);
+        x3 = _mm256_loadu_pd(&a[j3]);
+        y0 = _mm256_add_pd(x0, x2);
+        y1 = _mm256_sub_pd(x0, x2);
+        y2 = _mm256_add_pd(x1, x3);
+        y3 = cdft_avx2_imul(_mm256_sub_pd(x1, x3), sgn);
+        _mm256_storeu_pd(&a[j], _mm256_add_pd(y0, y2));
+        _mm256_storeu_pd(&a[j1], _mm256_sub_pd(y0, y2));
+        x0 = _mm256_add_pd(y1, y3);
+        x1 = _mm256_sub_pd(y1, y3);
+        _mm256_storeu_pd(&a[j2], cdft_avx2_cmul(wt1, x0));
+        _mm256_storeu_pd(&a[j3], cdft_avx2_cmulconj(wt3, x1));
+        wt1 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wk2, wk1, 0x20), 0x5);
+        wt3 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wk2, wk1, 0x31), 0x5);
+        j0 = m - j - 4;
+        j1 = j0 + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm256_loadu_pd(&a[j0]);
+        x1 = _mm256_loadu_pd(&a[j1]);
+        x2 = _mm256_loadu_pd(&a[j2]);
+        x3 = _mm256_loadu_pd(&a[j3]);
+        y0 = _mm256_add_pd(x0, x2);
+        y1 = _mm256_sub_pd(x0, x2);
+        y2 = _mm256_add_pd(x1, x3);
+        y3 = cdft_avx2_imul(_mm256_sub_pd(x1, x3), sgn);
+        _mm256_storeu_pd(&a[j0], _mm256_add_pd(y0, y2));
+        _mm256_storeu_pd(&a[j1], _mm256_sub_pd(y0, y2));
+        x0 = _mm256_add_pd(y1, y3);
+        x1 = _mm256_sub_pd(y1, y3);
+        _mm256_storeu_pd(&a[j2], cdft_avx2_cmul(wt1, x0));
+        _mm256_storeu_pd(&a[j3], cdft_avx2_cmulconj(wt3, x1));
+        wk0 = wk2;
+    }
+}
+
+
+cdft_target("avx2,fma")
+void cftmdl2_avx2(int n, double *a, double *w)
+{
+    int j, j0, j1, j2, j3, m, mh;
+    double wn4r, wmr, wmi;
+    __m256d sgn, wk0, wk1, wk2, wd0, wd1, wd2, wt1, wt2, wt3, wt4, 
+        x0, x1, x2, x3, y0, y2;
+    
+    mh = n >> 3;
+    m = 2 * mh;
+    wn4r = w[1];
+    wmr = w[m];
+    wmi = w[m + 1];
+    sgn = _mm256_set_pd(0.0, -0.0, 0.0, -0.0);
+    wk0 = _mm256_set_pd(0.0, 1.0, 0.0, 1.0);
+    wd0 = _mm256_set_pd(-wn4r, -wn4r, wn4r, wn4r);
+    for (j = 0; j < mh; j += 4) {
+        wk1 = _mm256_loadu_pd(&w[2 * j + 4]);
+        wd1 = _mm256_loadu_pd(&w[2 * m - 2 * j - 4]);
+        if (j + 4 < mh) {
+            wk2 = _mm256_loadu_pd(&w[2 * j + 8]);
+            wd2 = _mm256_loadu_pd(&w[2 * m - 2 * j - 8]);
+        } else {
+            wk2 = _mm256_set_pd(-wmr, wmi, wmi, wmr);
+            wd2 = wk2;
+        }
+        wt1 = _mm256_permute2f128_pd(wk0, wk1, 0x20);
+        wt3 = _mm256_permute2f128_pd(wk0, wk1, 0x31);
+        wt2 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wd0, wd1, 0x20), 0x5);
+        wt4 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wd0, wd1, 0x31), 0x5);
+        j1 = j + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm256_loadu_pd(&a[j]);
+        x1 = _mm256_loadu_pd(&a[j1]);
+        x2 = cdft_avx2_imul(_mm256_loadu_pd(&a[j2]), sgn);
+        x3 = cdft_avx2_imul(_mm256_loadu_pd(&a[j3]), sgn);
+        y0 = cdft_avx2_cmul(wt1, _mm256_add_pd(x0, x2));
+        y2 = cdft_avx2_cmul(wt2, _mm256_add_pd(x1, x3));
+        _mm256_storeu_pd(&a[j], _mm256_add_pd(y0, y2));
+        _mm256_storeu_pd(&a[j1], _mm256_sub_pd(y0, y2));
+        y0 = cdft_avx2_cmulconj(wt3, _mm256_sub_pd(x0, x2));
+        y2 = cdft_avx2_cmulconj(wt4, _mm256_sub_pd(x1, x3));
+        _mm256_storeu_pd(&a[j2], _mm256_add_pd(y0, y2));
+        _mm256_storeu_pd(&a[j3], _mm256_sub_pd(y0, y2));
+        wt1 = _mm256_permute2f128_pd(wd2, wd1, 0x20);
+        wt3 = _mm256_permute2f128_pd(wd2, wd1, 0x31);
+        wt2 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wk2, wk1, 0x20), 0x5);
+        wt4 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wk2, wk1, 0x31), 0x5);
+        j0 = m - j - 4;
+        j1 = j0 + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x0 = _mm256_loadu_pd(&a[j0]);
+        x1 = _mm256_loadu_pd(&a[j1]);
+        x2 = cdft_avx2_imul(_mm256_loadu_pd(&a[j2]), sgn);
+        x3 = cdft_avx2_imul(_mm256_loadu_pd(&a[j3]), sgn);
+        y0 = cdft_avx2_cmul(wt1, _mm256_add_pd(x0, x2));
+        y2 = cdft_avx2_cmul(wt2, _mm256_add_pd(x1, x3));
+        _mm256_storeu_pd(&a[j0], _mm256_add_pd(y0, y2));
+        _mm256_storeu_pd(&a[j1], _mm256_sub_pd(y0, y2));
+        y0 = cdft_avx2_cmulconj(wt3, _mm256_sub_pd(x0, x2));
+        y2 = cdft_avx2_cmulconj(wt4, _mm256_sub_pd(x1, x3));
+        _mm256_storeu_pd(&a[j2], _mm256_add_pd(y0, y2));
+        _mm256_storeu_pd(&a[j3], _mm256_sub_pd(y0, y2));
+        wk0 = wk2;
+        wd0 = wd2;
+    }
+}
+#endif /* USE_CDFT_SIMD */
+
+
+void cftfx41(int n, double *a, int nw, double *w)
+{
+    void cftf161(double *a, double *w);
+    void cftf162(double *a, double *w);
+    void cftf081(double *a, double *w);
+    void cftf082(double *a, double *w);
+    
+    if (n == 128) {
+        cftf161(a, &w[nw - 8]);
+        cftf162(&a[32], &w[nw - 32]);
+        cftf161(&a[64], &w[nw - 8]);
+        cftf161(&a[96], &w[nw - 8]);
+    } else {
+        cftf081(a, &w[nw - 8]);
+        cftf082(&a[16], &w[nw - 8]);
+        cftf081(&a[32], &w[nw - 8]);
+        cftf081(&a[48], &w[nw - 8]);
+    }
+}
+
+
+void cftf161(double *a, double *w)
+{
+    double wn4r, wk1r, wk1i, 
+        x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, 
+        y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i, 
+        y4r, y4i, y5r, y5i, y6r, y6i, y7r, y7i, 
+        y8r, y8i, y9r, y9i, y10r, y10i, y11r, y11i, 
+        y12r, y12i, y13r, y13i, y14r, y14i, y15r, y15i;
+    
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftf161 != NULL) {
+        (*cdft_simd->cftf161)(a, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
+    wn4r = w[1];
+    wk1r = w[2];
+    wk1i = w[3];
+    x0r = a[0] + a[16];
+    x0i = a[1] + a[17];
+    x1r = a[0] - a[16];
+    x1i = a[1] - a[17];
+    x2r = a[8] + a[24];
+    x2i = a[9] + a[25];
+    x3r = a[8] - a[24];
+    x3i = a[9] - a[25];
+    y0r = x0r + x2r;
+    y0i = x0i + x2i;
+    y4r = x0r - x2r;
+    y4i = x0i - x2i;
+    y8r = x1r - x3i;
+    y8i = x1i + x3r;
+    y12r = x1r + x3i;
+    y12i = x1i - x3r;
+    x0r = a[2] + a[18];
+    x0i = a[3] + a[19];
+    x1r = a[2] - a[18];
+    x1i = a[3] - a[19];
     x2r = a[10] + a[26];
     x2i = a[11] + a[27];
     x3r = a[10] - a[26];
@@ -2854,6 +4428,12 @@ void cftf162(double *a, double *w)
         y8r, y8i, y9r, y9i, y10r, y10i, y11r, y11i, 
         y12r, y12i, y13r, y13i, y14r, y14i, y15r, y15i;
     
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftf162 != NULL) {
+        (*cdft_simd->cftf162)(a, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
     wn4r = w[1];
     wk1r = w[4];
     wk1i = w[5];
@@ -3034,6 +4614,12 @@ void cftf081(double *a, double *w)
         y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i, 
         y4r, y4i, y5r, y5i, y6r, y6i, y7r, y7i;
     
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftf081 != NULL) {
+        (*cdft_simd->cftf081)(a, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
     wn4r = w[1];
     x0r = a[0] + a[8];
     x0i = a[1] + a[9];
@@ -3096,6 +4682,12 @@ void cftf082(double *a, double *w)
         y0r, y0i, y1r, y1i, y2r, y2i, y3r, y3i, 
         y4r, y4i, y5r, y5i, y6r, y6i, y7r, y7i;
     
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftf082 != NULL) {
+        (*cdft_simd->cftf082)(a, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
     wn4r = w[1];
     wk1r = w[2];
     wk1i = w[3];
@@ -3162,6 +4754,151 @@ void cftf082(double *a, double *w)
 }
 
 
+#ifdef USE_CDFT_SIMD
+/*
+    AVX-512 versions of cftf161, cftf162, cftf081, cftf082.
+    Each __m512d holds 4 complex numbers; the twiddles of 
+    the last radix-4 step are folded into per-lane multipliers 
+    so that it becomes a plain 4-point DFT inside a register.
+*/
+
+
+cdft_target("avx512f")
+__m512d cftfx4_avx512(__m512d x, __m512d z)
+{
+    __m512d y;
+    
+    /* (x0 + x2, x1 + x3, x0 - x2, i * (x1 - x3)) */
+    y = _mm512_shuffle_f64x2(x, x, 0x4e);
+    x = _mm512_mask_sub_pd(_mm512_add_pd(x, y), 0xf0, y, x);
+    x = _mm512_mask_permute_pd(x, 0xc0, x, 0x55);
+    x = _mm512_mask_sub_pd(x, 0x40, z, x);
+    /* (y0 + y1, y0 - y1, y2 + y3, y2 - y3) */
+    y = _mm512_shuffle_f64x2(x, x, 0xb1);
+    return _mm512_mask_sub_pd(_mm512_add_pd(x, y), 0xcc, y, x);
+}
+
+
+cdft_target("avx512f")
+void cftf161_avx512(double *a, double *w)
+{
+    __m512d cftfx4_avx512(__m512d x, __m512d z);
+    double wn4r, wk1r, wk1i;
+    __m512d z, x0, x1, x2, x3, y0, y1, y2, y3;
+    
+    wn4r = w[1];
+    wk1r = w[2];
+    wk1i = w[3];
+    z = _mm512_setzero_pd();
+    x0 = _mm512_loadu_pd(&a[0]);
+    x1 = _mm512_loadu_pd(&a[8]);
+    x2 = _mm512_loadu_pd(&a[16]);
+    x3 = _mm512_loadu_pd(&a[24]);
+    y0 = _mm512_add_pd(x0, x2);
+    y1 = _mm512_sub_pd(x0, x2);
+    y2 = _mm512_add_pd(x1, x3);
+    y3 = cdft_avx512_imul(_mm512_sub_pd(x1, x3), z);
+    x0 = _mm512_add_pd(y0, y2);
+    x1 = _mm512_sub_pd(y0, y2);
+    x2 = _mm512_add_pd(y1, y3);
+    x3 = _mm512_sub_pd(y1, y3);
+    x1 = cdft_avx512_cmul(_mm512_set_pd(wn4r, -wn4r, 1.0, 0.0, 
+        wn4r, wn4r, 0.0, 1.0), x1);
+    x2 = cdft_avx512_cmul(_mm512_set_pd(wk1r, wk1i, wn4r, wn4r, 
+        wk1i, wk1r, 0.0, 1.0), x2);
+    x3 = cdft_avx512_cmul(_mm512_set_pd(-wk1i, -wk1r, wn4r, -wn4r, 
+        wk1r, wk1i, 0.0, 1.0), x3);
+    _mm512_storeu_pd(&a[0], cftfx4_avx512(x0, z));
+    _mm512_storeu_pd(&a[8], cftfx4_avx512(x1, z));
+    _mm512_storeu_pd(&a[16], cftfx4_avx512(x2, z));
+    _mm512_storeu_pd(&a[24], cftfx4_avx512(x3, z));
+}
+
+
+cdft_target("avx512f")
+void cftf162_avx512(double *a, double *w)
+{
+    __m512d cftfx4_avx512(__m512d x, __m512d z);
+    double wn4r, wk1r, wk1i, wk2r, wk2i, wk3r, wk3i;
+    __m512d z, x0, x1, x2, x3, y0, y1, y2, y3;
+    
+    wn4r = w[1];
+    wk1r = w[4];
+    wk1i = w[5];
+    wk3r = w[6];
+    wk3i = -w[7];
+    wk2r = w[8];
+    wk2i = w[9];
+    z = _mm512_setzero_pd();
+    x0 = _mm512_loadu_pd(&a[0]);
+    x1 = _mm512_loadu_pd(&a[8]);
+    x2 = cdft_avx512_imul(_mm512_loadu_pd(&a[16]), z);
+    x3 = cdft_avx512_imul(_mm512_loadu_pd(&a[24]), z);
+    y0 = cdft_avx512_cmul(_mm512_set_pd(wk3i, wk3r, wk2i, wk2r, 
+        wk1i, wk1r, 0.0, 1.0), _mm512_add_pd(x0, x2));
+    y1 = cdft_avx512_cmul(_mm512_set_pd(wk1r, wk1i, wk2r, wk2i, 
+        wk3r, wk3i, wn4r, wn4r), _mm512_add_pd(x1, x3));
+    y2 = cdft_avx512_cmul(_mm512_set_pd(-wk1r, wk1i, wk2r, wk2i, 
+        wk3i, wk3r, 0.0, 1.0), _mm512_sub_pd(x0, x2));
+    y3 = cdft_avx512_cmul(_mm512_set_pd(wk3r, wk3i, -wk2i, -wk2r, 
+        wk1i, -wk1r, wn4r, -wn4r), _mm512_sub_pd(x1, x3));
+    x0 = _mm512_add_pd(y0, y1);
+    x1 = _mm512_sub_pd(y0, y1);
+    x2 = _mm512_add_pd(y2, y3);
+    x3 = _mm512_sub_pd(y2, y3);
+    x1 = cdft_avx512_cmul(_mm512_set_pd(wn4r, -wn4r, 1.0, 0.0, 
+        wn4r, wn4r, 0.0, 1.0), x1);
+    x2 = _mm512_mask_sub_pd(x2, 0xc0, z, x2);
+    x3 = cdft_avx512_cmul(_mm512_set_pd(-wn4r, wn4r, 1.0, 0.0, 
+        wn4r, wn4r, 0.0, 1.0), x3);
+    _mm512_storeu_pd(&a[0], cftfx4_avx512(x0, z));
+    _mm512_storeu_pd(&a[8], cftfx4_avx512(x1, z));
+    _mm512_storeu_pd(&a[16], cftfx4_avx512(x2, z));
+    _mm512_storeu_pd(&a[24], cftfx4_avx512(x3, z));
+}
+
+
+cdft_target("avx512f")
+void cftf081_avx512(double *a, double *w)
+{
+    __m512d cftfx4_avx512(__m512d x, __m512d z);
+    double wn4r;
+    __m512d z, x0, x1;
+    
+    wn4r = w[1];
+    z = _mm512_setzero_pd();
+    x0 = _mm512_loadu_pd(&a[0]);
+    x1 = _mm512_loadu_pd(&a[8]);
+    _mm512_storeu_pd(&a[0], cftfx4_avx512(_mm512_add_pd(x0, x1), z));
+    x1 = cdft_avx512_cmul(_mm512_set_pd(wn4r, -wn4r, 1.0, 0.0, 
+        wn4r, wn4r, 0.0, 1.0), _mm512_sub_pd(x0, x1));
+    _mm512_storeu_pd(&a[8], cftfx4_avx512(x1, z));
+}
+
+
+cdft_target("avx512f")
+void cftf082_avx512(double *a, double *w)
+{
+    __m512d cftfx4_avx512(__m512d x, __m512d z);
+    double wn4r, wk1r, wk1i;
+    __m512d z, x0, x1;
+    
+    wn4r = w[1];
+    wk1r = w[2];
+    wk1i = w[3];
+    z = _mm512_setzero_pd();
+    x0 = _mm512_loadu_pd(&a[0]);
+    x1 = cdft_avx512_imul(_mm512_loadu_pd(&a[8]), z);
+    _mm512_storeu_pd(&a[0], cftfx4_avx512(cdft_avx512_cmul(
+        _mm512_set_pd(wk1r, wk1i, wn4r, wn4r, wk1i, wk1r, 0.0, 1.0), 
+        _mm512_add_pd(x0, x1)), z));
+    _mm512_storeu_pd(&a[8], cftfx4_avx512(cdft_avx512_cmul(
+        _mm512_set_pd(-wk1i, -wk1r, wn4r, -wn4r, wk1r, wk1i, 0.0, 1.0), 
+        _mm512_sub_pd(x0, x1)), z));
+}
+#endif /* USE_CDFT_SIMD */
+
+
 void cftf040(double *a)
 {
     double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
@@ -3271,44 +5008,2891 @@ void rftbsub(int n, double *a, int nc, double *c)
 }
 
 
-void dctsub(int n, double *a, int nc, double *c)
+/*
+   bit reversed order (rdftb): cftbrecr is a split radix decimation 
+   in time, the transpose of cftfsub without bitrv2; in rftfsubr, 
+   rftbsubr the pair k, n/2-k sits at mirror positions p, 3*h-1-p 
+   of each block [h, 2*h) of the bit reversed order
+*/
+void cftbrecr(int n, double *a, int nw, double *w)
 {
-    int j, k, kk, ks, m;
-    double wkr, wki, xr;
+    void bitrv216(double *a);
+    void bitrv216neg(double *a);
+    void bitrv208(double *a);
+    void bitrv208neg(double *a);
+    void cftf161(double *a, double *w);
+    void cftf081(double *a, double *w);
+    void cftbmdlr(int n, double *a, double *w);
+    void cftblstr(int n, double *a, double *w);
     
-    m = n >> 1;
-    ks = nc / n;
-    kk = 0;
-    for (j = 1; j < m; j++) {
-        k = n - j;
-        kk += ks;
-        wkr = c[kk] - c[nc - kk];
-        wki = c[kk] + c[nc - kk];
-        xr = wki * a[j] - wkr * a[k];
-        a[j] = wkr * a[j] + wki * a[k];
-        a[k] = xr;
+    if (n == 32) {
+        bitrv216(a);
+        cftf161(a, &w[nw - 8]);
+        bitrv216neg(a);
+    } else if (n == 16) {
+        bitrv208(a);
+        cftf081(a, &w[nw - 8]);
+        bitrv208neg(a);
+    } else {
+        cftbrecr(n >> 1, a, nw, w);
+        cftbrecr(n >> 2, &a[n >> 1], nw, w);
+        cftbrecr(n >> 2, &a[n - (n >> 2)], nw, w);
+        if (n <= (nw << 1)) {
+            cftbmdlr(n, a, &w[nw - (n >> 1)]);
+        } else {
+            cftblstr(n, a, &w[nw - (n >> 2)]);
+        }
     }
-    a[m] *= c[0];
 }
 
 
-void dstsub(int n, double *a, int nc, double *c)
+void cftblstr(int n, double *a, double *w)
 {
-    int j, k, kk, ks, m;
-    double wkr, wki, xr;
+    int j, j0, j1, j2, j3, k, m, mh;
+    double wn4r, csc1, csc3, wk1r, wk1i, wk3r, wk3i, 
+        wd1r, wd1i, wd3r, wd3i;
+    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, 
+        y0r, y0i, y1r, y1i;
     
-    m = n >> 1;
-    ks = nc / n;
-    kk = 0;
-    for (j = 1; j < m; j++) {
-        k = n - j;
-        kk += ks;
-        wkr = c[kk] - c[nc - kk];
-        wki = c[kk] + c[nc - kk];
-        xr = wki * a[k] - wkr * a[j];
-        a[k] = wkr * a[k] + wki * a[j];
-        a[j] = xr;
+    mh = n >> 3;
+    m = 2 * mh;
+    j1 = m;
+    j2 = j1 + m;
+    j3 = j2 + m;
+    x2r = a[j2];
+    x2i = a[j2 + 1];
+    x3r = a[j3];
+    x3i = a[j3 + 1];
+    y0r = x2r + x3r;
+    y0i = x2i + x3i;
+    y1r = x2r - x3r;
+    y1i = x2i - x3i;
+    x0r = a[0];
+    x0i = a[1];
+    x1r = a[j1];
+    x1i = a[j1 + 1];
+    a[0] = x0r + y0r;
+    a[1] = x0i + y0i;
+    a[j2] = x0r - y0r;
+    a[j2 + 1] = x0i - y0i;
+    a[j1] = x1r + y1i;
+    a[j1 + 1] = x1i - y1r;
+    a[j3] = x1r - y1i;
+    a[j3 + 1] = x1i + y1r;
+    wn4r = w[1];
+    csc1 = w[2];
+    csc3 = w[3];
+    wd1r = 1;
+    wd1i = 0;
+    wd3r = 1;
+    wd3i = 0;
+    k = 0;
+    for (j = 2; j < mh - 2; j += 4) {
+        k += 4;
+        wk1r = csc1 * (wd1r + w[k]);
+        wk1i = csc1 * (wd1i + w[k + 1]);
+        wk3r = csc3 * (wd3r + w[k + 2]);
+        wk3i = csc3 * (wd3i + w[k + 3]);
+        wd1r = w[k];
+        wd1i = w[k + 1];
+        wd3r = w[k + 2];
+        wd3i = w[k + 3];
+        j1 = j + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x2r = wk1r * a[j2] + wk1i * a[j2 + 1];
+        x2i = wk1r * a[j2 + 1] - wk1i * a[j2];
+        x3r = wk3r * a[j3] - wk3i * a[j3 + 1];
+        x3i = wk3r * a[j3 + 1] + wk3i * a[j3];
+        y0r = x2r + x3r;
+        y0i = x2i + x3i;
+        y1r = x2r - x3r;
+        y1i = x2i - x3i;
+        x0r = a[j];
+        x0i = a[j + 1];
+        x1r = a[j1];
+        x1i = a[j1 + 1];
+        a[j] = x0r + y0r;
+        a[j + 1] = x0i + y0i;
+        a[j2] = x0r - y0r;
+        a[j2 + 1] = x0i - y0i;
+        a[j1] = x1r + y1i;
+        a[j1 + 1] = x1i - y1r;
+        a[j3] = x1r - y1i;
+        a[j3 + 1] = x1i + y1r;
+        x2r = wd1r * a[j2 + 2] + wd1i * a[j2 + 3];
+        x2i = wd1r * a[j2 + 3] - wd1i * a[j2 + 2];
+        x3r = wd3r * a[j3 + 2] - wd3i * a[j3 + 3];
+        x3i = wd3r * a[j3 + 3] + wd3i * a[j3 + 2];
+        y0r = x2r + x3r;
+        y0i = x2i + x3i;
+        y1r = x2r - x3r;
+        y1i = x2i - x3i;
+        x0r = a[j + 2];
+        x0i = a[j + 3];
+        x1r = a[j1 + 2];
+        x1i = a[j1 + 3];
+        a[j + 2] = x0r + y0r;
+        a[j + 3] = x0i + y0i;
+        a[j2 + 2] = x0r - y0r;
+        a[j2 + 3] = x0i - y0i;
+        a[j1 + 2] = x1r + y1i;
+        a[j1 + 3] = x1i - y1r;
+        a[j3 + 2] = x1r - y1i;
+        a[j3 + 3] = x1i + y1r;
+        j0 = m - j;
+        j1 = j0 + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x2r = wk1i * a[j2] + wk1r * a[j2 + 1];
+        x2i = wk1i * a[j2 + 1] - wk1r * a[j2];
+        x3r = wk3i * a[j3] - wk3r * a[j3 + 1];
+        x3i = wk3i * a[j3 + 1] + wk3r * a[j3];
+        y0r = x2r + x3r;
+        y0i = x2i + x3i;
+        y1r = x2r - x3r;
+        y1i = x2i - x3i;
+        x0r = a[j0];
+        x0i = a[j0 + 1];
+        x1r = a[j1];
+        x1i = a[j1 + 1];
+        a[j0] = x0r + y0r;
+        a[j0 + 1] = x0i + y0i;
+        a[j2] = x0r - y0r;
+        a[j2 + 1] = x0i - y0i;
+        a[j1] = x1r + y1i;
+        a[j1 + 1] = x1i - y1r;
+        a[j3] = x1r - y1i;
+        a[j3 + 1] = x1i + y1r;
+        x2r = wd1i * a[j2 - 2] + wd1r * a[j2 - 1];
+        x2i = wd1i * a[j2 - 1] - wd1r * a[j2 - 2];
+        x3r = wd3i * a[j3 - 2] - wd3r * a[j3 - 1];
+        x3i = wd3i * a[j3 - 1] + wd3r * a[j3 - 2];
+        y0r = x2r + x3r;
+        y0i = x2i + x3i;
+        y1r = x2r - x3r;
+        y1i = x2i - x3i;
+        x0r = a[j0 - 2];
+        x0i = a[j0 - 1];
+        x1r = a[j1 - 2];
+        x1i = a[j1 - 1];
+        a[j0 - 2] = x0r + y0r;
+        a[j0 - 1] = x0i + y0i;
+        a[j2 - 2] = x0r - y0r;
+        a[j2 - 1] = x0i - y0i;
+        a[j1 - 2] = x1r + y1i;
+        a[j1 - 1] = x1i - y1r;
+        a[j3 - 2] = x1r - y1i;
+        a[j3 - 1] = x1i + y1r;
     }
-    a[m] *= c[0];
+    wk1r = csc1 * (wd1r + wn4r);
+    wk1i = csc1 * (wd1i + wn4r);
+    wk3r = csc3 * (wd3r - wn4r);
+    wk3i = csc3 * (wd3i - wn4r);
+    j0 = mh;
+    j1 = j0 + m;
+    j2 = j1 + m;
+    j3 = j2 + m;
+    x2r = wk1r * a[j2 - 2] + wk1i * a[j2 - 1];
+    x2i = wk1r * a[j2 - 1] - wk1i * a[j2 - 2];
+    x3r = wk3r * a[j3 - 2] - wk3i * a[j3 - 1];
+    x3i = wk3r * a[j3 - 1] + wk3i * a[j3 - 2];
+    y0r = x2r + x3r;
+    y0i = x2i + x3i;
+    y1r = x2r - x3r;
+    y1i = x2i - x3i;
+    x0r = a[j0 - 2];
+    x0i = a[j0 - 1];
+    x1r = a[j1 - 2];
+    x1i = a[j1 - 1];
+    a[j0 - 2] = x0r + y0r;
+    a[j0 - 1] = x0i + y0i;
+    a[j2 - 2] = x0r - y0r;
+    a[j2 - 1] = x0i - y0i;
+    a[j1 - 2] = x1r + y1i;
+    a[j1 - 1] = x1i - y1r;
+    a[j3 - 2] = x1r - y1i;
+    a[j3 - 1] = x1i + y1r;
+    x2r = wn4r * (a[j2] + a[j2 + 1]);
+    x2i = wn4r * (a[j2 + 1] - a[j2]);
+    x3r = -wn4r * (a[j3] - a[j3 + 1]);
+    x3i = -wn4r * (a[j3 + 1] + a[j3]);
+    y0r = x2r + x3r;
+    y0i = x2i + x3i;
+    y1r = x2r - x3r;
+    y1i = x2i - x3i;
+    x0r = a[j0];
+    x0i = a[j0 + 1];
+    x1r = a[j1];
+    x1i = a[j1 + 1];
+    a[j0] = x0r + y0r;
+    a[j0 + 1] = x0i + y0i;
+    a[j2] = x0r - y0r;
+    a[j2 + 1] = x0i - y0i;
+    a[j1] = x1r + y1i;
+    a[j1 + 1] = x1i - y1r;
+    a[j3] = x1r - y1i;
+    a[j3 + 1] = x1i + y1r;
+    x2r = wk1i * a[j2 + 2] + wk1r * a[j2 + 3];
+    x2i = wk1i * a[j2 + 3] - wk1r * a[j2 + 2];
+    x3r = wk3i * a[j3 + 2] - wk3r * a[j3 + 3];
+    x3i = wk3i * a[j3 + 3] + wk3r * a[j3 + 2];
+    y0r = x2r + x3r;
+    y0i = x2i + x3i;
+    y1r = x2r - x3r;
+    y1i = x2i - x3i;
+    x0r = a[j0 + 2];
+    x0i = a[j0 + 3];
+    x1r = a[j1 + 2];
+    x1i = a[j1 + 3];
+    a[j0 + 2] = x0r + y0r;
+    a[j0 + 3] = x0i + y0i;
+    a[j2 + 2] = x0r - y0r;
+    a[j2 + 3] = x0i - y0i;
+    a[j1 + 2] = x1r + y1i;
+    a[j1 + 3] = x1i - y1r;
+    a[j3 + 2] = x1r - y1i;
+    a[j3 + 3] = x1i + y1r;
 }
 
+
+void cftbmdlr(int n, double *a, double *w)
+{
+    int j, j0, j1, j2, j3, k, m, mh;
+    double wn4r, wk1r, wk1i, wk3r, wk3i;
+    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, 
+        y0r, y0i, y1r, y1i;
+    
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftbmdlr != NULL) {
+        (*cdft_simd->cftbmdlr)(n, a, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
+    mh = n >> 3;
+    m = 2 * mh;
+    j1 = m;
+    j2 = j1 + m;
+    j3 = j2 + m;
+    x2r = a[j2];
+    x2i = a[j2 + 1];
+    x3r = a[j3];
+    x3i = a[j3 + 1];
+    y0r = x2r + x3r;
+    y0i = x2i + x3i;
+    y1r = x2r - x3r;
+    y1i = x2i - x3i;
+    x0r = a[0];
+    x0i = a[1];
+    x1r = a[j1];
+    x1i = a[j1 + 1];
+    a[0] = x0r + y0r;
+    a[1] = x0i + y0i;
+    a[j2] = x0r - y0r;
+    a[j2 + 1] = x0i - y0i;
+    a[j1] = x1r + y1i;
+    a[j1 + 1] = x1i - y1r;
+    a[j3] = x1r - y1i;
+    a[j3 + 1] = x1i + y1r;
+    wn4r = w[1];
+    k = 0;
+    for (j = 2; j < mh; j += 2) {
+        k += 4;
+        wk1r = w[k];
+        wk1i = w[k + 1];
+        wk3r = w[k + 2];
+        wk3i = w[k + 3];
+        j1 = j + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x2r = wk1r * a[j2] + wk1i * a[j2 + 1];
+        x2i = wk1r * a[j2 + 1] - wk1i * a[j2];
+        x3r = wk3r * a[j3] - wk3i * a[j3 + 1];
+        x3i = wk3r * a[j3 + 1] + wk3i * a[j3];
+        y0r = x2r + x3r;
+        y0i = x2i + x3i;
+        y1r = x2r - x3r;
+        y1i = x2i - x3i;
+        x0r = a[j];
+        x0i = a[j + 1];
+        x1r = a[j1];
+        x1i = a[j1 + 1];
+        a[j] = x0r + y0r;
+        a[j + 1] = x0i + y0i;
+        a[j2] = x0r - y0r;
+        a[j2 + 1] = x0i - y0i;
+        a[j1] = x1r + y1i;
+        a[j1 + 1] = x1i - y1r;
+        a[j3] = x1r - y1i;
+        a[j3 + 1] = x1i + y1r;
+        j0 = m - j;
+        j1 = j0 + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x2r = wk1i * a[j2] + wk1r * a[j2 + 1];
+        x2i = wk1i * a[j2 + 1] - wk1r * a[j2];
+        x3r = wk3i * a[j3] - wk3r * a[j3 + 1];
+        x3i = wk3i * a[j3 + 1] + wk3r * a[j3];
+        y0r = x2r + x3r;
+        y0i = x2i + x3i;
+        y1r = x2r - x3r;
+        y1i = x2i - x3i;
+        x0r = a[j0];
+        x0i = a[j0 + 1];
+        x1r = a[j1];
+        x1i = a[j1 + 1];
+        a[j0] = x0r + y0r;
+        a[j0 + 1] = x0i + y0i;
+        a[j2] = x0r - y0r;
+        a[j2 + 1] = x0i - y0i;
+        a[j1] = x1r + y1i;
+        a[j1 + 1] = x1i - y1r;
+        a[j3] = x1r - y1i;
+        a[j3 + 1] = x1i + y1r;
+    }
+    j0 = mh;
+    j1 = j0 + m;
+    j2 = j1 + m;
+    j3 = j2 + m;
+    x2r = wn4r * (a[j2] + a[j2 + 1]);
+    x2i = wn4r * (a[j2 + 1] - a[j2]);
+    x3r = -wn4r * (a[j3] - a[j3 + 1]);
+    x3i = -wn4r * (a[j3 + 1] + a[j3]);
+    y0r = x2r + x3r;
+    y0i = x2i + x3i;
+    y1r = x2r - x3r;
+    y1i = x2i - x3i;
+    x0r = a[j0];
+    x0i = a[j0 + 1];
+    x1r = a[j1];
+    x1i = a[j1 + 1];
+    a[j0] = x0r + y0r;
+    a[j0 + 1] = x0i + y0i;
+    a[j2] = x0r - y0r;
+    a[j2 + 1] = x0i - y0i;
+    a[j1] = x1r + y1i;
+    a[j1 + 1] = x1i - y1r;
+    a[j3] = x1r - y1i;
+    a[j3 + 1] = x1i + y1r;
+}
+
+
+void rftfsubr(int n, double *a, int nc, double *c)
+{
+    void rftwtr(int nc, double *c, double *ewr, double *ewi);
+    int h, i, j, k, kk, ks, l, m, p, q, r, u;
+    double ewr[32], ewi[32], wer, wei, wdr, wdi, wkr, wki, 
+        xr, xi, yr, yi;
+    
+    m = n >> 1;
+    ks = 2 * nc / m;
+    for (h = 2; h < m && h < 32; h <<= 1) {
+        r = (m >> 1) / h;
+        for (p = h; p < h + (h >> 1); p++) {
+            /* r: bit reverse of p; the even one of p, 3*h-1-p 
+               is the position of k, the other one of n/2-k */
+            q = 3 * h - 1 - p;
+            if ((p & 1) == 0) {
+                j = 2 * p;
+                k = 2 * q;
+                kk = ks * r;
+            } else {
+                j = 2 * q;
+                k = 2 * p;
+                kk = ks * (m - r);
+            }
+            wkr = 0.5 - c[nc - kk];
+            wki = c[kk];
+            xr = a[j] - a[k];
+            xi = a[j + 1] + a[k + 1];
+            yr = wkr * xr - wki * xi;
+            yi = wkr * xi + wki * xr;
+            a[j] -= yr;
+            a[j + 1] -= yi;
+            a[k] += yr;
+            a[k + 1] -= yi;
+            l = m >> 1;
+            while ((r & l) != 0) {
+                r ^= l;
+                l >>= 1;
+            }
+            r |= l;
+        }
+    }
+    if (m >= 64) {
+        rftwtr(nc, c, ewr, ewi);
+    }
+    wer = 0;
+    wei = 0;
+    u = 16;
+    for (h = 32; h < m; h <<= 1) {
+        r = (m >> 1) / h;
+        for (p = h; p < h + (h >> 1); p += 16) {
+            /* p+i, i < 16: exp(pi*i*r/(n/2)) * ew[i], the table is 
+               read once per 256 positions (ew[16...31]) */
+            if (h < 512 || (p & 255) == 0) {
+                kk = ks * r;
+                wer = c[kk];
+                wei = c[nc - kk];
+                u = 16;
+            }
+            wdr = wer * ewr[u] - wei * ewi[u];
+            wdi = wer * ewi[u] + wei * ewr[u];
+            u++;
+            q = 3 * h - 1 - p;
+            for (i = 0; i < 16; i += 2) {
+                j = 2 * (p + i);
+                k = 2 * (q - i);
+                wkr = 0.5 - (wdr * ewi[i] + wdi * ewr[i]);
+                wki = wdr * ewr[i] - wdi * ewi[i];
+                xr = a[j] - a[k];
+                xi = a[j + 1] + a[k + 1];
+                yr = wkr * xr - wki * xi;
+                yi = wkr * xi + wki * xr;
+                a[j] -= yr;
+                a[j + 1] -= yi;
+                a[k] += yr;
+                a[k + 1] -= yi;
+                j = 2 * (q - i - 1);
+                k = 2 * (p + i + 1);
+                wkr = 0.5 - (wdr * ewi[i + 1] + wdi * ewr[i + 1]);
+                wki = wdi * ewi[i + 1] - wdr * ewr[i + 1];
+                xr = a[j] - a[k];
+                xi = a[j + 1] + a[k + 1];
+                yr = wkr * xr - wki * xi;
+                yi = wkr * xi + wki * xr;
+                a[j] -= yr;
+                a[j + 1] -= yi;
+                a[k] += yr;
+                a[k + 1] -= yi;
+            }
+            l = m >> 5;
+            while ((r & l) != 0) {
+                r ^= l;
+                l >>= 1;
+            }
+            r |= l;
+        }
+    }
+}
+
+
+void rftbsubr(int n, double *a, int nc, double *c)
+{
+    void rftwtr(int nc, double *c, double *ewr, double *ewi);
+    int h, i, j, k, kk, ks, l, m, p, q, r, u;
+    double ewr[32], ewi[32], wer, wei, wdr, wdi, wkr, wki, 
+        xr, xi, yr, yi;
+    
+    m = n >> 1;
+    ks = 2 * nc / m;
+    for (h = 2; h < m && h < 32; h <<= 1) {
+        r = (m >> 1) / h;
+        for (p = h; p < h + (h >> 1); p++) {
+            q = 3 * h - 1 - p;
+            if ((p & 1) == 0) {
+                j = 2 * p;
+                k = 2 * q;
+                kk = ks * r;
+            } else {
+                j = 2 * q;
+                k = 2 * p;
+                kk = ks * (m - r);
+            }
+            wkr = 0.5 - c[nc - kk];
+            wki = c[kk];
+            xr = a[j] - a[k];
+            xi = a[j + 1] + a[k + 1];
+            yr = wkr * xr + wki * xi;
+            yi = wkr * xi - wki * xr;
+            a[j] -= yr;
+            a[j + 1] -= yi;
+            a[k] += yr;
+            a[k + 1] -= yi;
+            l = m >> 1;
+            while ((r & l) != 0) {
+                r ^= l;
+                l >>= 1;
+            }
+            r |= l;
+        }
+    }
+    if (m >= 64) {
+        rftwtr(nc, c, ewr, ewi);
+    }
+    wer = 0;
+    wei = 0;
+    u = 16;
+    for (h = 32; h < m; h <<= 1) {
+        r = (m >> 1) / h;
+        for (p = h; p < h + (h >> 1); p += 16) {
+            if (h < 512 || (p & 255) == 0) {
+                kk = ks * r;
+                wer = c[kk];
+                wei = c[nc - kk];
+                u = 16;
+            }
+            wdr = wer * ewr[u] - wei * ewi[u];
+            wdi = wer * ewi[u] + wei * ewr[u];
+            u++;
+            q = 3 * h - 1 - p;
+            for (i = 0; i < 16; i += 2) {
+                j = 2 * (p + i);
+                k = 2 * (q - i);
+                wkr = 0.5 - (wdr * ewi[i] + wdi * ewr[i]);
+                wki = wdr * ewr[i] - wdi * ewi[i];
+                xr = a[j] - a[k];
+                xi = a[j + 1] + a[k + 1];
+                yr = wkr * xr + wki * xi;
+                yi = wkr * xi - wki * xr;
+                a[j] -= yr;
+                a[j + 1] -= yi;
+                a[k] += yr;
+                a[k + 1] -= yi;
+                j = 2 * (q - i - 1);
+                k = 2 * (p + i + 1);
+                wkr = 0.5 - (wdr * ewi[i + 1] + wdi * ewr[i + 1]);
+                wki = wdi * ewi[i + 1] - wdr * ewr[i + 1];
+                xr = a[j] - a[k];
+                xi = a[j + 1] + a[k + 1];
+                yr = wkr * xr + wki * xi;
+                yi = wkr * xi - wki * xr;
+                a[j] -= yr;
+                a[j + 1] -= yi;
+                a[k] += yr;
+                a[k + 1] -= yi;
+            }
+            l = m >> 5;
+            while ((r & l) != 0) {
+                r ^= l;
+                l >>= 1;
+            }
+            r |= l;
+        }
+    }
+}
+
+
+void rftwtr(int nc, double *c, double *ewr, double *ewi)
+{
+    int i, k, v;
+    
+    /* ew[i] = exp(pi*i*v/16), ew[16+i] = exp(pi*i*v/256), 
+       v: 4-bit reverse of i */
+    for (i = 0; i < 16; i++) {
+        v = ((i & 1) << 3) | ((i & 2) << 1) | ((i & 4) >> 1) | 
+            ((i & 8) >> 3);
+        if (v == 0) {
+            ewr[i] = 1;
+            ewi[i] = 0;
+        } else if (v == 8) {
+            ewr[i] = 0;
+            ewi[i] = 1;
+        } else if (v < 8) {
+            k = (nc >> 3) * v;
+            ewr[i] = 2 * c[k];
+            ewi[i] = 2 * c[nc - k];
+        } else {
+            k = (nc >> 3) * (16 - v);
+            ewr[i] = -2 * c[k];
+            ewi[i] = 2 * c[nc - k];
+        }
+        if (v == 0 || nc < 128) {
+            ewr[16 + i] = 1;
+            ewi[16 + i] = 0;
+        } else {
+            k = (nc >> 7) * v;
+            ewr[16 + i] = 2 * c[k];
+            ewi[16 + i] = 2 * c[nc - k];
+        }
+    }
+}
+
+
+void bitrvr(int n, double *a)
+{
+    int j, k, l, m;
+    double xr, xi;
+    
+    m = n >> 1;
+    k = 0;
+    for (j = 1; j < m; j++) {
+        l = m >> 1;
+        while ((k & l) != 0) {
+            k ^= l;
+            l >>= 1;
+        }
+        k |= l;
+        if (j < k) {
+            xr = a[2 * j];
+            xi = a[2 * j + 1];
+            a[2 * j] = a[2 * k];
+            a[2 * j + 1] = a[2 * k + 1];
+            a[2 * k] = xr;
+            a[2 * k + 1] = xi;
+        }
+    }
+}
+
+
+void dctsub(int n, double *a, int nc, double *c)
+{
+    int j, k, kk, ks, m;
+    double wkr, wki, xr;
+    
+    m = n >> 1;
+    ks = nc / n;
+    kk = 0;
+    for (j = 1; j < m; j++) {
+        k = n - j;
+        kk += ks;
+        wkr = c[kk] - c[nc - kk];
+        wki = c[kk] + c[nc - kk];
+        xr = wki * a[j] - wkr * a[k];
+        a[j] = wkr * a[j] + wki * a[k];
+        a[k] = xr;
+    }
+    a[m] *= c[0];
+}
+
+
+void dstsub(int n, double *a, int nc, double *c)
+{
+    int j, k, kk, ks, m;
+    double wkr, wki, xr;
+    
+    m = n >> 1;
+    ks = nc / n;
+    kk = 0;
+    for (j = 1; j < m; j++) {
+        k = n - j;
+        kk += ks;
+        wkr = c[kk] - c[nc - kk];
+        wki = c[kk] + c[nc - kk];
+        xr = wki * a[k] - wkr * a[j];
+        a[k] = wkr * a[k] + wki * a[j];
+        a[j] = xr;
+    }
+    a[m] *= c[0];
+}
+
+
+/* 
+   split format: radix 4 decimation in frequency with the sub-blocks 
+   in the order (0, 2, 1, 3), so that the output is in bit reversed 
+   order; depth first above CFTS_BLOCK_N to stay in cache; 
+   w[] holds the twiddles w^k, w^2k, w^3k (cos, then sin) of stage 
+   l = n, n/4, ... one after another, 6 * l / 4 per stage 
+*/
+#ifndef CFTS_BLOCK_N
+#define CFTS_BLOCK_N 2048
+#endif
+
+
+void cftssub(int n, double *ar, double *ai, int isgn, double *w)
+{
+    void cftsrec(int l, double *ar, double *ai, int isgn, double *w);
+    void bitrvs(int n, double *ar, double *ai);
+    cftsrec(n, ar, ai, isgn, w);
+    bitrvs(n, ar, ai);
+}
+
+
+void cftsrec(int l, double *ar, double *ai, int isgn, double *w)
+{
+    void cftsmdl(int n, int l, double *ar, double *ai, int isgn, 
+        double *w);
+    void cftsx4(int n, double *ar, double *ai, int isgn);
+    void cftsx2(int n, double *ar, double *ai);
+    int m;
+    
+    if (l > CFTS_BLOCK_N) {
+        m = l >> 2;
+        cftsmdl(l, l, ar, ai, isgn, w);
+        w += 6 * m;
+        cftsrec(m, ar, ai, isgn, w);
+        cftsrec(m, &ar[m], &ai[m], isgn, w);
+        cftsrec(m, &ar[2 * m], &ai[2 * m], isgn, w);
+        cftsrec(m, &ar[3 * m], &ai[3 * m], isgn, w);
+    } else {
+        for (m = l; m >= 8; m >>= 2) {
+            cftsmdl(l, m, ar, ai, isgn, w);
+            w += 6 * (m >> 2);
+        }
+        if (m == 4) {
+            cftsx4(l, ar, ai, isgn);
+        } else {
+            cftsx2(l, ar, ai);
+        }
+    }
+}
+
+
+void cftsmdl(int n, int l, double *ar, double *ai, int isgn, double *w)
+{
+    int j, k, m;
+    double wk1r, wk1i, wk2r, wk2i, wk3r, wk3i, 
+        x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, 
+        y1r, y1i, y2r, y2i, y3r, y3i;
+    double *br, *bi;
+    
+#ifdef USE_CDFT_SIMD
+    if (cdft_simd->cftsmdl != NULL && l >= 16) {
+        (*cdft_simd->cftsmdl)(n, l, ar, ai, isgn, w);
+        return;
+    }
+#endif /* USE_CDFT_SIMD */
+    m = l >> 2;
+    for (j = 0; j < n; j += l) {
+        br = &ar[j];
+        bi = &ai[j];
+        for (k = 0; k < m; k++) {
+            wk1r = w[k];
+            wk1i = w[m + k];
+            wk2r = w[2 * m + k];
+            wk2i = w[3 * m + k];
+            wk3r = w[4 * m + k];
+            wk3i = w[5 * m + k];
+            if (isgn < 0) {
+                wk1i = -wk1i;
+                wk2i = -wk2i;
+                wk3i = -wk3i;
+            }
+            x0r = br[k] + br[k + 2 * m];
+            x0i = bi[k] + bi[k + 2 * m];
+            x1r = br[k] - br[k + 2 * m];
+            x1i = bi[k] - bi[k + 2 * m];
+            x2r = br[k + m] + br[k + 3 * m];
+            x2i = bi[k + m] + bi[k + 3 * m];
+            x3r = br[k + m] - br[k + 3 * m];
+            x3i = bi[k + m] - bi[k + 3 * m];
+            br[k] = x0r + x2r;
+            bi[k] = x0i + x2i;
+            y2r = x0r - x2r;
+            y2i = x0i - x2i;
+            if (isgn >= 0) {
+                y1r = x1r - x3i;
+                y1i = x1i + x3r;
+                y3r = x1r + x3i;
+                y3i = x1i - x3r;
+            } else {
+                y1r = x1r + x3i;
+                y1i = x1i - x3r;
+                y3r = x1r - x3i;
+                y3i = x1i + x3r;
+            }
+            br[k + m] = wk2r * y2r - wk2i * y2i;
+            bi[k + m] = wk2r * y2i + wk2i * y2r;
+            br[k + 2 * m] = wk1r * y1r - wk1i * y1i;
+            bi[k + 2 * m] = wk1r * y1i + wk1i * y1r;
+            br[k + 3 * m] = wk3r * y3r - wk3i * y3i;
+            bi[k + 3 * m] = wk3r * y3i + wk3i * y3r;
+        }
+    }
+}
+
+
+#ifdef USE_CDFT_SIMD
+cdft_target("avx2,fma")
+void cftsmdl_avx2(int n, int l, double *ar, double *ai, int isgn, 
+    double *w)
+{
+    int j, k, m;
+    double *br, *bi;
+    __m256d sgn, wk1r, wk1i, wk2r, wk2i, wk3r, wk3i, 
+        x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, 
+        y1r, y1i, y2r, y2i, y3r, y3i;
+    
+    m = l >> 2;
+    sgn = _mm256_set1_pd(isgn >= 0 ? 0.0 : -0.0);
+    for (j = 0; j < n; j += l) {
+        br = &ar[j];
+        bi = &ai[j];
+        for (k = 0; k < m; k += 4) {
+            wk1r = _mm256_loadu_pd(&w[k]);
+            wk1i = _mm256_xor_pd(_mm256_loadu_pd(&w[m + k]), sgn);
+            wk2r = _mm256_loadu_pd(&w[2 * m + k]);
+            wk2i = _mm256_xor_pd(_mm256_loadu_pd(&w[3 * m + k]), sgn);
+            wk3r = _mm256_loadu_pd(&w[4 * m + k]);
+            wk3i = _mm256_xor_pd(_mm256_loadu_pd(&w[5 * m + k]), sgn);
+            x1r = _mm256_loadu_pd(&br[k]);
+            x1i = _mm256_loadu_pd(&bi[k]);
+            y1r = _mm256_loadu_pd(&br[k + 2 * m]);
+            y1i = _mm256_loadu_pd(&bi[k + 2 * m]);
+            x0r = _mm256_add_pd(x1r, y1r);
+            x0i = _mm256_add_pd(x1i, y1i);
+            x1r = _mm256_sub_pd(x1r, y1r);
+            x1i = _mm256_sub_pd(x1i, y1i);
+            x3r = _mm256_loadu_pd(&br[k + m]);
+            x3i = _mm256_loadu_pd(&bi[k + m]);
+            y3r = _mm256_loadu_pd(&br[k + 3 * m]);
+            y3i = _mm256_loadu_pd(&bi[k + 3 * m]);
+            x2r = _mm256_add_pd(x3r, y3r);
+            x2i = _mm256_add_pd(x3i, y3i);
+            x3r = _mm256_sub_pd(x3r, y3r);
+            x3i = _mm256_sub_pd(x3i, y3i);
+            _mm256_storeu_pd(&br[k], _mm256_add_pd(x0r, x2r));
+            _mm256_storeu_pd(&bi[k], _mm256_add_pd(x0i, x2i));
+            y2r = _mm256_sub_pd(x0r, x2r);
+            y2i = _mm256_sub_pd(x0i, x2i);
+            /* (+-i) * x3 = (-+x3i, +-x3r) */
+            x2r = _mm256_xor_pd(x3i, sgn);
+            x2i = _mm256_xor_pd(x3r, sgn);
+            y1r = _mm256_sub_pd(x1r, x2r);
+            y1i = _mm256_add_pd(x1i, x2i);
+            y3r = _mm256_add_pd(x1r, x2r);
+            y3i = _mm256_sub_pd(x1i, x2i);
+            _mm256_storeu_pd(&br[k + m], 
+                _mm256_fmsub_pd(wk2r, y2r, _mm256_mul_pd(wk2i, y2i)));
+            _mm256_storeu_pd(&bi[k + m], 
+                _mm256_fmadd_pd(wk2r, y2i, _mm256_mul_pd(wk2i, y2r)));
+            _mm256_storeu_pd(&br[k + 2 * m], 
+                _mm256_fmsub_pd(wk1r, y1r, _mm256_mul_pd(wk1i, y1i)));
+            _mm256_storeu_pd(&bi[k + 2 * m], 
+                _mm256_fmadd_pd(wk1r, y1i, _mm256_mul_pd(wk1i, y1r)));
+            _mm256_storeu_pd(&br[k + 3 * m], 
+                _mm256_fmsub_pd(wk3r, y3r, _mm256_mul_pd(wk3i, y3i)));
+            _mm256_storeu_pd(&bi[k + 3 * m], 
+                _mm256_fmadd_pd(wk3r, y3i, _mm256_mul_pd(wk3i, y3r)));
+        }
+    }
+}
+
+
+cdft_target("avx2,fma")
+void cftbmdlr_avx2(int n, double *a, double *w)
+{
+    int j, j0, j1, j2, j3, m, mh;
+    double wn4r;
+    __m256d sgn, wk0, wk1, wk2, wt1, wt3, 
+        x0, x1, x2, x3, y0, y1;
+    
+    mh = n >> 3;
+    m = 2 * mh;
+    wn4r = w[1];
+    sgn = _mm256_set_pd(0.0, -0.0, 0.0, -0.0);
+    wk0 = _mm256_set_pd(0.0, 1.0, 0.0, 1.0);
+    for (j = 0; j < mh; j += 4) {
+        wk1 = _mm256_loadu_pd(&w[2 * j + 4]);
+        if (j + 4 < mh) {
+            wk2 = _mm256_loadu_pd(&w[2 * j + 8]);
+        } else {
+            wk2 = _mm256_set_pd(-wn4r, -wn4r, wn4r, wn4r);
+        }
+        wt1 = _mm256_permute2f128_pd(wk0, wk1, 0x20);
+        wt3 = _mm256_permute2f128_pd(wk0, wk1, 0x31);
+        j1 = j + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x2 = cdft_avx2_cmulconj(wt1, _mm256_loadu_pd(&a[j2]));
+        x3 = cdft_avx2_cmul(wt3, _mm256_loadu_pd(&a[j3]));
+        x0 = _mm256_loadu_pd(&a[j]);
+        x1 = _mm256_loadu_pd(&a[j1]);
+        y0 = _mm256_add_pd(x2, x3);
+        y1 = cdft_avx2_imul(_mm256_sub_pd(x2, x3), sgn);
+        _mm256_storeu_pd(&a[j], _mm256_add_pd(x0, y0));
+        _mm256_storeu_pd(&a[j2], _mm256_sub_pd(x0, y0));
+        _mm256_storeu_pd(&a[j1], _mm256_sub_pd(x1, y1));
+        _mm256_storeu_pd(&a[j3], _mm256_add_pd(x1, y1));
+        wt1 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wk2, wk1, 0x20), 0x5);
+        wt3 = _mm256_permute_pd(
+            _mm256_permute2f128_pd(wk2, wk1, 0x31), 0x5);
+        j0 = m - j - 4;
+        j1 = j0 + m;
+        j2 = j1 + m;
+        j3 = j2 + m;
+        x2 = cdft_avx2_cmulconj(wt1, _mm256_loadu_pd(&a[j2]));
+        x3 = cdft_avx2_cmul(wt3, _mm256_loadu_pd(&a[j3]));
+        x0 = _mm256_loadu_pd(&a[j0]);
+        x1 = _mm256_loadu_pd(&a[j1]);
+        y0 = _mm256_add_pd(x2, x3);
+        y1 = cdft_avx2_imul(_mm256_sub_pd(x2, x3), sgn);
+        _mm256_storeu_pd(&a[j0], _mm256_add_pd(x0, y0));
+        _mm256_storeu_pd(&a[j2], _mm256_sub_pd(x0, y0));
+        _mm256_storeu_pd(&a[j1], _mm256_sub_pd(x1, y1));
+        _mm256_storeu_pd(&a[j3], _mm256_add_pd(x1, y1));
+        wk0 = wk2;
+    }
+}
+#endif /* USE_CDFT_SIMD */
+
+
+void cftsx4(int n, double *ar, double *ai, int isgn)
+{
+    int j;
+    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+    
+    if (isgn < 0) {
+        /* the conjugate transform: swap the roles of ar and ai */
+        cftsx4(n, ai, ar, 1);
+        return;
+    }
+    for (j = 0; j < n; j += 4) {
+        x0r = ar[j] + ar[j + 2];
+        x0i = ai[j] + ai[j + 2];
+        x1r = ar[j] - ar[j + 2];
+        x1i = ai[j] - ai[j + 2];
+        x2r = ar[j + 1] + ar[j + 3];
+        x2i = ai[j + 1] + ai[j + 3];
+        x3r = ar[j + 1] - ar[j + 3];
+        x3i = ai[j + 1] - ai[j + 3];
+        ar[j] = x0r + x2r;
+        ai[j] = x0i + x2i;
+        ar[j + 1] = x0r - x2r;
+        ai[j + 1] = x0i - x2i;
+        ar[j + 2] = x1r - x3i;
+        ai[j + 2] = x1i + x3r;
+        ar[j + 3] = x1r + x3i;
+        ai[j + 3] = x1i - x3r;
+    }
+}
+
+
+void cftsx2(int n, double *ar, double *ai)
+{
+    int j;
+    double xr, xi;
+    
+    for (j = 0; j < n; j += 2) {
+        xr = ar[j] - ar[j + 1];
+        xi = ai[j] - ai[j + 1];
+        ar[j] += ar[j + 1];
+        ai[j] += ai[j + 1];
+        ar[j + 1] = xr;
+        ai[j + 1] = xi;
+    }
+}
+
+
+/* 
+   bit reversal in tiles: k = (a, b, c) with a, c of tb bits goes to 
+   (rev c, rev b, rev a); the tile of one b (2^tb rows of 2^tb) is 
+   copied, bit reversed, to a local buffer and exchanged with the 
+   tile of rev b row by row, so that every row is read and written 
+   once, contiguously (the rows are 2^(lg-tb) apart: the plain loop 
+   and a swap in place miss the cache on about every element) 
+*/
+#ifndef BITRVS_TILE_LOG2
+#define BITRVS_TILE_LOG2 4
+#endif
+
+
+void bitrvs(int n, double *ar, double *ai)
+{
+    int lg, tb, nt, nb, sh, a, b, c, rb, l, ib, jb, k, 
+        rv[1 << BITRVS_TILE_LOG2];
+    double xr, xi, tr[1 << (2 * BITRVS_TILE_LOG2)], 
+        ti[1 << (2 * BITRVS_TILE_LOG2)];
+    
+    for (lg = 0; (1 << lg) < n; lg++);
+    tb = lg >> 1;
+    if (tb > BITRVS_TILE_LOG2) {
+        tb = BITRVS_TILE_LOG2;
+    }
+    nt = 1 << tb;
+    nb = 1 << (lg - 2 * tb);
+    sh = lg - tb;
+    rv[0] = 0;
+    for (a = 1; a < nt; a++) {
+        rv[a] = (rv[a >> 1] >> 1) | ((a & 1) << (tb - 1));
+    }
+    rb = 0;
+    for (b = 0; b < nb; b++) {
+        if (b <= rb) {
+            /* t = tile b, bit reversed */
+            for (a = 0; a < nt; a++) {
+                ib = (a << sh) + (b << tb);
+                for (c = 0; c < nt; c++) {
+                    k = (rv[c] << tb) + rv[a];
+                    tr[k] = ar[ib + c];
+                    ti[k] = ai[ib + c];
+                }
+            }
+            if (b == rb) {
+                for (a = 0; a < nt; a++) {
+                    ib = (a << sh) + (b << tb);
+                    for (c = 0; c < nt; c++) {
+                        ar[ib + c] = tr[(a << tb) + c];
+                        ai[ib + c] = ti[(a << tb) + c];
+                    }
+                }
+            } else {
+                /* tile rb <-> t, then tile b = old tile rb, 
+                   bit reversed */
+                for (a = 0; a < nt; a++) {
+                    jb = (a << sh) + (rb << tb);
+                    for (c = 0; c < nt; c++) {
+                        k = (a << tb) + c;
+                        xr = ar[jb + c];
+                        xi = ai[jb + c];
+                        ar[jb + c] = tr[k];
+                        ai[jb + c] = ti[k];
+                        tr[k] = xr;
+                        ti[k] = xi;
+                    }
+                }
+                for (a = 0; a < nt; a++) {
+                    ib = (a << sh) + (b << tb);
+                    for (c = 0; c < nt; c++) {
+                        k = (rv[c] << tb) + rv[a];
+                        ar[ib + c] = tr[k];
+                        ai[ib + c] = ti[k];
+                    }
+                }
+            }
+        }
+        /* rb = reverse of b + 1 (lg - 2 * tb bits) */
+        for (l = nb >> 1; l > 0 && l <= rb; l >>= 1) {
+            rb -= l;
+        }
+        rb += l;
+    }
+}
+
+
+#ifdef USE_CDFT_SIMD
+/* 
+   out of place bit reversal of the n/2 complex a[] -> b[] 
+   (isgn < 0: conjugated) in the tiles of bitrvs: tile m of a[], 
+   bit reversed in t, is written row by row to tile rev m of b[] 
+   with streaming stores (b[] on 64 bytes): each line of b[] is 
+   written once, so reading it into the cache first is wasted; 
+   the tiles are independent and are split over the threads 
+*/
+struct bitrv2o_arg {
+    int isgn, lg, tb;
+    double *a, *b;
+};
+
+
+void bitrv2o(int n, int isgn, double *a, double *b)
+{
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t, 
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void bitrv2o_sse2(void *arg, int m0, int m1, double *t);
+    struct bitrv2o_arg arg;
+    
+    for (arg.lg = 0; (2 << arg.lg) < n; arg.lg++);
+    arg.tb = arg.lg >> 1;
+    if (arg.tb > BITRVS_TILE_LOG2) {
+        arg.tb = BITRVS_TILE_LOG2;
+    }
+    arg.isgn = isgn;
+    arg.a = a;
+    arg.b = b;
+    cdft_threads_for(2 << (2 * arg.tb), 1, 1 << (arg.lg - 2 * arg.tb), 0, 
+        NULL, bitrv2o_sse2, &arg);
+}
+
+
+cdft_target("sse2")
+void bitrv2o_sse2(void *arg, int m0, int m1, double *t)
+{
+    struct bitrv2o_arg *p = (struct bitrv2o_arg *) arg;
+    int tb, nt, nb, sh, i, m, c, rm, l, rv[1 << BITRVS_TILE_LOG2];
+    long ro[1 << BITRVS_TILE_LOG2];
+    __m128d sgn, *x, *y, *z, tt[1 << (2 * BITRVS_TILE_LOG2)];
+    
+    tb = p->tb;
+    nt = 1 << tb;
+    nb = 1 << (p->lg - 2 * tb);
+    sh = p->lg - tb;
+    rv[0] = 0;
+    for (i = 1; i < nt; i++) {
+        rv[i] = (rv[i >> 1] >> 1) | ((i & 1) << (tb - 1));
+    }
+    for (i = 0; i < nt; i++) {
+        ro[i] = (long) i << sh;
+    }
+    sgn = _mm_set_pd(p->isgn >= 0 ? 0.0 : -0.0, 0.0);
+    /* rm = reverse of m (lg - 2 * tb bits) */
+    rm = 0;
+    for (l = 1, m = nb >> 1; l < nb; l <<= 1, m >>= 1) {
+        if ((m0 & l) != 0) {
+            rm |= m;
+        }
+    }
+    for (m = m0; m < m1; m++) {
+        for (i = 0; i < nt; i++) {
+            x = (__m128d *) p->a + ro[i] + (m << tb);
+            z = tt + rv[i];
+            for (c = 0; c < nt; c++) {
+                z[rv[c] << tb] = x[c];
+            }
+        }
+        for (i = 0; i < nt; i++) {
+            y = (__m128d *) p->b + ro[i] + (rm << tb);
+            z = tt + (i << tb);
+            for (c = 0; c < nt; c++) {
+                _mm_stream_pd((double *) &y[c], _mm_xor_pd(z[c], sgn));
+            }
+        }
+        for (l = nb >> 1; l > 0 && l <= rm; l >>= 1) {
+            rm -= l;
+        }
+        rm += l;
+    }
+    _mm_sfence();
+}
+#endif /* USE_CDFT_SIMD */
+
+
+/* 
+   strided data: the first radix 4 stage reads x[j] from ar[j * s], 
+   ai[j * s] into the work area b and the bit reversal writes b back 
+   to ar[], ai[], so that there is no separate gather or scatter copy 
+*/
+void cftsub_st(int n, int isgn, double *ar, double *ai, int s, 
+    double *b, int nw, double *w)
+{
+    void cftx1st_st(int n, int isgn, double *ar, double *ai, int s, 
+        double *b, double *w);
+    void cftrec4(int n, double *a, int nw, double *w);
+    void cftleaf(int n, int isplt, double *a, int nw, double *w);
+    void cftfx41(int n, double *a, int nw, double *w);
+#ifdef USE_CDFT_THREADS
+    void cftrec4_th(int n, double *a, int nw, double *w);
+    void cdft_threads_init(void);
+#endif /* USE_CDFT_THREADS */
+#ifdef USE_CDFT_THREADS
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+#endif /* USE_CDFT_THREADS */
+    cftx1st_st(n, isgn, ar, ai, s, b, &w[nw - (n >> 2)]);
+#ifdef USE_CDFT_THREADS
+    if (n > 512 && n > cdft_threads_begin_n) {
+        cftrec4_th(n, b, nw, w);
+    } else 
+#endif /* USE_CDFT_THREADS */
+    if (n > 512) {
+        cftrec4(n, b, nw, w);
+    } else if (n > 128) {
+        cftleaf(n, 1, b, nw, w);
+    } else {
+        cftfx41(n, b, nw, w);
+    }
+}
+
+
+void cftx1st_st(int n, int isgn, double *ar, double *ai, int s, 
+    double *b, double *w)
+{
+    void cftx1st_w(int k, int mq, double *w, double *wk);
+    int c, k, m, mq;
+    long j0, j1, j2, j3;
+    double wk1r, wk1i, wk3r, wk3i, wk[4], wd[4];
+    double x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, y1r, y1i, y3r, y3i;
+    
+    m = n >> 3;
+    mq = n >> 4;
+    for (c = 0; c < m; c++) {
+        /* as in cftf1st: the table holds even k <= n/16, odd k are 
+           interpolated, k > n/16 are mirrored */
+        k = c <= mq ? c : m - c;
+        if ((k & 1) == 0) {
+            cftx1st_w(k, mq, w, wk);
+        } else {
+            cftx1st_w(k - 1, mq, w, wk);
+            cftx1st_w(k + 1, mq, w, wd);
+            wk[0] = w[2] * (wk[0] + wd[0]);
+            wk[1] = w[2] * (wk[1] + wd[1]);
+            wk[2] = w[3] * (wk[2] + wd[2]);
+            wk[3] = w[3] * (wk[3] + wd[3]);
+        }
+        if (c <= mq) {
+            wk1r = wk[0];
+            wk1i = wk[1];
+            wk3r = wk[2];
+            wk3i = wk[3];
+        } else {
+            wk1r = wk[1];
+            wk1i = wk[0];
+            wk3r = wk[3];
+            wk3i = wk[2];
+        }
+        j0 = (long) c * s;
+        j1 = j0 + (long) m * s;
+        j2 = j1 + (long) m * s;
+        j3 = j2 + (long) m * s;
+        x0r = ar[j0] + ar[j2];
+        x0i = ai[j0] + ai[j2];
+        x1r = ar[j0] - ar[j2];
+        x1i = ai[j0] - ai[j2];
+        x2r = ar[j1] + ar[j3];
+        x2i = ai[j1] + ai[j3];
+        x3r = ar[j1] - ar[j3];
+        x3i = ai[j1] - ai[j3];
+        if (isgn < 0) {
+            x0i = -x0i;
+            x1i = -x1i;
+            x2i = -x2i;
+            x3i = -x3i;
+        }
+        j0 = 2 * c;
+        j1 = j0 + 2 * m;
+        j2 = j1 + 2 * m;
+        j3 = j2 + 2 * m;
+        b[j0] = x0r + x2r;
+        b[j0 + 1] = x0i + x2i;
+        b[j1] = x0r - x2r;
+        b[j1 + 1] = x0i - x2i;
+        y1r = x1r - x3i;
+        y1i = x1i + x3r;
+        b[j2] = wk1r * y1r - wk1i * y1i;
+        b[j2 + 1] = wk1r * y1i + wk1i * y1r;
+        y3r = x1r + x3i;
+        y3i = x1i - x3r;
+        b[j3] = wk3r * y3r + wk3i * y3i;
+        b[j3 + 1] = wk3r * y3i - wk3i * y3r;
+    }
+}
+
+
+void cftx1st_w(int k, int mq, double *w, double *wk)
+{
+    if (k == 0) {
+        wk[0] = 1;
+        wk[1] = 0;
+        wk[2] = 1;
+        wk[3] = 0;
+    } else if (k == mq) {
+        wk[0] = w[1];
+        wk[1] = w[1];
+        wk[2] = -w[1];
+        wk[3] = -w[1];
+    } else {
+        wk[0] = w[2 * k];
+        wk[1] = w[2 * k + 1];
+        wk[2] = w[2 * k + 2];
+        wk[3] = w[2 * k + 3];
+    }
+}
+
+
+void bitrv2_st(int n, int isgn, double *b, double *ar, double *ai, 
+    int s)
+{
+    int j, k, l, nh;
+    
+    nh = n >> 1;
+    j = 0;
+    for (k = 0; k < nh; k++) {
+        ar[(long) j * s] = b[2 * k];
+        ai[(long) j * s] = isgn >= 0 ? b[2 * k + 1] : -b[2 * k + 1];
+        if (k == nh - 1) {
+            break;
+        }
+        for (l = nh >> 1; l <= j; l >>= 1) {
+            j -= l;
+        }
+        j += l;
+    }
+}
+
+
+void rftfsub_st(int n, double *b, int nc, double *c, double *a, int s)
+{
+    int j, k, kk, ks, m;
+    double wkr, wki, xr, xi, yr, yi;
+    
+    m = n >> 1;
+    ks = 2 * nc / m;
+    kk = 0;
+    a[0] = b[0] + b[1];
+    a[s] = b[0] - b[1];
+    for (j = 2; j < m; j += 2) {
+        k = n - j;
+        kk += ks;
+        wkr = 0.5 - c[nc - kk];
+        wki = c[kk];
+        xr = b[j] - b[k];
+        xi = b[j + 1] + b[k + 1];
+        yr = wkr * xr - wki * xi;
+        yi = wkr * xi + wki * xr;
+        a[(long) j * s] = b[j] - yr;
+        a[(long) (j + 1) * s] = b[j + 1] - yi;
+        a[(long) k * s] = b[k] + yr;
+        a[(long) (k + 1) * s] = b[k + 1] - yi;
+    }
+    a[(long) m * s] = b[m];
+    a[(long) (m + 1) * s] = b[m + 1];
+}
+
+
+void rftbsub_st(int n, double *a, int s, int nc, double *c, double *b)
+{
+    int j, k, kk, ks, m;
+    double wkr, wki, xr, xi, yr, yi, x0r, x0i, x1r, x1i;
+    
+    m = n >> 1;
+    ks = 2 * nc / m;
+    kk = 0;
+    b[1] = 0.5 * (a[0] - a[s]);
+    b[0] = a[0] - b[1];
+    for (j = 2; j < m; j += 2) {
+        k = n - j;
+        kk += ks;
+        wkr = 0.5 - c[nc - kk];
+        wki = c[kk];
+        x0r = a[(long) j * s];
+        x0i = a[(long) (j + 1) * s];
+        x1r = a[(long) k * s];
+        x1i = a[(long) (k + 1) * s];
+        xr = x0r - x1r;
+        xi = x0i + x1i;
+        yr = wkr * xr + wki * xi;
+        yi = wkr * xi - wki * xr;
+        b[j] = x0r - yr;
+        b[j + 1] = x0i - yi;
+        b[k] = x1r + yr;
+        b[k + 1] = x1i - yi;
+    }
+    b[m] = a[(long) m * s];
+    b[m + 1] = a[(long) (m + 1) * s];
+}
+
+
+
+/* -------- plan routines -------- */
+
+
+#include <stdlib.h>
+
+/* acquire load and compare-and-swap of a list head (fft_tables,
+   fft_chirps): pp is a pointer to any pointer type, old is an 
+   lvalue (the C11 branch overwrites it when the swap fails), 
+   fft_table_atomic(t) is the type of a list head of type t */
+#if defined(__GNUC__)
+#define fft_table_atomic(t) t
+#define fft_table_load(pp) __atomic_load_n(pp, __ATOMIC_ACQUIRE)
+#define fft_table_cas(pp, old, new) __sync_bool_compare_and_swap(pp, old, new)
+#elif defined(_WIN32)
+#include <windows.h>
+#define fft_table_atomic(t) t
+#define fft_table_load(pp) \
+    InterlockedCompareExchangePointer((PVOID volatile *) (pp), NULL, NULL)
+#define fft_table_cas(pp, old, new) \
+    (InterlockedCompareExchangePointer((PVOID volatile *) (pp), \
+    (PVOID) (new), (PVOID) (old)) == (PVOID) (old))
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define fft_table_atomic(t) _Atomic(t)
+#define fft_table_load(pp) atomic_load_explicit(pp, memory_order_acquire)
+#define fft_table_cas(pp, old, new) \
+    atomic_compare_exchange_strong(pp, &(old), new)
+#elif defined(USE_CDFT_THREADS)
+/* other compilers: the list head is read and swapped under a mutex */
+#define fft_table_atomic(t) t
+#define fft_table_load(pp) (fft_table_lock(), fft_table_unlockp(*(pp)))
+#define fft_table_cas(pp, old, new) (fft_table_lock(), \
+    fft_table_unlocki(*(pp) == (old) ? (*(pp) = (new), 1) : 0))
+cdft_mutex_t fft_table_mutex = CDFT_MUTEX_INITIALIZER;
+
+int fft_table_lock(void)
+{
+    cdft_mutex_lock(&fft_table_mutex);
+    return 0;
+}
+
+void *fft_table_unlockp(void *p)
+{
+    cdft_mutex_unlock(&fft_table_mutex);
+    return p;
+}
+
+int fft_table_unlocki(int r)
+{
+    cdft_mutex_unlock(&fft_table_mutex);
+    return r;
+}
+#else
+/* pre-C11 compilers without threads: plans from one thread at a time */
+#define fft_table_atomic(t) t
+#define fft_table_load(pp) (*(pp))
+#define fft_table_cas(pp, old, new) (*(pp) = (new), 1)
+#endif
+
+/* cos/sin tables shared by all plans, never modified after publication */
+struct fft_table {
+    struct fft_table *next;
+    int nw, nc;
+    int *ip;
+    double *w;
+    void *mem;
+};
+fft_table_atomic(struct fft_table *) fft_tables = NULL;
+
+/* chirp-z tables, shared by the plans of one length and sign */
+struct fft_chirp {
+    struct fft_chirp *next;
+    int n, isgn;
+    double *c;
+    void *mem;
+};
+fft_table_atomic(struct fft_chirp *) fft_chirps = NULL;
+
+/* radix 3, 5, 7 twiddles, shared by the mixed radix plans of one 
+   length and sign */
+struct fft_radix {
+    struct fft_radix *next;
+    int n, isgn;
+    double *wr;
+    void *mem;
+};
+fft_table_atomic(struct fft_radix *) fft_radixes = NULL;
+
+struct fft_plan {
+    int n, isgn, nw, nc, nt;
+    int nd, nv;
+    int nb, nr, r[20];
+    int *ip;
+    double *w, *t, *wr, *wc;
+    void (*exec)(struct fft_plan *p, double *a);
+    void (*cftm)(struct fft_plan *p, double *a);
+    void (*cft1st)(int n, double *a, double *w);
+    void (*cftrec)(int n, double *a, int nw, double *w);
+    void (*bitrv)(int n, int *ip, double *a);
+    void *mem;
+};
+
+
+struct fft_plan *cdft_plan_create(int n, int isgn)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    struct fft_plan *fft_plan_mixed(int n, int isgn, int nx);
+    struct fft_plan *fft_plan_chirp(int n, int isgn, int nx);
+    void cdft_exec(struct fft_plan *p, double *a);
+    struct fft_plan *p;
+    
+    if ((n & (n - 1)) != 0) {
+        p = fft_plan_mixed(n, isgn, 0);
+        if (p == NULL) {
+            p = fft_plan_chirp(n, isgn, 0);
+        }
+        if (p != NULL) {
+            p->exec = p->cftm;
+            p->nd = n >> 1;
+            p->nv = 2;
+        }
+        return p;
+    }
+    p = fft_plan_alloc(n, isgn, n >> 2, 0, 0, 0);
+    if (p != NULL) {
+        p->exec = cdft_exec;
+        p->nd = n >> 1;
+        p->nv = 2;
+    }
+    return p;
+}
+
+
+struct fft_plan *rdft_plan_create(int n, int isgn)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    struct fft_plan *fft_plan_mixed(int n, int isgn, int nx);
+    struct fft_plan *fft_plan_chirp(int n, int isgn, int nx);
+    void rdft_exec(struct fft_plan *p, double *a);
+    void rdftm_exec(struct fft_plan *p, double *a);
+    int j, m;
+    double delta;
+    struct fft_plan *p;
+    
+    if ((n & (n - 1)) != 0) {
+        m = n >> 1;
+        p = fft_plan_mixed(n, isgn, m + 2);
+        if (p == NULL) {
+            p = fft_plan_chirp(n, isgn, m + 2);
+        }
+        if (p != NULL) {
+            p->exec = rdftm_exec;
+            p->nd = n;
+            p->nv = 1;
+            /* wc[j], wc[j+1] = wkr, wki of rftfsub for a[j], a[n-j] */
+            delta = 4 * atan(1.0) / n;
+            for (j = 2; j < m; j += 2) {
+                p->wc[j] = 0.5 - 0.5 * sin(delta * j);
+                p->wc[j + 1] = 0.5 * cos(delta * j);
+            }
+        }
+        return p;
+    }
+    p = fft_plan_alloc(n, isgn, n >> 2, n >> 2, 0, 0);
+    if (p != NULL) {
+        p->exec = rdft_exec;
+    }
+    return p;
+}
+
+
+struct fft_plan *ddct_plan_create(int n, int isgn)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    void ddct_exec(struct fft_plan *p, double *a);
+    struct fft_plan *p;
+    
+    p = fft_plan_alloc(n, isgn, n >> 2, n, 0, 0);
+    if (p != NULL) {
+        p->exec = ddct_exec;
+    }
+    return p;
+}
+
+
+struct fft_plan *ddst_plan_create(int n, int isgn)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    void ddst_exec(struct fft_plan *p, double *a);
+    struct fft_plan *p;
+    
+    p = fft_plan_alloc(n, isgn, n >> 2, n, 0, 0);
+    if (p != NULL) {
+        p->exec = ddst_exec;
+    }
+    return p;
+}
+
+
+struct fft_plan *dfct_plan_create(int n)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    void dfct_exec(struct fft_plan *p, double *a);
+    struct fft_plan *p;
+    
+    p = fft_plan_alloc(n, 1, n >> 3, n >> 1, (n >> 1) + 1, 0);
+    if (p != NULL) {
+        p->exec = dfct_exec;
+        p->nd = n + 1;
+    }
+    return p;
+}
+
+
+struct fft_plan *dfst_plan_create(int n)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    void dfst_exec(struct fft_plan *p, double *a);
+    struct fft_plan *p;
+    
+    p = fft_plan_alloc(n, 1, n >> 3, n >> 1, n >> 1, 0);
+    if (p != NULL) {
+        p->exec = dfst_exec;
+    }
+    return p;
+}
+
+
+int fft_plan_exec(struct fft_plan *p, double *a)
+{
+    void *mem;
+    struct fft_plan q;
+    
+    if (p->nt == 0) {
+        (*p->exec)(p, a);
+        return 0;
+    }
+    /* the work area t of dfct, dfst, mixed radix, chirp-z: per call */
+    mem = malloc(sizeof(double) * p->nt + 64);
+    if (mem == NULL) {
+        return -1;
+    }
+    q = *p;
+    q.t = (double *) (((size_t) mem + 63) & ~((size_t) 63));
+    (*q.exec)(&q, a);
+    free(mem);
+    return 0;
+}
+
+
+int fft_plan_exec_many(struct fft_plan *p, int howmany, double *a, 
+    int stride, int dist)
+{
+    void fft_plan_exec_range(struct fft_plan *p, int k0, int k1, 
+        double *a, int stride, int dist, double *b, double *t);
+#ifdef USE_CDFT_THREADS
+    int cdft_threads_n(int n);
+    int fft_batch_th(struct fft_plan *p, int howmany, double *a, 
+        int stride, int dist, int nthread);
+    int nthread;
+#endif /* USE_CDFT_THREADS */
+    int nb;
+    void *mem;
+    double *wk;
+    
+    if (howmany <= 0) {
+        return 0;
+    }
+#ifdef USE_CDFT_THREADS
+    nthread = cdft_threads_n(howmany < (1 << 30) / p->n ? 
+        p->n * howmany : 1 << 30);
+    if (howmany > 1 && nthread > 1 && p->n <= cdft_threads_begin_n) {
+        return fft_batch_th(p, howmany, a, stride, dist, nthread);
+    }
+#endif /* USE_CDFT_THREADS */
+    /* the gather area b[] and t[] of dfct, dfst, mixed radix, chirp-z */
+    nb = stride != p->nv ? p->nd * p->nv : 0;
+    mem = NULL;
+    wk = NULL;
+    if (nb + p->nt > 0) {
+        mem = malloc(sizeof(double) * (nb + p->nt) + 64);
+        if (mem == NULL) {
+            return -1;
+        }
+        wk = (double *) (((size_t) mem + 63) & ~((size_t) 63));
+    }
+    fft_plan_exec_range(p, 0, howmany, a, stride, dist, 
+        nb > 0 ? wk : NULL, p->nt > 0 ? wk + nb : NULL);
+    free(mem);
+    return 0;
+}
+
+
+void fft_plan_exec_range(struct fft_plan *p, int k0, int k1, 
+    double *a, int stride, int dist, double *b, double *t)
+{
+    int j, k, nd, nv;
+    double *x;
+    struct fft_plan q;
+    
+    /* the same plan with the work area t of this caller */
+    q = *p;
+    q.t = t;
+    nd = p->nd;
+    nv = p->nv;
+    for (k = k0; k < k1; k++) {
+        x = a + (long) k * dist;
+        if (b == NULL) {
+            (*q.exec)(&q, x);
+            continue;
+        }
+        if (nv == 2) {
+            for (j = 0; j < nd; j++) {
+                b[2 * j] = x[(long) j * stride];
+                b[2 * j + 1] = x[(long) j * stride + 1];
+            }
+        } else {
+            for (j = 0; j < nd; j++) {
+                b[j] = x[(long) j * stride];
+            }
+        }
+        (*q.exec)(&q, b);
+        if (nv == 2) {
+            for (j = 0; j < nd; j++) {
+                x[(long) j * stride] = b[2 * j];
+                x[(long) j * stride + 1] = b[2 * j + 1];
+            }
+        } else {
+            for (j = 0; j < nd; j++) {
+                x[(long) j * stride] = b[j];
+            }
+        }
+    }
+}
+
+
+#ifdef USE_CDFT_THREADS
+int fft_batch_th(struct fft_plan *p, int howmany, double *a, 
+    int stride, int dist, int nthread)
+{
+    int cdft_pool_open(int *nthread);
+    void cdft_pool_close(int id, cdft_job_t *job);
+    int cdft_pool_push(int id, cdft_task_t *tk);
+    void fft_batch_task(int id, cdft_task_t *tk);
+    void fft_plan_exec_range(struct fft_plan *p, int k0, int k1, 
+        double *a, int stride, int dist, double *b, double *t);
+    int i, id, nb, nwk, ntask;
+    void *mem;
+    double *wk;
+    cdft_job_t job;
+    cdft_task_t tk;
+    
+    ntask = nthread << 1;
+    if (ntask > CDFT_DEQUE_SIZE) {
+        ntask = CDFT_DEQUE_SIZE;
+    }
+    if (ntask > howmany) {
+        ntask = howmany;
+    }
+    /* each task: the gather area b[] and t[] of dfct, dfst, mixed 
+       radix, chirp-z */
+    nb = stride != p->nv ? p->nd * p->nv : 0;
+    nwk = (nb + p->nt + 7) & ~7;
+    mem = NULL;
+    wk = NULL;
+    if (nwk > 0) {
+        mem = malloc(sizeof(double) * nwk * ntask + 64);
+        if (mem == NULL) {
+            return -1;
+        }
+        wk = (double *) (((size_t) mem + 63) & ~((size_t) 63));
+    }
+    id = cdft_pool_open(&nthread);
+    if (id < 0) {
+        fft_plan_exec_range(p, 0, howmany, a, stride, dist, 
+            nb > 0 ? wk : NULL, wk != NULL ? wk + nb : NULL);
+        free(mem);
+        return 0;
+    }
+    job.plan = p;
+    job.stride = stride;
+    job.dist = dist;
+    job.nthread = nthread;
+    job.pending = 0;
+    tk.func = fft_batch_task;
+    tk.n = nb;
+    tk.a = a;
+    tk.job = &job;
+    cdft_mutex_lock(&cdft_pool_mutex);
+    for (i = ntask - 1; i >= 0; i--) {
+        tk.k0 = (int) ((long) howmany * i / ntask);
+        tk.k1 = (int) ((long) howmany * (i + 1) / ntask);
+        tk.b = wk != NULL ? wk + (long) nwk * i : NULL;
+        if (i > 0 && cdft_pool_push(id, &tk) != 0) {
+            if (++job.pending < nthread) {
+                cdft_cond_signal(&cdft_pool_work);
+            }
+        } else {
+            cdft_mutex_unlock(&cdft_pool_mutex);
+            fft_batch_task(id, &tk);
+            cdft_mutex_lock(&cdft_pool_mutex);
+        }
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+    cdft_pool_close(id, &job);
+    free(mem);
+    return 0;
+}
+
+
+void fft_batch_task(int id, cdft_task_t *tk)
+{
+    void fft_plan_exec_range(struct fft_plan *p, int k0, int k1, 
+        double *a, int stride, int dist, double *b, double *t);
+    
+    fft_plan_exec_range(tk->job->plan, tk->k0, tk->k1, tk->a, 
+        tk->job->stride, tk->job->dist, tk->n > 0 ? tk->b : NULL, 
+        tk->b != NULL ? tk->b + tk->n : NULL);
+}
+
+
+void cdft_loop_task(int id, cdft_task_t *tk)
+{
+    (*tk->job->loop)(tk->job->arg, tk->k0, tk->k1, tk->b);
+}
+#endif /* USE_CDFT_THREADS */
+
+
+void fft_plan_destroy(struct fft_plan *p)
+{
+    if (p != NULL) {
+        free(p->mem);
+        free(p);
+    }
+}
+
+
+struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+    int nx)
+{
+    struct fft_table *fft_table_get(int nw, int nc);
+    void cftf1st(int n, double *a, double *w);
+    void cftb1st(int n, double *a, double *w);
+    void cftrec4(int n, double *a, int nw, double *w);
+    void cftleaf1(int n, double *a, int nw, double *w);
+    void cftfx41(int n, double *a, int nw, double *w);
+    void bitrv2(int n, int *ip, double *a);
+    void bitrv2conj(int n, int *ip, double *a);
+#ifdef USE_CDFT_THREADS
+    void cftrec4_th(int n, double *a, int nw, double *w);
+    void bitrv2_th(int n, int *ip, double *a);
+    void bitrv2conj_th(int n, int *ip, double *a);
+#endif /* USE_CDFT_THREADS */
+    double *t;
+    struct fft_plan *p;
+    struct fft_table *tb;
+    
+    tb = fft_table_get(nw, nc);
+    if (tb == NULL) {
+        return NULL;
+    }
+    p = (struct fft_plan *) malloc(sizeof(struct fft_plan));
+    if (p == NULL) {
+        return NULL;
+    }
+    /* read-only data of this plan: wc[0...nx-1] */
+    p->mem = NULL;
+    t = NULL;
+    if (nx > 0) {
+        p->mem = malloc(sizeof(double) * nx + 64);
+        if (p->mem == NULL) {
+            free(p);
+            return NULL;
+        }
+        t = (double *) (((size_t) p->mem + 63) & ~((size_t) 63));
+    }
+    p->t = NULL;
+    p->n = n;
+    p->isgn = isgn;
+    p->nw = nw;
+    p->nc = nc;
+    p->nt = nt;
+    p->nd = n;
+    p->nv = 1;
+    p->nb = n;
+    p->nr = 0;
+    p->ip = tb->ip;
+    p->w = tb->w;
+    p->wr = NULL;
+    p->wc = nx > 0 ? t : NULL;
+    p->cftm = NULL;
+    p->cft1st = NULL;
+    p->cftrec = NULL;
+    p->bitrv = NULL;
+    if (n > 32 && n <= (nw << 2)) {
+        if (isgn >= 0) {
+            p->cft1st = cftf1st;
+            p->bitrv = bitrv2;
+        } else {
+            p->cft1st = cftb1st;
+            p->bitrv = bitrv2conj;
+        }
+#ifdef USE_CDFT_THREADS
+        if (n > 512 && isgn >= 0) {
+            p->bitrv = bitrv2_th;
+        } else if (n > 512) {
+            p->bitrv = bitrv2conj_th;
+        }
+#endif /* USE_CDFT_THREADS */
+#ifdef USE_CDFT_THREADS
+        /* cftrec4_th compares n with the thresholds at run time */
+        if (n > 512) {
+            p->cftrec = cftrec4_th;
+        } else 
+#endif /* USE_CDFT_THREADS */
+        if (n > 512) {
+            p->cftrec = cftrec4;
+        } else if (n > 128) {
+            p->cftrec = cftleaf1;
+        } else {
+            p->cftrec = cftfx41;
+        }
+    }
+    return p;
+}
+
+
+struct fft_table *fft_table_get(int nw, int nc)
+{
+    void makewt(int nw, int *ip, double *w);
+    void makect(int nc, int *ip, double *c);
+    struct fft_table *head, *tb, *tn;
+    int j, k;
+    
+    tn = NULL;
+    for (;;) {
+        head = fft_table_load(&fft_tables);
+        for (tb = head; tb != NULL; tb = tb->next) {
+            if (tb->nw == nw && tb->nc == nc) {
+                if (tn != NULL) {
+                    free(tn->mem);
+                    free(tn->ip);
+                    free(tn);
+                }
+                return tb;
+            }
+        }
+        if (tn == NULL) {
+            tn = (struct fft_table *) malloc(sizeof(struct fft_table));
+            if (tn == NULL) {
+                return NULL;
+            }
+            /* length of ip >= 2+(1<<(int)(log(2*nw+0.5)/log(2))/2) */
+            j = 1;
+            for (k = 2; k <= nw; k <<= 2) {
+                j <<= 1;
+            }
+            tn->ip = (int *) malloc(sizeof(int) * (2 + j));
+            tn->mem = malloc(sizeof(double) * (nw + nc + 1) + 64);
+            if (tn->ip == NULL || tn->mem == NULL) {
+                free(tn->ip);
+                free(tn->mem);
+                free(tn);
+                return NULL;
+            }
+            tn->w = (double *) (((size_t) tn->mem + 63) & ~((size_t) 63));
+            tn->nw = nw;
+            tn->nc = nc;
+            makewt(nw, tn->ip, tn->w);
+            makect(nc, tn->ip, tn->w + nw);
+        }
+        tn->next = head;
+        if (fft_table_cas(&fft_tables, head, tn)) {
+            return tn;
+        }
+    }
+}
+
+
+struct fft_plan *fft_plan_mixed(int n, int isgn, int nx)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    struct fft_radix *fft_radix_get(struct fft_plan *p, int nwr);
+    void fft_plan_destroy(struct fft_plan *p);
+    void cdftm_exec(struct fft_plan *p, double *a);
+    int k, l, m, nb, nr, nwr, r[20];
+    struct fft_plan *p;
+    struct fft_radix *rx;
+    
+    /* n = 2 * 2^a * 3^b * 5^c * 7^d: radix 3, 5, 7 stages, 2^a blocks */
+    if (n < 2 || (n & 1) != 0) {
+        return NULL;
+    }
+    m = n >> 1;
+    nb = 2;
+    while ((m & 1) == 0) {
+        m >>= 1;
+        nb <<= 1;
+    }
+    nr = 0;
+    nwr = 0;
+    l = n >> 1;
+    for (k = 3; k <= 7; k += 2) {
+        while (m % k == 0) {
+            m /= k;
+            r[nr++] = k;
+            l /= k;
+            nwr += 2 * (k - 1) * l;
+        }
+    }
+    if (m != 1) {
+        return NULL;
+    }
+    p = fft_plan_alloc(nb, isgn, nb >> 2, 0, n, nx);
+    if (p == NULL) {
+        return NULL;
+    }
+    p->n = n;
+    p->nr = nr;
+    for (k = 0; k < nr; k++) {
+        p->r[k] = r[k];
+    }
+    p->cftm = cdftm_exec;
+    rx = fft_radix_get(p, nwr);
+    if (rx == NULL) {
+        fft_plan_destroy(p);
+        return NULL;
+    }
+    p->wr = rx->wr;
+    return p;
+}
+
+
+struct fft_radix *fft_radix_get(struct fft_plan *p, int nwr)
+{
+    struct fft_radix *head, *rx, *rn;
+    int j, k, l, s;
+    double delta, *w;
+    
+    rn = NULL;
+    for (;;) {
+        head = fft_table_load(&fft_radixes);
+        for (rx = head; rx != NULL; rx = rx->next) {
+            if (rx->n == p->n && (rx->isgn >= 0) == (p->isgn >= 0)) {
+                if (rn != NULL) {
+                    free(rn->mem);
+                    free(rn);
+                }
+                return rx;
+            }
+        }
+        if (rn == NULL) {
+            rn = (struct fft_radix *) malloc(sizeof(struct fft_radix));
+            if (rn == NULL) {
+                return NULL;
+            }
+            rn->mem = malloc(sizeof(double) * nwr + 64);
+            if (rn->mem == NULL) {
+                free(rn);
+                return NULL;
+            }
+            rn->wr = (double *) (((size_t) rn->mem + 63) & ~((size_t) 63));
+            rn->n = p->n;
+            rn->isgn = p->isgn;
+            /* stage k: wr[2*(r-1)*j+2*(s-1)...] = exp(+-2*pi*i*j*s/l) */
+            w = rn->wr;
+            l = p->n >> 1;
+            for (k = 0; k < p->nr; k++) {
+                delta = 8 * atan(1.0) / l;
+                l /= p->r[k];
+                for (j = 0; j < l; j++) {
+                    for (s = 1; s < p->r[k]; s++) {
+                        w[0] = cos(delta * j * s);
+                        w[1] = p->isgn >= 0 ? sin(delta * j * s) : 
+                            -sin(delta * j * s);
+                        w += 2;
+                    }
+                }
+            }
+        }
+        rn->next = head;
+        if (fft_table_cas(&fft_radixes, head, rn)) {
+            return rn;
+        }
+    }
+}
+
+
+struct fft_plan *fft_plan_chirp(int n, int isgn, int nx)
+{
+    struct fft_plan *fft_plan_alloc(int n, int isgn, int nw, int nc, int nt, 
+        int nx);
+    struct fft_chirp *fft_chirp_get(struct fft_plan *p);
+    void fft_plan_destroy(struct fft_plan *p);
+    void cdftz_exec(struct fft_plan *p, double *a);
+    int nb;
+    struct fft_plan *p;
+    struct fft_chirp *cz;
+    
+    /* any n/2: cyclic convolution of length 2^m >= n - 1 */
+    if (n < 2 || (n & 1) != 0 || n > (1 << 29)) {
+        return NULL;
+    }
+    nb = 4;
+    while (nb < 2 * n - 2) {
+        nb <<= 1;
+    }
+    p = fft_plan_alloc(nb, isgn, nb >> 2, 0, nb, nx);
+    if (p == NULL) {
+        return NULL;
+    }
+    p->n = n;
+    p->cftm = cdftz_exec;
+    cz = fft_chirp_get(p);
+    if (cz == NULL) {
+        fft_plan_destroy(p);
+        return NULL;
+    }
+    p->wr = cz->c;
+    return p;
+}
+
+
+struct fft_chirp *fft_chirp_get(struct fft_plan *p)
+{
+    void cftpsub(struct fft_plan *p, double *a);
+    struct fft_chirp *head, *cz, *cn;
+    int j, k, m, nb;
+    double delta, *c, *h;
+    
+    m = p->n >> 1;
+    nb = p->nb;
+    cn = NULL;
+    for (;;) {
+        head = fft_table_load(&fft_chirps);
+        for (cz = head; cz != NULL; cz = cz->next) {
+            if (cz->n == p->n && (cz->isgn >= 0) == (p->isgn >= 0)) {
+                if (cn != NULL) {
+                    free(cn->mem);
+                    free(cn);
+                }
+                return cz;
+            }
+        }
+        if (cn == NULL) {
+            cn = (struct fft_chirp *) malloc(sizeof(struct fft_chirp));
+            if (cn == NULL) {
+                return NULL;
+            }
+            cn->mem = malloc(sizeof(double) * (p->n + nb) + 64);
+            if (cn->mem == NULL) {
+                free(cn);
+                return NULL;
+            }
+            cn->c = (double *) (((size_t) cn->mem + 63) & ~((size_t) 63));
+            cn->n = p->n;
+            cn->isgn = p->isgn;
+            /* c[k] = exp(+-pi*i*k*k/m), h = conj of FFT(conj(c[|k|]))/L */
+            c = cn->c;
+            h = c + p->n;
+            delta = 4 * atan(1.0) / m;
+            for (k = 0; k < m; k++) {
+                j = (int) ((long long) k * k % (2 * m));
+                c[2 * k] = cos(delta * j);
+                c[2 * k + 1] = p->isgn >= 0 ? sin(delta * j) : 
+                    -sin(delta * j);
+            }
+            for (j = 0; j < nb; j++) {
+                h[j] = 0;
+            }
+            h[0] = c[0];
+            h[1] = -c[1];
+            for (k = 1; k < m; k++) {
+                h[2 * k] = c[2 * k];
+                h[2 * k + 1] = -c[2 * k + 1];
+                h[nb - 2 * k] = c[2 * k];
+                h[nb - 2 * k + 1] = -c[2 * k + 1];
+            }
+            cftpsub(p, h);
+            delta = 2.0 / nb;
+            for (j = 0; j < nb; j += 2) {
+                h[j] *= delta;
+                h[j + 1] *= -delta;
+            }
+        }
+        cn->next = head;
+        if (fft_table_cas(&fft_chirps, head, cn)) {
+            return cn;
+        }
+    }
+}
+
+
+void cftpsub(struct fft_plan *p, double *a)
+{
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    
+    if (p->cftrec != NULL) {
+        (*p->cft1st)(p->nb, a, &p->w[p->nw - (p->nb >> 2)]);
+        (*p->cftrec)(p->nb, a, p->nw, p->w);
+        (*p->bitrv)(p->nb, p->ip, a);
+    } else if (p->isgn >= 0) {
+        cftfsub(p->nb, a, p->ip, p->nw, p->w);
+    } else {
+        cftbsub(p->nb, a, p->ip, p->nw, p->w);
+    }
+}
+
+
+void cdft_exec(struct fft_plan *p, double *a)
+{
+    void cftpsub(struct fft_plan *p, double *a);
+    
+    cftpsub(p, a);
+}
+
+
+void rdft_exec(struct fft_plan *p, double *a)
+{
+    void cftpsub(struct fft_plan *p, double *a);
+    void rftfsub(int n, double *a, int nc, double *c);
+    void rftbsub(int n, double *a, int nc, double *c);
+    int n;
+    double xi;
+    
+    n = p->n;
+    if (p->isgn >= 0) {
+        if (n > 4) {
+            cftpsub(p, a);
+            rftfsub(n, a, p->nc, p->w + p->nw);
+        } else if (n == 4) {
+            cftpsub(p, a);
+        }
+        xi = a[0] - a[1];
+        a[0] += a[1];
+        a[1] = xi;
+    } else {
+        a[1] = 0.5 * (a[0] - a[1]);
+        a[0] -= a[1];
+        if (n > 4) {
+            rftbsub(n, a, p->nc, p->w + p->nw);
+            cftpsub(p, a);
+        } else if (n == 4) {
+            cftpsub(p, a);
+        }
+    }
+}
+
+
+void ddct_exec(struct fft_plan *p, double *a)
+{
+    void cftpsub(struct fft_plan *p, double *a);
+    void rftfsub(int n, double *a, int nc, double *c);
+    void rftbsub(int n, double *a, int nc, double *c);
+    void dctsub(int n, double *a, int nc, double *c);
+    int j, n;
+    double xr;
+    
+    n = p->n;
+    if (p->isgn < 0) {
+        xr = a[n - 1];
+        for (j = n - 2; j >= 2; j -= 2) {
+            a[j + 1] = a[j] - a[j - 1];
+            a[j] += a[j - 1];
+        }
+        a[1] = a[0] - xr;
+        a[0] += xr;
+        if (n > 4) {
+            rftbsub(n, a, p->nc, p->w + p->nw);
+            cftpsub(p, a);
+        } else if (n == 4) {
+            cftpsub(p, a);
+        }
+    }
+    dctsub(n, a, p->nc, p->w + p->nw);
+    if (p->isgn >= 0) {
+        if (n > 4) {
+            cftpsub(p, a);
+            rftfsub(n, a, p->nc, p->w + p->nw);
+        } else if (n == 4) {
+            cftpsub(p, a);
+        }
+        xr = a[0] - a[1];
+        a[0] += a[1];
+        for (j = 2; j < n; j += 2) {
+            a[j - 1] = a[j] - a[j + 1];
+            a[j] += a[j + 1];
+        }
+        a[n - 1] = xr;
+    }
+}
+
+
+void ddst_exec(struct fft_plan *p, double *a)
+{
+    void cftpsub(struct fft_plan *p, double *a);
+    void rftfsub(int n, double *a, int nc, double *c);
+    void rftbsub(int n, double *a, int nc, double *c);
+    void dstsub(int n, double *a, int nc, double *c);
+    int j, n;
+    double xr;
+    
+    n = p->n;
+    if (p->isgn < 0) {
+        xr = a[n - 1];
+        for (j = n - 2; j >= 2; j -= 2) {
+            a[j + 1] = -a[j] - a[j - 1];
+            a[j] -= a[j - 1];
+        }
+        a[1] = a[0] + xr;
+        a[0] -= xr;
+        if (n > 4) {
+            rftbsub(n, a, p->nc, p->w + p->nw);
+            cftpsub(p, a);
+        } else if (n == 4) {
+            cftpsub(p, a);
+        }
+    }
+    dstsub(n, a, p->nc, p->w + p->nw);
+    if (p->isgn >= 0) {
+        if (n > 4) {
+            cftpsub(p, a);
+            rftfsub(n, a, p->nc, p->w + p->nw);
+        } else if (n == 4) {
+            cftpsub(p, a);
+        }
+        xr = a[0] - a[1];
+        a[0] += a[1];
+        for (j = 2; j < n; j += 2) {
+            a[j - 1] = -a[j] - a[j + 1];
+            a[j] -= a[j + 1];
+        }
+        a[n - 1] = -xr;
+    }
+}
+
+
+void dfct_exec(struct fft_plan *p, double *a)
+{
+    void dfct(int n, double *a, double *t, int *ip, double *w);
+    
+    dfct(p->n, a, p->t, p->ip, p->w);
+}
+
+
+void dfst_exec(struct fft_plan *p, double *a)
+{
+    void dfst(int n, double *a, double *t, int *ip, double *w);
+    
+    dfst(p->n, a, p->t, p->ip, p->w);
+}
+
+
+void cdftm_exec(struct fft_plan *p, double *a)
+{
+    void cftrecm(struct fft_plan *p, int k, int l, int m, double *x, 
+        double *y, double *a, double *w);
+    
+    cftrecm(p, 0, p->n >> 1, 1, a, p->t, a, p->wr);
+}
+
+
+void rdftm_exec(struct fft_plan *p, double *a)
+{
+    void rftfsubm(int n, double *a, double *c);
+    void rftbsubm(int n, double *a, double *c);
+    double xi;
+    
+    if (p->isgn >= 0) {
+        (*p->cftm)(p, a);
+        rftfsubm(p->n, a, p->wc);
+        xi = a[0] - a[1];
+        a[0] += a[1];
+        a[1] = xi;
+    } else {
+        a[1] = 0.5 * (a[0] - a[1]);
+        a[0] -= a[1];
+        rftbsubm(p->n, a, p->wc);
+        (*p->cftm)(p, a);
+    }
+}
+
+
+/*
+   chirp-z (Bluestein): X[k] = c[k] * sum_j (x[j] * c[j]) * conj(c[k-j]), 
+   c[k] = exp(+-pi*i*k*k/m); the cyclic convolution of length L 
+   (2^m >= 2*m-1) runs as two FFTs of the same sign, 
+   conv = conj(FFT(conj(FFT(y) * FFT(h)))) / L
+*/
+void cdftz_exec(struct fft_plan *p, double *a)
+{
+    void cftpsub(struct fft_plan *p, double *a);
+    int j, n, nb;
+    double *c, *h, *t, xr, xi;
+    
+    n = p->n;
+    nb = p->nb;
+    c = p->wr;
+    h = c + n;
+    t = p->t;
+    for (j = 0; j < n; j += 2) {
+        t[j] = a[j] * c[j] - a[j + 1] * c[j + 1];
+        t[j + 1] = a[j] * c[j + 1] + a[j + 1] * c[j];
+    }
+    for (j = n; j < nb; j++) {
+        t[j] = 0;
+    }
+    cftpsub(p, t);
+    for (j = 0; j < nb; j += 2) {
+        xr = t[j] * h[j] + t[j + 1] * h[j + 1];
+        xi = t[j] * h[j + 1] - t[j + 1] * h[j];
+        t[j] = xr;
+        t[j + 1] = xi;
+    }
+    cftpsub(p, t);
+    for (j = 0; j < n; j += 2) {
+        a[j] = c[j] * t[j] + c[j + 1] * t[j + 1];
+        a[j + 1] = c[j + 1] * t[j] - c[j] * t[j + 1];
+    }
+}
+
+
+/*
+   mixed radix: the radix r stage splits l points into r blocks of 
+   l/r (decimation in frequency), depth first so that the blocks 
+   are done in cache; the first stage reads a[] and writes t[], 
+   and each 2^a block in t[] is transformed by cftpsub and stored 
+   with the stride m at its digit reversed place in a[]
+*/
+void cftrecm(struct fft_plan *p, int k, int l, int m, double *x, 
+    double *y, double *a, double *w)
+{
+    void cftpsub(struct fft_plan *p, double *a);
+    void cftmr3(int l, int isgn, double *a, double *b, double *w);
+    void cftmr5(int l, int isgn, double *a, double *b, double *w);
+    void cftmr7(int l, int isgn, double *a, double *b, double *w);
+    int j, r;
+    
+    if (k == p->nr) {
+        cftpsub(p, y);
+        m <<= 1;
+        for (j = 0; j < l; j++) {
+            a[(long) j * m] = y[2 * j];
+            a[(long) j * m + 1] = y[2 * j + 1];
+        }
+        return;
+    }
+    r = p->r[k];
+    l /= r;
+    if (r == 3) {
+        cftmr3(l, p->isgn, x, y, w);
+    } else if (r == 5) {
+        cftmr5(l, p->isgn, x, y, w);
+    } else {
+        cftmr7(l, p->isgn, x, y, w);
+    }
+    for (j = 0; j < r; j++) {
+        cftrecm(p, k + 1, l, m * r, y + 2 * j * l, y + 2 * j * l, 
+            a + 2 * m * j, w + 2 * (r - 1) * l);
+    }
+}
+
+
+void cftmr3(int l, int isgn, double *a, double *b, double *w)
+{
+    int j, j1, j2;
+    double s1, x0r, x0i, x1r, x1i, x2r, x2i, y1r, y1i, y2r, y2i;
+    
+    s1 = isgn >= 0 ? 0.866025403784438646763723170753 : 
+        -0.866025403784438646763723170753;
+    for (j = 0; j < 2 * l; j += 2) {
+        j1 = j + 2 * l;
+        j2 = j1 + 2 * l;
+        x1r = a[j1] + a[j2];
+        x1i = a[j1 + 1] + a[j2 + 1];
+        x0r = a[j] - 0.5 * x1r;
+        x0i = a[j + 1] - 0.5 * x1i;
+        x2r = s1 * (a[j1] - a[j2]);
+        x2i = s1 * (a[j1 + 1] - a[j2 + 1]);
+        b[j] = a[j] + x1r;
+        b[j + 1] = a[j + 1] + x1i;
+        y1r = x0r - x2i;
+        y1i = x0i + x2r;
+        y2r = x0r + x2i;
+        y2i = x0i - x2r;
+        b[j1] = w[0] * y1r - w[1] * y1i;
+        b[j1 + 1] = w[0] * y1i + w[1] * y1r;
+        b[j2] = w[2] * y2r - w[3] * y2i;
+        b[j2 + 1] = w[2] * y2i + w[3] * y2r;
+        w += 4;
+    }
+}
+
+
+void cftmr5(int l, int isgn, double *a, double *b, double *w)
+{
+    int j, j1, j2, j3, j4;
+    double c1, c2, s1, s2, x0r, x0i, 
+        a1r, a1i, a2r, a2i, b1r, b1i, b2r, b2i, 
+        t1r, t1i, t2r, t2i, u1r, u1i, u2r, u2i, yr, yi;
+    
+    c1 = 0.309016994374947424102293417183;
+    c2 = -0.809016994374947424102293417183;
+    s1 = 0.951056516295153572116439333379;
+    s2 = 0.587785252292473129168705954639;
+    if (isgn < 0) {
+        s1 = -s1;
+        s2 = -s2;
+    }
+    for (j = 0; j < 2 * l; j += 2) {
+        j1 = j + 2 * l;
+        j2 = j1 + 2 * l;
+        j3 = j2 + 2 * l;
+        j4 = j3 + 2 * l;
+        x0r = a[j];
+        x0i = a[j + 1];
+        a1r = a[j1] + a[j4];
+        a1i = a[j1 + 1] + a[j4 + 1];
+        b1r = a[j1] - a[j4];
+        b1i = a[j1 + 1] - a[j4 + 1];
+        a2r = a[j2] + a[j3];
+        a2i = a[j2 + 1] + a[j3 + 1];
+        b2r = a[j2] - a[j3];
+        b2i = a[j2 + 1] - a[j3 + 1];
+        b[j] = x0r + a1r + a2r;
+        b[j + 1] = x0i + a1i + a2i;
+        t1r = x0r + c1 * a1r + c2 * a2r;
+        t1i = x0i + c1 * a1i + c2 * a2i;
+        t2r = x0r + c2 * a1r + c1 * a2r;
+        t2i = x0i + c2 * a1i + c1 * a2i;
+        u1r = s1 * b1r + s2 * b2r;
+        u1i = s1 * b1i + s2 * b2i;
+        u2r = s2 * b1r - s1 * b2r;
+        u2i = s2 * b1i - s1 * b2i;
+        yr = t1r - u1i;
+        yi = t1i + u1r;
+        b[j1] = w[0] * yr - w[1] * yi;
+        b[j1 + 1] = w[0] * yi + w[1] * yr;
+        yr = t2r - u2i;
+        yi = t2i + u2r;
+        b[j2] = w[2] * yr - w[3] * yi;
+        b[j2 + 1] = w[2] * yi + w[3] * yr;
+        yr = t2r + u2i;
+        yi = t2i - u2r;
+        b[j3] = w[4] * yr - w[5] * yi;
+        b[j3 + 1] = w[4] * yi + w[5] * yr;
+        yr = t1r + u1i;
+        yi = t1i - u1r;
+        b[j4] = w[6] * yr - w[7] * yi;
+        b[j4 + 1] = w[6] * yi + w[7] * yr;
+        w += 8;
+    }
+}
+
+
+void cftmr7(int l, int isgn, double *a, double *b, double *w)
+{
+    int j, j1, j2, j3, j4, j5, j6;
+    double c1, c2, c3, s1, s2, s3, x0r, x0i, 
+        a1r, a1i, a2r, a2i, a3r, a3i, b1r, b1i, b2r, b2i, b3r, b3i, 
+        t1r, t1i, t2r, t2i, t3r, t3i, u1r, u1i, u2r, u2i, u3r, u3i, 
+        yr, yi;
+    
+    c1 = 0.623489801858733530525004884004;
+    c2 = -0.222520933956314404288902564497;
+    c3 = -0.900968867902419126236102319507;
+    s1 = 0.781831482468029808708444526674;
+    s2 = 0.974927912181823607018131682994;
+    s3 = 0.433883739117558120475768332849;
+    if (isgn < 0) {
+        s1 = -s1;
+        s2 = -s2;
+        s3 = -s3;
+    }
+    for (j = 0; j < 2 * l; j += 2) {
+        j1 = j + 2 * l;
+        j2 = j1 + 2 * l;
+        j3 = j2 + 2 * l;
+        j4 = j3 + 2 * l;
+        j5 = j4 + 2 * l;
+        j6 = j5 + 2 * l;
+        x0r = a[j];
+        x0i = a[j + 1];
+        a1r = a[j1] + a[j6];
+        a1i = a[j1 + 1] + a[j6 + 1];
+        b1r = a[j1] - a[j6];
+        b1i = a[j1 + 1] - a[j6 + 1];
+        a2r = a[j2] + a[j5];
+        a2i = a[j2 + 1] + a[j5 + 1];
+        b2r = a[j2] - a[j5];
+        b2i = a[j2 + 1] - a[j5 + 1];
+        a3r = a[j3] + a[j4];
+        a3i = a[j3 + 1] + a[j4 + 1];
+        b3r = a[j3] - a[j4];
+        b3i = a[j3 + 1] - a[j4 + 1];
+        b[j] = x0r + a1r + a2r + a3r;
+        b[j + 1] = x0i + a1i + a2i + a3i;
+        t1r = x0r + c1 * a1r + c2 * a2r + c3 * a3r;
+        t1i = x0i + c1 * a1i + c2 * a2i + c3 * a3i;
+        t2r = x0r + c2 * a1r + c3 * a2r + c1 * a3r;
+        t2i = x0i + c2 * a1i + c3 * a2i + c1 * a3i;
+        t3r = x0r + c3 * a1r + c1 * a2r + c2 * a3r;
+        t3i = x0i + c3 * a1i + c1 * a2i + c2 * a3i;
+        u1r = s1 * b1r + s2 * b2r + s3 * b3r;
+        u1i = s1 * b1i + s2 * b2i + s3 * b3i;
+        u2r = s2 * b1r - s3 * b2r - s1 * b3r;
+        u2i = s2 * b1i - s3 * b2i - s1 * b3i;
+        u3r = s3 * b1r - s1 * b2r + s2 * b3r;
+        u3i = s3 * b1i - s1 * b2i + s2 * b3i;
+        yr = t1r - u1i;
+        yi = t1i + u1r;
+        b[j1] = w[0] * yr - w[1] * yi;
+        b[j1 + 1] = w[0] * yi + w[1] * yr;
+        yr = t2r - u2i;
+        yi = t2i + u2r;
+        b[j2] = w[2] * yr - w[3] * yi;
+        b[j2 + 1] = w[2] * yi + w[3] * yr;
+        yr = t3r - u3i;
+        yi = t3i + u3r;
+        b[j3] = w[4] * yr - w[5] * yi;
+        b[j3 + 1] = w[4] * yi + w[5] * yr;
+        yr = t3r + u3i;
+        yi = t3i - u3r;
+        b[j4] = w[6] * yr - w[7] * yi;
+        b[j4 + 1] = w[6] * yi + w[7] * yr;
+        yr = t2r + u2i;
+        yi = t2i - u2r;
+        b[j5] = w[8] * yr - w[9] * yi;
+        b[j5 + 1] = w[8] * yi + w[9] * yr;
+        yr = t1r + u1i;
+        yi = t1i - u1r;
+        b[j6] = w[10] * yr - w[11] * yi;
+        b[j6 + 1] = w[10] * yi + w[11] * yr;
+        w += 12;
+    }
+}
+
+
+void rftfsubm(int n, double *a, double *c)
+{
+    int j, k, m;
+    double wkr, wki, xr, xi, yr, yi;
+    
+    m = n >> 1;
+    for (j = 2; j < m; j += 2) {
+        k = n - j;
+        wkr = c[j];
+        wki = c[j + 1];
+        xr = a[j] - a[k];
+        xi = a[j + 1] + a[k + 1];
+        yr = wkr * xr - wki * xi;
+        yi = wkr * xi + wki * xr;
+        a[j] -= yr;
+        a[j + 1] -= yi;
+        a[k] += yr;
+        a[k + 1] -= yi;
+    }
+}
+
+
+void rftbsubm(int n, double *a, double *c)
+{
+    int j, k, m;
+    double wkr, wki, xr, xi, yr, yi;
+    
+    m = n >> 1;
+    for (j = 2; j < m; j += 2) {
+        k = n - j;
+        wkr = c[j];
+        wki = c[j + 1];
+        xr = a[j] - a[k];
+        xi = a[j + 1] + a[k + 1];
+        yr = wkr * xr + wki * xi;
+        yi = wkr * xi - wki * xr;
+        a[j] -= yr;
+        a[j + 1] -= yi;
+        a[k] += yr;
+        a[k + 1] -= yi;
+    }
+}
+
+
+
+/* -------- thread settings -------- */
+
+#include <limits.h>
+#ifdef USE_CDFT_PTHREADS
+#include <time.h>
+#endif /* USE_CDFT_PTHREADS */
+
+
+void cdft_threads_set(int begin_n, int begin4_n, int max_threads)
+{
+#ifdef USE_CDFT_THREADS
+    void cdft_threads_init(void);
+    
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+    cdft_mutex_lock(&cdft_pool_mutex);
+    if (begin_n > 0) {
+        cdft_threads_begin_n = begin_n;
+    }
+    if (begin4_n > 0) {
+        cdft_4threads_begin_n = begin4_n;
+    }
+    if (max_threads >= 0) {
+        cdft_max_threads = max_threads;
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+#endif /* USE_CDFT_THREADS */
+}
+
+
+void cdft_threads_get(int *begin_n, int *begin4_n, int *max_threads)
+{
+#ifdef USE_CDFT_THREADS
+    void cdft_threads_init(void);
+    int cdft_ncpu(void);
+    
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+    cdft_mutex_lock(&cdft_pool_mutex);
+    *begin_n = cdft_threads_begin_n;
+    *begin4_n = cdft_4threads_begin_n;
+    *max_threads = cdft_max_threads;
+    if (*max_threads <= 0) {
+        *max_threads = cdft_ncpu();
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+#else
+    *begin_n = INT_MAX;
+    *begin4_n = INT_MAX;
+    *max_threads = 1;
+#endif /* USE_CDFT_THREADS */
+}
+
+
+void cdft_threads_calibrate(void)
+{
+#ifdef USE_CDFT_THREADS
+    void cdft(int n, int isgn, double *a, int *ip, double *w);
+    void cdft_threads_get(int *begin_n, int *begin4_n, int *max_threads);
+    void cdft_threads_set(int begin_n, int begin4_n, int max_threads);
+    double cdft_threads_time(int n, double *a, int *ip, double *w);
+    int n, nmax, begin_n, begin4_n, max_threads, *ip;
+    double *a, *w, t1, t2;
+    
+    cdft_threads_get(&begin_n, &begin4_n, &max_threads);
+    if (max_threads < 2) {
+        return;
+    }
+    nmax = 1 << 21;
+    a = (double *) calloc(nmax, sizeof(double));
+    w = (double *) malloc(sizeof(double) * (nmax >> 1));
+    ip = (int *) malloc(sizeof(int) * (2 + (1 << 10)));
+    if (a == NULL || w == NULL || ip == NULL) {
+        free(a);
+        free(w);
+        free(ip);
+        return;
+    }
+    ip[0] = 0;
+    cdft(nmax, 1, a, ip, w);
+    /* 2 threads against 1, from the largest n down */
+    begin_n = INT_MAX;
+    for (n = nmax; n > 1024; n >>= 1) {
+        cdft_threads_set(INT_MAX, INT_MAX, -1);
+        t1 = cdft_threads_time(n, a, ip, w);
+        cdft_threads_set(512, INT_MAX, -1);
+        t2 = cdft_threads_time(n, a, ip, w);
+        if (t2 >= t1) {
+            break;
+        }
+        begin_n = n >> 1;
+    }
+    /* 4 (and more) threads against 2 */
+    begin4_n = INT_MAX;
+    for (n = nmax; n > 1024 && (n >> 1) >= begin_n; n >>= 1) {
+        cdft_threads_set(512, INT_MAX, -1);
+        t1 = cdft_threads_time(n, a, ip, w);
+        cdft_threads_set(512, 512, -1);
+        t2 = cdft_threads_time(n, a, ip, w);
+        if (t2 >= t1) {
+            break;
+        }
+        begin4_n = n >> 1;
+    }
+    cdft_threads_set(begin_n, begin4_n, -1);
+    free(ip);
+    free(w);
+    free(a);
+#endif /* USE_CDFT_THREADS */
+}
+
+
+void cdft_threads_for(int n, int m, int nitem, int nwk, double *t, 
+    void (*func)(void *arg, int k0, int k1, double *t), void *arg)
+{
+#ifdef USE_CDFT_THREADS
+    int cdft_threads_n(int n);
+    int cdft_pool_open(int *nthread);
+    void cdft_pool_close(int id, cdft_job_t *job);
+    int cdft_pool_push(int id, cdft_task_t *tk);
+    void cdft_loop_task(int id, cdft_task_t *tk);
+    int i, id, nthread, ntask;
+    void *mem;
+    double *wk;
+    cdft_job_t job;
+    cdft_task_t tk;
+    
+    nthread = cdft_threads_n((long) n * m * nitem < (1 << 30) ? 
+        n * m * nitem : 1 << 30);
+    if (nitem < 2 || nthread < 2 || n > cdft_threads_begin_n) {
+        (*func)(arg, 0, nitem, t);
+        return;
+    }
+    ntask = nthread << 1;
+    if (ntask > CDFT_DEQUE_SIZE) {
+        ntask = CDFT_DEQUE_SIZE;
+    }
+    if (ntask > nitem) {
+        ntask = nitem;
+    }
+    /* the first range uses t, the others a work area of their own */
+    nwk = (nwk + 7) & ~7;
+    mem = NULL;
+    wk = NULL;
+    if (nwk > 0) {
+        mem = malloc(sizeof(double) * nwk * (ntask - 1) + 64);
+        if (mem == NULL) {
+            (*func)(arg, 0, nitem, t);
+            return;
+        }
+        wk = (double *) (((size_t) mem + 63) & ~((size_t) 63));
+    }
+    id = cdft_pool_open(&nthread);
+    if (id < 0) {
+        (*func)(arg, 0, nitem, t);
+        free(mem);
+        return;
+    }
+    job.loop = func;
+    job.arg = arg;
+    job.nthread = nthread;
+    job.pending = 0;
+    tk.func = cdft_loop_task;
+    tk.job = &job;
+    cdft_mutex_lock(&cdft_pool_mutex);
+    for (i = ntask - 1; i >= 0; i--) {
+        tk.k0 = (int) ((long) nitem * i / ntask);
+        tk.k1 = (int) ((long) nitem * (i + 1) / ntask);
+        tk.b = i == 0 || wk == NULL ? t : wk + (long) nwk * (i - 1);
+        if (i > 0 && cdft_pool_push(id, &tk) != 0) {
+            if (++job.pending < nthread) {
+                cdft_cond_signal(&cdft_pool_work);
+            }
+        } else {
+            cdft_mutex_unlock(&cdft_pool_mutex);
+            cdft_loop_task(id, &tk);
+            cdft_mutex_lock(&cdft_pool_mutex);
+        }
+    }
+    cdft_mutex_unlock(&cdft_pool_mutex);
+    cdft_pool_close(id, &job);
+    free(mem);
+#else
+    (*func)(arg, 0, nitem, t);
+#endif /* USE_CDFT_THREADS */
+}
+
+
+#ifdef USE_CDFT_THREADS
+void cdft_threads_init(void)
+{
+    char *s;
+    
+    /* ---- run by cdft_once: the settings are seen by all 
+            threads that pass cdft_threads_once ---- */
+    s = getenv("CDFT_THREADS_BEGIN_N");
+    if (s != NULL && atoi(s) > 0) {
+        cdft_threads_begin_n = atoi(s);
+    }
+    s = getenv("CDFT_4THREADS_BEGIN_N");
+    if (s != NULL && atoi(s) > 0) {
+        cdft_4threads_begin_n = atoi(s);
+    }
+    s = getenv("CDFT_MAX_THREADS");
+    if (s != NULL && atoi(s) > 0) {
+        cdft_max_threads = atoi(s);
+    }
+}
+
+
+double cdft_threads_time(int n, double *a, int *ip, double *w)
+{
+    void cdft(int n, int isgn, double *a, int *ip, double *w);
+    double cdft_wtime(void);
+    int i, j, nrep;
+    double t, tmin;
+    
+    nrep = (1 << 19) / n;
+    if (nrep < 1) {
+        nrep = 1;
+    }
+    tmin = 0;
+    for (i = 0; i < 3; i++) {
+        t = cdft_wtime();
+        for (j = 0; j < nrep; j++) {
+            cdft(n, 1, a, ip, w);
+        }
+        t = cdft_wtime() - t;
+        if (i == 0 || t < tmin) {
+            tmin = t;
+        }
+    }
+    return tmin;
+}
+
+
+double cdft_wtime(void)
+{
+#ifdef USE_CDFT_WINTHREADS
+    LARGE_INTEGER c, f;
+    
+    QueryPerformanceCounter(&c);
+    QueryPerformanceFrequency(&f);
+    return (double) c.QuadPart / (double) f.QuadPart;
+#else
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+#endif /* USE_CDFT_WINTHREADS */
+}
+#endif /* USE_CDFT_THREADS */
+
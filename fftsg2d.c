@@ -0,0 +1,581 @@
+/*
+Fast Fourier/Cosine/Sine Transform
+    dimension   :two
+    data length :power of 2
+    decimation  :frequency
+    radix       :split-radix, row-column
+    data        :inplace
+    table       :use
+functions
+    cdft2d: Complex Discrete Fourier Transform
+    rdft2d: Real Discrete Fourier Transform
+    ddct2d: Discrete Cosine Transform
+    ddst2d: Discrete Sine Transform
+function prototypes
+    void cdft2d(int, int, int, double **, double *, int *, double *);
+    void rdft2d(int, int, int, double **, double *, int *, double *);
+    void ddct2d(int, int, int, double **, double *, int *, double *);
+    void ddst2d(int, int, int, double **, double *, int *, double *);
+necessary package
+    fftsg.c  : 1D-FFT package
+    (with USE_CDFT_PTHREADS or USE_CDFT_WINTHREADS in fftsg.c,
+    the rows and the column blocks are run by its worker threads)
+
+
+-------- Complex DFT (Discrete Fourier Transform) --------
+    [definition]
+        <case1>
+            X[k1][k2] = sum_j1=0^n1-1 sum_j2=0^n2-1 x[j1][j2] *
+                            exp(2*pi*i*j1*k1/n1) *
+                            exp(2*pi*i*j2*k2/n2), 0<=k1<n1, 0<=k2<n2
+        <case2>
+            X[k1][k2] = sum_j1=0^n1-1 sum_j2=0^n2-1 x[j1][j2] *
+                            exp(-2*pi*i*j1*k1/n1) *
+                            exp(-2*pi*i*j2*k2/n2), 0<=k1<n1, 0<=k2<n2
+        (notes: sum_j=0^n-1 is a summation from j=0 to n-1)
+    [usage]
+        <case1>
+            ip[0] = 0; // first time only
+            cdft2d(n1, 2*n2, 1, a, t, ip, w);
+        <case2>
+            ip[0] = 0; // first time only
+            cdft2d(n1, 2*n2, -1, a, t, ip, w);
+    [parameters]
+        n1             :data length (int)
+                        n1 >= 1, n1 = power of 2
+        2*n2           :data length (int)
+                        n2 >= 1, n2 = power of 2
+        a[0...n1-1][0...2*n2-1]
+                       :input/output data (double **)
+                        input data
+                            a[j1][2*j2] = Re(x[j1][j2]),
+                            a[j1][2*j2+1] = Im(x[j1][j2]),
+                            0<=j1<n1, 0<=j2<n2
+                        output data
+                            a[k1][2*k2] = Re(X[k1][k2]),
+                            a[k1][2*k2+1] = Im(X[k1][k2]),
+                            0<=k1<n1, 0<=k2<n2
+        t[0...8*n1-1]  :work area (double *)
+        ip[0...*]      :work area for bit reversal (int *)
+                        length of ip >= 2+sqrt(n)
+                        (n = max(n1, n2))
+                        ip[0],ip[1] are pointers of the cos/sin table.
+        w[0...*]       :cos/sin table (double *)
+                        length of w >= max(n1/2, n2/2)
+                        w[],ip[] are initialized if ip[0] == 0.
+    [remark]
+        Inverse of
+            cdft2d(n1, 2*n2, -1, a, t, ip, w);
+        is
+            cdft2d(n1, 2*n2, 1, a, t, ip, w);
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                for (j2 = 0; j2 <= 2 * n2 - 1; j2++) {
+                    a[j1][j2] *= 1.0 / n1 / n2;
+                }
+            }
+        .
+        The columns are transformed in blocks of 4 (8 doubles
+        of each row), copied to t[] with one pass over the rows.
+
+
+-------- Real DFT / Inverse of Real DFT --------
+    [definition]
+        <case1> RDFT
+            R[k1][k2] = sum_j1=0^n1-1 sum_j2=0^n2-1 a[j1][j2] *
+                            cos(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2),
+                            0<=k1<n1, 0<=k2<n2
+            I[k1][k2] = sum_j1=0^n1-1 sum_j2=0^n2-1 a[j1][j2] *
+                            sin(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2),
+                            0<=k1<n1, 0<=k2<n2
+        <case2> IRDFT (excluding scale)
+            a[k1][k2] = (1/2) * sum_j1=0^n1-1 sum_j2=0^n2-1
+                            (R[j1][j2] *
+                            cos(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2) +
+                            I[j1][j2] *
+                            sin(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2)),
+                            0<=k1<n1, 0<=k2<n2
+        (notes: R[n1-k1][n2-k2] = R[k1][k2],
+                I[n1-k1][n2-k2] = -I[k1][k2],
+                R[n1-k1][0] = R[k1][0],
+                I[n1-k1][0] = -I[k1][0],
+                R[0][n2-k2] = R[0][k2],
+                I[0][n2-k2] = -I[0][k2],
+                0<k1<n1, 0<k2<n2)
+    [usage]
+        <case1>
+            ip[0] = 0; // first time only
+            rdft2d(n1, n2, 1, a, t, ip, w);
+        <case2>
+            ip[0] = 0; // first time only
+            rdft2d(n1, n2, -1, a, t, ip, w);
+    [parameters]
+        n1             :data length (int)
+                        n1 >= 2, n1 = power of 2
+        n2             :data length (int)
+                        n2 >= 2, n2 = power of 2
+        a[0...n1-1][0...n2-1]
+                       :input/output data (double **)
+                        <case1>
+                            output data
+                                a[k1][2*k2] = R[k1][k2],
+                                a[k1][2*k2+1] = I[k1][k2],
+                                    0<=k1<n1, 0<k2<n2/2,
+                                a[k1][0] = R[k1][0],
+                                a[k1][1] = I[k1][0],
+                                a[n1-k1][1] = R[k1][n2/2],
+                                a[n1-k1][0] = -I[k1][n2/2],
+                                    0<k1<n1/2,
+                                a[0][0] = R[0][0],
+                                a[0][1] = R[0][n2/2],
+                                a[n1/2][0] = R[n1/2][0],
+                                a[n1/2][1] = R[n1/2][n2/2]
+                        <case2>
+                            input data
+                                (the same as the output of case1)
+        t[0...8*n1-1]  :work area (double *)
+        ip[0...*]      :work area for bit reversal (int *)
+                        length of ip >= 2+sqrt(n)
+                        (n = max(n1, n2/2))
+                        ip[0],ip[1] are pointers of the cos/sin table.
+        w[0...*]       :cos/sin table (double *)
+                        length of w >= max(n1/2, n2/4) + n2/4
+                        w[],ip[] are initialized if ip[0] == 0.
+    [remark]
+        Inverse of
+            rdft2d(n1, n2, 1, a, t, ip, w);
+        is
+            rdft2d(n1, n2, -1, a, t, ip, w);
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                for (j2 = 0; j2 <= n2 - 1; j2++) {
+                    a[j1][j2] *= 2.0 / n1 / n2;
+                }
+            }
+        .
+
+
+-------- DCT (Discrete Cosine Transform) / Inverse of DCT --------
+    [definition]
+        <case1> IDCT (excluding scale)
+            C[k1][k2] = sum_j1=0^n1-1 sum_j2=0^n2-1 a[j1][j2] *
+                            cos(pi*j1*(k1+1/2)/n1) *
+                            cos(pi*j2*(k2+1/2)/n2),
+                            0<=k1<n1, 0<=k2<n2
+        <case2> DCT
+            C[k1][k2] = sum_j1=0^n1-1 sum_j2=0^n2-1 a[j1][j2] *
+                            cos(pi*(j1+1/2)*k1/n1) *
+                            cos(pi*(j2+1/2)*k2/n2),
+                            0<=k1<n1, 0<=k2<n2
+    [usage]
+        <case1>
+            ip[0] = 0; // first time only
+            ddct2d(n1, n2, 1, a, t, ip, w);
+        <case2>
+            ip[0] = 0; // first time only
+            ddct2d(n1, n2, -1, a, t, ip, w);
+    [parameters]
+        n1             :data length (int)
+                        n1 >= 2, n1 = power of 2
+        n2             :data length (int)
+                        n2 >= 2, n2 = power of 2
+        a[0...n1-1][0...n2-1]
+                       :input/output data (double **)
+                        output data
+                            a[k1][k2] = C[k1][k2], 0<=k1<n1, 0<=k2<n2
+        t[0...8*n1-1]  :work area (double *)
+        ip[0...*]      :work area for bit reversal (int *)
+                        length of ip >= 2+sqrt(n/2)
+                        (n = max(n1, n2))
+                        ip[0],ip[1] are pointers of the cos/sin table.
+        w[0...*]       :cos/sin table (double *)
+                        length of w >= n*5/4
+                        w[],ip[] are initialized if ip[0] == 0.
+    [remark]
+        Inverse of
+            ddct2d(n1, n2, -1, a, t, ip, w);
+        is
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                a[j1][0] *= 0.5;
+            }
+            for (j2 = 0; j2 <= n2 - 1; j2++) {
+                a[0][j2] *= 0.5;
+            }
+            ddct2d(n1, n2, 1, a, t, ip, w);
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                for (j2 = 0; j2 <= n2 - 1; j2++) {
+                    a[j1][j2] *= 4.0 / n1 / n2;
+                }
+            }
+        .
+
+
+-------- DST (Discrete Sine Transform) / Inverse of DST --------
+    [definition]
+        <case1> IDST (excluding scale)
+            S[k1][k2] = sum_j1=1^n1 sum_j2=1^n2 A[j1][j2] *
+                            sin(pi*j1*(k1+1/2)/n1) *
+                            sin(pi*j2*(k2+1/2)/n2),
+                            0<=k1<n1, 0<=k2<n2
+        <case2> DST
+            S[k1][k2] = sum_j1=0^n1-1 sum_j2=0^n2-1 a[j1][j2] *
+                            sin(pi*(j1+1/2)*k1/n1) *
+                            sin(pi*(j2+1/2)*k2/n2),
+                            0<k1<=n1, 0<k2<=n2
+    [usage]
+        <case1>
+            ip[0] = 0; // first time only
+            ddst2d(n1, n2, 1, a, t, ip, w);
+        <case2>
+            ip[0] = 0; // first time only
+            ddst2d(n1, n2, -1, a, t, ip, w);
+    [parameters]
+        n1             :data length (int)
+                        n1 >= 2, n1 = power of 2
+        n2             :data length (int)
+                        n2 >= 2, n2 = power of 2
+        a[0...n1-1][0...n2-1]
+                       :input/output data (double **)
+                        <case1>
+                            input data
+                                a[j1][j2] = A[j1][j2],
+                                    0<j1<n1, 0<j2<n2,
+                                a[j1][0] = A[j1][n2], 0<j1<n1,
+                                a[0][j2] = A[n1][j2], 0<j2<n2,
+                                a[0][0] = A[n1][n2]
+                                (i.e. as in ddst on each axis)
+                            output data
+                                a[k1][k2] = S[k1][k2],
+                                    0<=k1<n1, 0<=k2<n2
+                        <case2>
+                            output data
+                                a[k1][k2] = S[k1][k2],
+                                    0<k1<n1, 0<k2<n2,
+                                a[k1][0] = S[k1][n2], 0<k1<n1,
+                                a[0][k2] = S[n1][k2], 0<k2<n2,
+                                a[0][0] = S[n1][n2]
+        t[0...8*n1-1]  :work area (double *)
+        ip[0...*]      :work area for bit reversal (int *)
+                        length of ip >= 2+sqrt(n/2)
+                        (n = max(n1, n2))
+                        ip[0],ip[1] are pointers of the cos/sin table.
+        w[0...*]       :cos/sin table (double *)
+                        length of w >= n*5/4
+                        w[],ip[] are initialized if ip[0] == 0.
+    [remark]
+        Inverse of
+            ddst2d(n1, n2, -1, a, t, ip, w);
+        is
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                a[j1][0] *= 0.5;
+            }
+            for (j2 = 0; j2 <= n2 - 1; j2++) {
+                a[0][j2] *= 0.5;
+            }
+            ddst2d(n1, n2, 1, a, t, ip, w);
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                for (j2 = 0; j2 <= n2 - 1; j2++) {
+                    a[j1][j2] *= 4.0 / n1 / n2;
+                }
+            }
+        .
+*/
+
+
+/* arguments of the row and column passes (cdft_threads_for) */
+struct fft2d_arg {
+    int n1, n2, isgn, nw;
+    double **a;
+    int *ip;
+    double *w;
+    void (*ddxt)(int n, int isgn, double *a, int *ip, double *w);
+};
+
+
+void cdft2d(int n1, int n2, int isgn, double **a, double *t,
+    int *ip, double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t,
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void cdft2d_rows(void *arg, int k0, int k1, double *t);
+    void cdft2d_cols(void *arg, int k0, int k1, double *t);
+    int n, nw;
+    struct fft2d_arg arg;
+
+    n = n1 << 1;
+    if (n < n2) {
+        n = n2;
+    }
+    nw = ip[0];
+    if (n > (nw << 2)) {
+        nw = n >> 2;
+        makewt(nw, ip, w);
+    }
+    arg.n1 = n1;
+    arg.n2 = n2;
+    arg.isgn = isgn;
+    arg.nw = nw;
+    arg.a = a;
+    arg.ip = ip;
+    arg.w = w;
+    cdft_threads_for(n2, 1, n1, 0, t, cdft2d_rows, &arg);
+    cdft_threads_for(2 * n1, 4, (n2 + 7) >> 3, 8 * n1, t, cdft2d_cols,
+        &arg);
+}
+
+
+void rdft2d(int n1, int n2, int isgn, double **a, double *t,
+    int *ip, double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    void makect(int nc, int *ip, double *c);
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t,
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void rdft2d_rows(void *arg, int k0, int k1, double *t);
+    void cdft2d_cols(void *arg, int k0, int k1, double *t);
+    void rdft2d_sub(int n1, int isgn, double **a);
+    int n, nw, nc;
+    struct fft2d_arg arg;
+
+    n = n1 << 1;
+    if (n < n2) {
+        n = n2;
+    }
+    nw = ip[0];
+    if (n > (nw << 2)) {
+        nw = n >> 2;
+        makewt(nw, ip, w);
+    }
+    nc = ip[1];
+    if (n2 > (nc << 2)) {
+        nc = n2 >> 2;
+        makect(nc, ip, w + nw);
+    }
+    arg.n1 = n1;
+    arg.n2 = n2;
+    arg.isgn = isgn;
+    arg.nw = nw;
+    arg.a = a;
+    arg.ip = ip;
+    arg.w = w;
+    if (isgn >= 0) {
+        cdft_threads_for(n2, 1, n1, 0, t, rdft2d_rows, &arg);
+        cdft_threads_for(2 * n1, 4, (n2 + 7) >> 3, 8 * n1, t,
+            cdft2d_cols, &arg);
+        rdft2d_sub(n1, isgn, a);
+    } else {
+        rdft2d_sub(n1, isgn, a);
+        cdft_threads_for(2 * n1, 4, (n2 + 7) >> 3, 8 * n1, t,
+            cdft2d_cols, &arg);
+        cdft_threads_for(n2, 1, n1, 0, t, rdft2d_rows, &arg);
+    }
+}
+
+
+void ddct2d(int n1, int n2, int isgn, double **a, double *t,
+    int *ip, double *w)
+{
+    void ddct(int n, int isgn, double *a, int *ip, double *w);
+    void ddxt2d(int n1, int n2, int isgn, double **a, double *t,
+        int *ip, double *w,
+        void (*ddxt)(int n, int isgn, double *a, int *ip, double *w));
+
+    ddxt2d(n1, n2, isgn, a, t, ip, w, ddct);
+}
+
+
+void ddst2d(int n1, int n2, int isgn, double **a, double *t,
+    int *ip, double *w)
+{
+    void ddst(int n, int isgn, double *a, int *ip, double *w);
+    void ddxt2d(int n1, int n2, int isgn, double **a, double *t,
+        int *ip, double *w,
+        void (*ddxt)(int n, int isgn, double *a, int *ip, double *w));
+
+    ddxt2d(n1, n2, isgn, a, t, ip, w, ddst);
+}
+
+
+/* -------- child routines -------- */
+
+
+void ddxt2d(int n1, int n2, int isgn, double **a, double *t,
+    int *ip, double *w,
+    void (*ddxt)(int n, int isgn, double *a, int *ip, double *w))
+{
+    void makewt(int nw, int *ip, double *w);
+    void makect(int nc, int *ip, double *c);
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t,
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void ddxt2d_rows(void *arg, int k0, int k1, double *t);
+    void ddxt2d_cols(void *arg, int k0, int k1, double *t);
+    int n, nw, nc;
+    struct fft2d_arg arg;
+
+    /* make the tables once: the passes only read them */
+    n = n1;
+    if (n < n2) {
+        n = n2;
+    }
+    nw = ip[0];
+    if (n > (nw << 2)) {
+        nw = n >> 2;
+        makewt(nw, ip, w);
+    }
+    nc = ip[1];
+    if (n > nc) {
+        nc = n;
+        makect(nc, ip, w + nw);
+    }
+    arg.n1 = n1;
+    arg.n2 = n2;
+    arg.isgn = isgn;
+    arg.nw = nw;
+    arg.a = a;
+    arg.ip = ip;
+    arg.w = w;
+    arg.ddxt = ddxt;
+    cdft_threads_for(n2, 1, n1, 0, t, ddxt2d_rows, &arg);
+    cdft_threads_for(n1, 8, (n2 + 7) >> 3, 8 * n1, t, ddxt2d_cols,
+        &arg);
+}
+
+
+void cdft2d_rows(void *arg, int k0, int k1, double *t)
+{
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    struct fft2d_arg *p = (struct fft2d_arg *) arg;
+    int i;
+
+    for (i = k0; i < k1; i++) {
+        if (p->isgn >= 0) {
+            cftfsub(p->n2, p->a[i], p->ip, p->nw, p->w);
+        } else {
+            cftbsub(p->n2, p->a[i], p->ip, p->nw, p->w);
+        }
+    }
+}
+
+
+void rdft2d_rows(void *arg, int k0, int k1, double *t)
+{
+    void rdft(int n, int isgn, double *a, int *ip, double *w);
+    struct fft2d_arg *p = (struct fft2d_arg *) arg;
+    int i;
+
+    for (i = k0; i < k1; i++) {
+        rdft(p->n2, p->isgn, p->a[i], p->ip, p->w);
+    }
+}
+
+
+void ddxt2d_rows(void *arg, int k0, int k1, double *t)
+{
+    struct fft2d_arg *p = (struct fft2d_arg *) arg;
+    int i;
+
+    for (i = k0; i < k1; i++) {
+        (*p->ddxt)(p->n2, p->isgn, p->a[i], p->ip, p->w);
+    }
+}
+
+
+/*
+   columns 8*k0...8*k1-1 (4 complex columns per block): one pass
+   over the rows copies a block to t[], so that a row is read
+   once per cache line and the column transforms run in t[]
+*/
+void cdft2d_cols(void *arg, int k0, int k1, double *t)
+{
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    struct fft2d_arg *p = (struct fft2d_arg *) arg;
+    int i, j, k, l, n1, nb;
+    double *x;
+
+    n1 = p->n1;
+    nb = p->n2 < 8 ? p->n2 : 8;
+    for (k = k0; k < k1; k++) {
+        j = 8 * k;
+        for (i = 0; i < n1; i++) {
+            x = &p->a[i][j];
+            for (l = 0; l < nb; l += 2) {
+                t[l * n1 + 2 * i] = x[l];
+                t[l * n1 + 2 * i + 1] = x[l + 1];
+            }
+        }
+        for (l = 0; l < nb; l += 2) {
+            if (p->isgn >= 0) {
+                cftfsub(2 * n1, &t[l * n1], p->ip, p->nw, p->w);
+            } else {
+                cftbsub(2 * n1, &t[l * n1], p->ip, p->nw, p->w);
+            }
+        }
+        for (i = 0; i < n1; i++) {
+            x = &p->a[i][j];
+            for (l = 0; l < nb; l += 2) {
+                x[l] = t[l * n1 + 2 * i];
+                x[l + 1] = t[l * n1 + 2 * i + 1];
+            }
+        }
+    }
+}
+
+
+void ddxt2d_cols(void *arg, int k0, int k1, double *t)
+{
+    struct fft2d_arg *p = (struct fft2d_arg *) arg;
+    int i, j, k, l, n1, nb;
+    double *x;
+
+    n1 = p->n1;
+    nb = p->n2 < 8 ? p->n2 : 8;
+    for (k = k0; k < k1; k++) {
+        j = 8 * k;
+        for (i = 0; i < n1; i++) {
+            x = &p->a[i][j];
+            for (l = 0; l < nb; l++) {
+                t[l * n1 + i] = x[l];
+            }
+        }
+        for (l = 0; l < nb; l++) {
+            (*p->ddxt)(n1, p->isgn, &t[l * n1], p->ip, p->w);
+        }
+        for (i = 0; i < n1; i++) {
+            x = &p->a[i][j];
+            for (l = 0; l < nb; l++) {
+                x[l] = t[l * n1 + i];
+            }
+        }
+    }
+}
+
+
+void rdft2d_sub(int n1, int isgn, double **a)
+{
+    int i, j;
+    double xi, *x, *y;
+
+    if (isgn < 0) {
+        for (i = 1, j = n1 - 1; i < j; i++, j--) {
+            x = a[i];
+            y = a[j];
+            xi = x[0] - y[0];
+            x[0] += y[0];
+            y[0] = xi;
+            xi = y[1] - x[1];
+            x[1] += y[1];
+            y[1] = xi;
+        }
+    } else {
+        for (i = 1, j = n1 - 1; i < j; i++, j--) {
+            x = a[i];
+            y = a[j];
+            y[0] = 0.5 * (x[0] - y[0]);
+            x[0] -= y[0];
+            y[1] = 0.5 * (x[1] + y[1]);
+            x[1] -= y[1];
+        }
+    }
+}
+
@@ -0,0 +1,410 @@
+/*
+Fast Fourier/Cosine/Sine Transform
+    dimension   :three
+    data length :power of 2
+    decimation  :frequency
+    radix       :split-radix, row-column
+    data        :inplace
+    table       :use
+functions
+    cdft3d: Complex Discrete Fourier Transform
+    rdft3d: Real Discrete Fourier Transform
+function prototypes
+    void cdft3d(int, int, int, int, double ***, double *, int *, double *);
+    void rdft3d(int, int, int, int, double ***, double *, int *, double *);
+necessary package
+    fftsg.c  : 1D-FFT package
+    (with USE_CDFT_PTHREADS or USE_CDFT_WINTHREADS in fftsg.c,
+    the planes and the column blocks are run by its worker threads)
+
+
+-------- Complex DFT (Discrete Fourier Transform) --------
+    [definition]
+        <case1>
+            X[k1][k2][k3] = sum_j1=0^n1-1 sum_j2=0^n2-1 sum_j3=0^n3-1
+                                x[j1][j2][j3] *
+                                exp(2*pi*i*j1*k1/n1) *
+                                exp(2*pi*i*j2*k2/n2) *
+                                exp(2*pi*i*j3*k3/n3),
+                                0<=k1<n1, 0<=k2<n2, 0<=k3<n3
+        <case2>
+            X[k1][k2][k3] = sum_j1=0^n1-1 sum_j2=0^n2-1 sum_j3=0^n3-1
+                                x[j1][j2][j3] *
+                                exp(-2*pi*i*j1*k1/n1) *
+                                exp(-2*pi*i*j2*k2/n2) *
+                                exp(-2*pi*i*j3*k3/n3),
+                                0<=k1<n1, 0<=k2<n2, 0<=k3<n3
+        (notes: sum_j=0^n-1 is a summation from j=0 to n-1)
+    [usage]
+        <case1>
+            ip[0] = 0; // first time only
+            cdft3d(n1, n2, 2*n3, 1, a, t, ip, w);
+        <case2>
+            ip[0] = 0; // first time only
+            cdft3d(n1, n2, 2*n3, -1, a, t, ip, w);
+    [parameters]
+        n1             :data length (int)
+                        n1 >= 1, n1 = power of 2
+        n2             :data length (int)
+                        n2 >= 1, n2 = power of 2
+        2*n3           :data length (int)
+                        n3 >= 1, n3 = power of 2
+        a[0...n1-1][0...n2-1][0...2*n3-1]
+                       :input/output data (double ***)
+                        input data
+                            a[j1][j2][2*j3] = Re(x[j1][j2][j3]),
+                            a[j1][j2][2*j3+1] = Im(x[j1][j2][j3]),
+                            0<=j1<n1, 0<=j2<n2, 0<=j3<n3
+                        output data
+                            a[k1][k2][2*k3] = Re(X[k1][k2][k3]),
+                            a[k1][k2][2*k3+1] = Im(X[k1][k2][k3]),
+                            0<=k1<n1, 0<=k2<n2, 0<=k3<n3
+        t[0...*]       :work area (double *)
+                        length of t >= 8*max(n1, n2)
+        ip[0...*]      :work area for bit reversal (int *)
+                        length of ip >= 2+sqrt(n)
+                        (n = max(n1, n2, n3))
+                        ip[0],ip[1] are pointers of the cos/sin table.
+        w[0...*]       :cos/sin table (double *)
+                        length of w >= max(n1/2, n2/2, n3/2)
+                        w[],ip[] are initialized if ip[0] == 0.
+    [remark]
+        Inverse of
+            cdft3d(n1, n2, 2*n3, -1, a, t, ip, w);
+        is
+            cdft3d(n1, n2, 2*n3, 1, a, t, ip, w);
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                for (j2 = 0; j2 <= n2 - 1; j2++) {
+                    for (j3 = 0; j3 <= 2 * n3 - 1; j3++) {
+                        a[j1][j2][j3] *= 1.0 / n1 / n2 / n3;
+                    }
+                }
+            }
+        .
+        Each plane a[j1] is transformed as in cdft2d, then the
+        columns along j1 in blocks of 4 (8 doubles of each row).
+
+
+-------- Real DFT / Inverse of Real DFT --------
+    [definition]
+        <case1> RDFT
+            R[k1][k2][k3] = sum_j1=0^n1-1 sum_j2=0^n2-1 sum_j3=0^n3-1
+                                a[j1][j2][j3] *
+                                cos(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2 +
+                                2*pi*j3*k3/n3),
+                                0<=k1<n1, 0<=k2<n2, 0<=k3<n3
+            I[k1][k2][k3] = sum_j1=0^n1-1 sum_j2=0^n2-1 sum_j3=0^n3-1
+                                a[j1][j2][j3] *
+                                sin(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2 +
+                                2*pi*j3*k3/n3),
+                                0<=k1<n1, 0<=k2<n2, 0<=k3<n3
+        <case2> IRDFT (excluding scale)
+            a[k1][k2][k3] = (1/2) * sum_j1=0^n1-1 sum_j2=0^n2-1
+                                sum_j3=0^n3-1
+                                (R[j1][j2][j3] *
+                                cos(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2 +
+                                2*pi*j3*k3/n3) +
+                                I[j1][j2][j3] *
+                                sin(2*pi*j1*k1/n1 + 2*pi*j2*k2/n2 +
+                                2*pi*j3*k3/n3)),
+                                0<=k1<n1, 0<=k2<n2, 0<=k3<n3
+        (notes: R[n1-k1][n2-k2][n3-k3] = R[k1][k2][k3],
+                I[n1-k1][n2-k2][n3-k3] = -I[k1][k2][k3],
+                the indexes are taken modulo n1, n2, n3)
+    [usage]
+        <case1>
+            ip[0] = 0; // first time only
+            rdft3d(n1, n2, n3, 1, a, t, ip, w);
+        <case2>
+            ip[0] = 0; // first time only
+            rdft3d(n1, n2, n3, -1, a, t, ip, w);
+    [parameters]
+        n1             :data length (int)
+                        n1 >= 1, n1 = power of 2
+        n2             :data length (int)
+                        n2 >= 1, n2 = power of 2
+        n3             :data length (int)
+                        n3 >= 2, n3 = power of 2
+        a[0...n1-1][0...n2-1][0...n3-1]
+                       :input/output data (double ***)
+                        <case1>
+                            output data
+                                a[k1][k2][2*k3] = R[k1][k2][k3],
+                                a[k1][k2][2*k3+1] = I[k1][k2][k3],
+                                    0<=k1<n1, 0<=k2<n2, 0<k3<n3/2,
+                                and with (j1, j2) =
+                                (n1-k1 mod n1, n2-k2 mod n2)
+                                a[k1][k2][0] = R[k1][k2][0],
+                                a[k1][k2][1] = I[k1][k2][0],
+                                a[j1][j2][1] = R[k1][k2][n3/2],
+                                a[j1][j2][0] = -I[k1][k2][n3/2],
+                                    k1 < j1, or k1 == j1 and k2 < j2,
+                                a[k1][k2][0] = R[k1][k2][0],
+                                a[k1][k2][1] = R[k1][k2][n3/2],
+                                    k1 == j1 and k2 == j2
+                        <case2>
+                            input data
+                                (the same as the output of case1)
+        t[0...*]       :work area (double *)
+                        length of t >= 8*max(n1, n2)
+        ip[0...*]      :work area for bit reversal (int *)
+                        length of ip >= 2+sqrt(n)
+                        (n = max(n1, n2, n3/2))
+                        ip[0],ip[1] are pointers of the cos/sin table.
+        w[0...*]       :cos/sin table (double *)
+                        length of w >= max(n1/2, n2/2, n3/4) + n3/4
+                        w[],ip[] are initialized if ip[0] == 0.
+    [remark]
+        Inverse of
+            rdft3d(n1, n2, n3, 1, a, t, ip, w);
+        is
+            rdft3d(n1, n2, n3, -1, a, t, ip, w);
+            for (j1 = 0; j1 <= n1 - 1; j1++) {
+                for (j2 = 0; j2 <= n2 - 1; j2++) {
+                    for (j3 = 0; j3 <= n3 - 1; j3++) {
+                        a[j1][j2][j3] *= 2.0 / n1 / n2 / n3;
+                    }
+                }
+            }
+        .
+        For n2 == 1, the output is that of rdft2d(n1, n3, ...).
+*/
+
+
+/* arguments of the plane and column passes (cdft_threads_for) */
+struct fft3d_arg {
+    int n1, n2, n3, isgn, nw, real;
+    double ***a;
+    int *ip;
+    double *w;
+};
+
+
+void cdft3d(int n1, int n2, int n3, int isgn, double ***a, double *t,
+    int *ip, double *w)
+{
+    void xdft3d(int n1, int n2, int n3, int isgn, int real, double ***a,
+        double *t, int *ip, double *w);
+
+    xdft3d(n1, n2, n3, isgn, 0, a, t, ip, w);
+}
+
+
+void rdft3d(int n1, int n2, int n3, int isgn, double ***a, double *t,
+    int *ip, double *w)
+{
+    void xdft3d(int n1, int n2, int n3, int isgn, int real, double ***a,
+        double *t, int *ip, double *w);
+
+    xdft3d(n1, n2, n3, isgn, 1, a, t, ip, w);
+}
+
+
+/* -------- child routines -------- */
+
+
+void xdft3d(int n1, int n2, int n3, int isgn, int real, double ***a,
+    double *t, int *ip, double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    void makect(int nc, int *ip, double *c);
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t,
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void xdft3d_planes(void *arg, int k0, int k1, double *t);
+    void cdft3d_cols(void *arg, int k0, int k1, double *t);
+    void rdft3d_sub(int n1, int n2, int isgn, double ***a);
+    int n, nw, nc, nb;
+    struct fft3d_arg arg;
+
+    n = n1 > n2 ? n1 : n2;
+    n <<= 1;
+    if (n < n3) {
+        n = n3;
+    }
+    nw = ip[0];
+    if (n > (nw << 2)) {
+        nw = n >> 2;
+        makewt(nw, ip, w);
+    }
+    if (real) {
+        nc = ip[1];
+        if (n3 > (nc << 2)) {
+            nc = n3 >> 2;
+            makect(nc, ip, w + nw);
+        }
+    }
+    arg.n1 = n1;
+    arg.n2 = n2;
+    arg.n3 = n3;
+    arg.isgn = isgn;
+    arg.nw = nw;
+    arg.real = real;
+    arg.a = a;
+    arg.ip = ip;
+    arg.w = w;
+    /* a plane: n2 rows of n3 and n3/2 columns of 2*n2 */
+    n = n3 > 2 * n2 ? n3 : 2 * n2;
+    nb = (n3 + 7) >> 3;
+    if (real && isgn < 0) {
+        rdft3d_sub(n1, n2, isgn, a);
+        cdft_threads_for(2 * n1, 4, n2 * nb, 8 * n1, t, cdft3d_cols,
+            &arg);
+    }
+    cdft_threads_for(n, 2 * n2 * n3 / n, n1, 8 * n2, t, xdft3d_planes,
+        &arg);
+    if (!real || isgn >= 0) {
+        cdft_threads_for(2 * n1, 4, n2 * nb, 8 * n1, t, cdft3d_cols,
+            &arg);
+    }
+    if (real && isgn >= 0) {
+        rdft3d_sub(n1, n2, isgn, a);
+    }
+}
+
+
+void xdft3d_planes(void *arg, int k0, int k1, double *t)
+{
+    void rdft(int n, int isgn, double *a, int *ip, double *w);
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    void cdft3d_plane_cols(struct fft3d_arg *p, double **b, double *t);
+    struct fft3d_arg *p = (struct fft3d_arg *) arg;
+    int i, j;
+
+    for (i = k0; i < k1; i++) {
+        if (p->real && p->isgn < 0) {
+            cdft3d_plane_cols(p, p->a[i], t);
+        }
+        for (j = 0; j < p->n2; j++) {
+            if (p->real) {
+                rdft(p->n3, p->isgn, p->a[i][j], p->ip, p->w);
+            } else if (p->isgn >= 0) {
+                cftfsub(p->n3, p->a[i][j], p->ip, p->nw, p->w);
+            } else {
+                cftbsub(p->n3, p->a[i][j], p->ip, p->nw, p->w);
+            }
+        }
+        if (!p->real || p->isgn >= 0) {
+            cdft3d_plane_cols(p, p->a[i], t);
+        }
+    }
+}
+
+
+/*
+   the columns along j2 of the plane b, in blocks of 4 complex
+   columns through t[] (as in cdft2d)
+*/
+void cdft3d_plane_cols(struct fft3d_arg *p, double **b, double *t)
+{
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    int i, j, l, n2, nb;
+    double *x;
+
+    n2 = p->n2;
+    nb = p->n3 < 8 ? p->n3 : 8;
+    for (j = 0; j < p->n3; j += 8) {
+        for (i = 0; i < n2; i++) {
+            x = &b[i][j];
+            for (l = 0; l < nb; l += 2) {
+                t[l * n2 + 2 * i] = x[l];
+                t[l * n2 + 2 * i + 1] = x[l + 1];
+            }
+        }
+        for (l = 0; l < nb; l += 2) {
+            if (p->isgn >= 0) {
+                cftfsub(2 * n2, &t[l * n2], p->ip, p->nw, p->w);
+            } else {
+                cftbsub(2 * n2, &t[l * n2], p->ip, p->nw, p->w);
+            }
+        }
+        for (i = 0; i < n2; i++) {
+            x = &b[i][j];
+            for (l = 0; l < nb; l += 2) {
+                x[l] = t[l * n2 + 2 * i];
+                x[l + 1] = t[l * n2 + 2 * i + 1];
+            }
+        }
+    }
+}
+
+
+/*
+   the columns along j1: item k is the block of 4 complex columns
+   a[0...n1-1][k / nb][8 * (k % nb) + 0...7]
+*/
+void cdft3d_cols(void *arg, int k0, int k1, double *t)
+{
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    struct fft3d_arg *p = (struct fft3d_arg *) arg;
+    int i, j, k, l, n1, nb, nbk;
+    double *x;
+
+    n1 = p->n1;
+    nb = p->n3 < 8 ? p->n3 : 8;
+    nbk = (p->n3 + 7) >> 3;
+    for (k = k0; k < k1; k++) {
+        j = 8 * (k % nbk);
+        for (i = 0; i < n1; i++) {
+            x = &p->a[i][k / nbk][j];
+            for (l = 0; l < nb; l += 2) {
+                t[l * n1 + 2 * i] = x[l];
+                t[l * n1 + 2 * i + 1] = x[l + 1];
+            }
+        }
+        for (l = 0; l < nb; l += 2) {
+            if (p->isgn >= 0) {
+                cftfsub(2 * n1, &t[l * n1], p->ip, p->nw, p->w);
+            } else {
+                cftbsub(2 * n1, &t[l * n1], p->ip, p->nw, p->w);
+            }
+        }
+        for (i = 0; i < n1; i++) {
+            x = &p->a[i][k / nbk][j];
+            for (l = 0; l < nb; l += 2) {
+                x[l] = t[l * n1 + 2 * i];
+                x[l + 1] = t[l * n1 + 2 * i + 1];
+            }
+        }
+    }
+}
+
+
+/*
+   a[k][0], a[k][1] hold the 2D DFT of the real parts at k3 = 0 and
+   k3 = n3/2 packed as one complex sequence: separate (isgn >= 0) or
+   pack (isgn < 0) them with the pairs k = (k1, k2), -k
+*/
+void rdft3d_sub(int n1, int n2, int isgn, double ***a)
+{
+    int k1, k2, j1, j2;
+    double xi, *x, *y;
+
+    for (k1 = 0; k1 <= (n1 >> 1); k1++) {
+        j1 = (n1 - k1) & (n1 - 1);
+        for (k2 = 0; k2 < n2; k2++) {
+            j2 = (n2 - k2) & (n2 - 1);
+            if (k1 == j1 && k2 >= j2) {
+                continue;
+            }
+            x = a[k1][k2];
+            y = a[j1][j2];
+            if (isgn < 0) {
+                xi = x[0] - y[0];
+                x[0] += y[0];
+                y[0] = xi;
+                xi = y[1] - x[1];
+                x[1] += y[1];
+                y[1] = xi;
+            } else {
+                y[0] = 0.5 * (x[0] - y[0]);
+                x[0] -= y[0];
+                y[1] = 0.5 * (x[1] + y[1]);
+                x[1] -= y[1];
+            }
+        }
+    }
+}
+
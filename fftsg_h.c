@@ -20,6 +20,9 @@ function prototypes
     void ddst(int, int, double *);
     void dfct(int, double *);
     void dfst(int, double *);
+    void cdft_threads_set(int, int, int);
+    void cdft_threads_get(int *, int *, int *);
+    void cdft_threads_calibrate(void);
 macro definitions
     USE_CDFT_PTHREADS : default=not defined
         CDFT_THREADS_BEGIN_N  : must be >= 512, default=8192
@@ -27,6 +30,8 @@ macro definitions
     USE_CDFT_WINTHREADS : default=not defined
         CDFT_THREADS_BEGIN_N  : must be >= 512, default=32768
         CDFT_4THREADS_BEGIN_N : must be >= 512, default=524288
+    CDFT_MAX_THREADS : default=0 (= 4)
+        1 disables the threads, 2 or 3 use at most 2 threads
 
 
 -------- Complex DFT (Discrete Fourier Transform) --------
@@ -214,6 +219,34 @@ macro definitions
                 a[j] *= 2.0 / n;
             }
         .
+
+
+-------- Thread settings (USE_CDFT_PTHREADS, USE_CDFT_WINTHREADS) --------
+    [usage]
+        cdft_threads_set(begin_n, begin4_n, max_threads);
+        cdft_threads_get(&begin_n, &begin4_n, &max_threads);
+        cdft_threads_calibrate();
+    [parameters]
+        begin_n        :cdft of length n > begin_n is threaded (int)
+                        (initial value: CDFT_THREADS_BEGIN_N)
+        begin4_n       :n > begin4_n uses 4 or more threads (int)
+                        (initial value: CDFT_4THREADS_BEGIN_N)
+        max_threads    :upper limit of the threads (int)
+                        0 means 4 (at most 4 threads are used)
+                        (initial value: CDFT_MAX_THREADS)
+        cdft_threads_set leaves the values < 0 (begin_n and 
+        begin4_n: <= 0) unchanged.
+    [remark]
+        The environment variables CDFT_THREADS_BEGIN_N, 
+        CDFT_4THREADS_BEGIN_N and CDFT_MAX_THREADS override the 
+        initial values; they are read at the first transform.
+        cdft_threads_calibrate times cdft of n <= 2^21 with 1, 2 
+        and 4 threads on this machine and sets begin_n and 
+        begin4_n to the crossover points (a few seconds).
+        Do not call cdft_threads_set or cdft_threads_calibrate 
+        while other threads are running transforms.
+        Without threads, cdft_threads_get returns INT_MAX, 
+        INT_MAX, 1 and the other two do nothing.
 */
 
 
@@ -509,6 +542,13 @@ void dfst(int n, double *a)
         exit(1); \
     } \
 }
+#define cdft_mutex_t pthread_mutex_t
+#define CDFT_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define cdft_mutex_lock(mp) pthread_mutex_lock(mp)
+#define cdft_mutex_unlock(mp) pthread_mutex_unlock(mp)
+#define cdft_once_t pthread_once_t
+#define CDFT_ONCE_INIT PTHREAD_ONCE_INIT
+#define cdft_once(op,func) pthread_once(op, func)
 #endif /* USE_CDFT_PTHREADS */
 
 
@@ -536,9 +576,39 @@ void dfst(int n, double *a)
     WaitForSingleObject(th, INFINITE); \
     CloseHandle(th); \
 }
+#define cdft_mutex_t SRWLOCK
+#define CDFT_MUTEX_INITIALIZER SRWLOCK_INIT
+#define cdft_mutex_lock(mp) AcquireSRWLockExclusive(mp)
+#define cdft_mutex_unlock(mp) ReleaseSRWLockExclusive(mp)
+#define cdft_once_t INIT_ONCE
+#define CDFT_ONCE_INIT INIT_ONCE_STATIC_INIT
+#define cdft_once(op,func) \
+    InitOnceExecuteOnce(op, cdft_once_call, (PVOID) (func), NULL)
+static BOOL CALLBACK cdft_once_call(PINIT_ONCE op, PVOID func, PVOID *ctx)
+{
+    (*(void (*)(void)) func)();
+    return TRUE;
+}
 #endif /* USE_CDFT_WINTHREADS */
 
 
+#ifdef USE_CDFT_THREADS
+#ifndef CDFT_MAX_THREADS
+#define CDFT_MAX_THREADS 0
+#endif
+/* 
+   run-time settings: the environment is read once, by the first 
+   transform or cdft_threads_set/get (cdft_threads_once); 
+   cdft_threads_set/get hold cdft_threads_mutex 
+*/
+int cdft_threads_begin_n = CDFT_THREADS_BEGIN_N;
+int cdft_4threads_begin_n = CDFT_4THREADS_BEGIN_N;
+int cdft_max_threads = CDFT_MAX_THREADS;
+cdft_once_t cdft_threads_once = CDFT_ONCE_INIT;
+cdft_mutex_t cdft_threads_mutex = CDFT_MUTEX_INITIALIZER;
+#endif /* USE_CDFT_THREADS */
+
+
 #ifndef CDFT_LOOP_DIV  /* control of the CDFT's speed & tolerance */
 #define CDFT_LOOP_DIV 32
 #endif
@@ -567,13 +637,16 @@ void cftfsub(int n, double *a)
     void cftx020(double *a);
 #ifdef USE_CDFT_THREADS
     void cftrec4_th(int n, double *a);
+    void cdft_threads_init(void);
 #endif /* USE_CDFT_THREADS */
     
     if (n > 8) {
         if (n > 32) {
             cftmdl1(n, a);
 #ifdef USE_CDFT_THREADS
-            if (n > CDFT_THREADS_BEGIN_N) {
+            cdft_once(&cdft_threads_once, cdft_threads_init);
+            if (n > 512 && n > cdft_threads_begin_n && 
+                cdft_max_threads != 1) {
                 cftrec4_th(n, a);
             } else 
 #endif /* USE_CDFT_THREADS */
@@ -615,13 +688,16 @@ void cftbsub(int n, double *a)
     void cftx020(double *a);
 #ifdef USE_CDFT_THREADS
     void cftrec4_th(int n, double *a);
+    void cdft_threads_init(void);
 #endif /* USE_CDFT_THREADS */
     
     if (n > 8) {
         if (n > 32) {
             cftb1st(n, a);
 #ifdef USE_CDFT_THREADS
-            if (n > CDFT_THREADS_BEGIN_N) {
+            cdft_once(&cdft_threads_once, cdft_threads_init);
+            if (n > 512 && n > cdft_threads_begin_n && 
+                cdft_max_threads != 1) {
                 cftrec4_th(n, a);
             } else 
 #endif /* USE_CDFT_THREADS */
@@ -1903,7 +1979,8 @@ void cftrec4_th(int n, double *a)
     nthread = 2;
     idiv4 = 0;
     m = n >> 1;
-    if (n > CDFT_4THREADS_BEGIN_N) {
+    if (n > cdft_4threads_begin_n && 
+        (cdft_max_threads <= 0 || cdft_max_threads >= 4)) {
         nthread = 4;
         idiv4 = 1;
         m >>= 1;
@@ -3445,3 +3522,168 @@ void dstsub4(int n, double *a)
     a[m] *= wki;
 }
 
+
+/* -------- thread settings -------- */
+
+#include <limits.h>
+#ifdef USE_CDFT_PTHREADS
+#include <time.h>
+#endif /* USE_CDFT_PTHREADS */
+
+
+void cdft_threads_set(int begin_n, int begin4_n, int max_threads)
+{
+#ifdef USE_CDFT_THREADS
+    void cdft_threads_init(void);
+    
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+    cdft_mutex_lock(&cdft_threads_mutex);
+    if (begin_n > 0) {
+        cdft_threads_begin_n = begin_n;
+    }
+    if (begin4_n > 0) {
+        cdft_4threads_begin_n = begin4_n;
+    }
+    if (max_threads >= 0) {
+        cdft_max_threads = max_threads;
+    }
+    cdft_mutex_unlock(&cdft_threads_mutex);
+#endif /* USE_CDFT_THREADS */
+}
+
+
+void cdft_threads_get(int *begin_n, int *begin4_n, int *max_threads)
+{
+#ifdef USE_CDFT_THREADS
+    void cdft_threads_init(void);
+    
+    cdft_once(&cdft_threads_once, cdft_threads_init);
+    cdft_mutex_lock(&cdft_threads_mutex);
+    *begin_n = cdft_threads_begin_n;
+    *begin4_n = cdft_4threads_begin_n;
+    *max_threads = cdft_max_threads;
+    if (*max_threads <= 0 || *max_threads > 4) {
+        *max_threads = 4;
+    }
+    cdft_mutex_unlock(&cdft_threads_mutex);
+#else
+    *begin_n = INT_MAX;
+    *begin4_n = INT_MAX;
+    *max_threads = 1;
+#endif /* USE_CDFT_THREADS */
+}
+
+
+void cdft_threads_calibrate(void)
+{
+#ifdef USE_CDFT_THREADS
+    void cdft_threads_get(int *begin_n, int *begin4_n, int *max_threads);
+    void cdft_threads_set(int begin_n, int begin4_n, int max_threads);
+    double cdft_threads_time(int n, double *a);
+    int n, nmax, begin_n, begin4_n, max_threads;
+    double *a, t1, t2;
+    
+    cdft_threads_get(&begin_n, &begin4_n, &max_threads);
+    if (max_threads < 2) {
+        return;
+    }
+    nmax = 1 << 21;
+    a = (double *) calloc(nmax, sizeof(double));
+    if (a == NULL) {
+        return;
+    }
+    /* 2 threads against 1, from the largest n down */
+    begin_n = INT_MAX;
+    for (n = nmax; n > 1024; n >>= 1) {
+        cdft_threads_set(INT_MAX, INT_MAX, -1);
+        t1 = cdft_threads_time(n, a);
+        cdft_threads_set(512, INT_MAX, -1);
+        t2 = cdft_threads_time(n, a);
+        if (t2 >= t1) {
+            break;
+        }
+        begin_n = n >> 1;
+    }
+    /* 4 threads against 2 */
+    begin4_n = INT_MAX;
+    for (n = nmax; n > 1024 && (n >> 1) >= begin_n; n >>= 1) {
+        cdft_threads_set(512, INT_MAX, -1);
+        t1 = cdft_threads_time(n, a);
+        cdft_threads_set(512, 512, -1);
+        t2 = cdft_threads_time(n, a);
+        if (t2 >= t1) {
+            break;
+        }
+        begin4_n = n >> 1;
+    }
+    cdft_threads_set(begin_n, begin4_n, -1);
+    free(a);
+#endif /* USE_CDFT_THREADS */
+}
+
+
+#ifdef USE_CDFT_THREADS
+void cdft_threads_init(void)
+{
+    char *s;
+    
+    /* ---- run by cdft_once: the settings are seen by all 
+            threads that pass cdft_threads_once ---- */
+    s = getenv("CDFT_THREADS_BEGIN_N");
+    if (s != NULL && atoi(s) > 0) {
+        cdft_threads_begin_n = atoi(s);
+    }
+    s = getenv("CDFT_4THREADS_BEGIN_N");
+    if (s != NULL && atoi(s) > 0) {
+        cdft_4threads_begin_n = atoi(s);
+    }
+    s = getenv("CDFT_MAX_THREADS");
+    if (s != NULL && atoi(s) > 0) {
+        cdft_max_threads = atoi(s);
+    }
+}
+
+
+double cdft_threads_time(int n, double *a)
+{
+    void cdft(int n, int isgn, double *a);
+    double cdft_wtime(void);
+    int i, j, nrep;
+    double t, tmin;
+    
+    nrep = (1 << 19) / n;
+    if (nrep < 1) {
+        nrep = 1;
+    }
+    tmin = 0;
+    for (i = 0; i < 3; i++) {
+        t = cdft_wtime();
+        for (j = 0; j < nrep; j++) {
+            cdft(n, 1, a);
+        }
+        t = cdft_wtime() - t;
+        if (i == 0 || t < tmin) {
+            tmin = t;
+        }
+    }
+    return tmin;
+}
+
+
+double cdft_wtime(void)
+{
+#ifdef USE_CDFT_WINTHREADS
+    LARGE_INTEGER c, f;
+    
+    QueryPerformanceCounter(&c);
+    QueryPerformanceFrequency(&f);
+    return (double) c.QuadPart / (double) f.QuadPart;
+#else
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+#endif /* USE_CDFT_WINTHREADS */
+}
+#endif /* USE_CDFT_THREADS */
+
@@ -0,0 +1,582 @@
+/*
+Fast Fourier Transform, out of core (data in a file)
+    dimension   :one
+    data length :power of 2
+    decimation  :frequency
+    radix       :split-radix, four-step (columns, rows, transpose)
+    data        :inplace (in the file)
+    table       :use
+functions
+    cdftooc: Complex Discrete Fourier Transform of a file
+    rdftooc: Real Discrete Fourier Transform of a file
+function prototypes
+    int cdftooc(long long, int, FILE *, int, double *, int *, double *);
+    int rdftooc(long long, int, FILE *, int, double *, int *, double *);
+necessary package
+    fftsg.c  : 1D-FFT package
+    (with USE_CDFT_PTHREADS or USE_CDFT_WINTHREADS in fftsg.c,
+    the file I/O of the neighbouring blocks overlaps the FFTs of
+    the current block, and the FFTs of a block are run by the
+    worker threads)
+
+
+-------- Complex DFT of a file --------
+    [definition]
+        as cdft in fftsg.c
+    [usage]
+        ip[0] = 0; // first time only
+        cdftooc(2*n, 1, fp, nt, t, ip, w);
+    [parameters]
+        2*n            :data length (long long)
+                        n >= 2, n = power of 2
+        isgn           :as in cdft
+        fp             :file of the data (FILE *)
+                        opened in binary mode for update ("r+b")
+                        input data
+                            a[0...2*n-1] of cdft, as double
+                            (native format) from the beginning
+                            of the file
+                        output data
+                            a[0...2*n-1] of cdft, in place
+        nt             :length of t (int)
+                        nt >= 13*sqrt(2*n)+8
+        t[0...nt-1]    :work area (double *)
+                        (two I/O buffers of about nt/2; the larger
+                        nt, the longer the reads and writes)
+        ip[0...*]      :work area for bit reversal (int *)
+                        length of ip >= 2+sqrt(sqrt(2*n))
+                        ip[0],ip[1] are pointers of the cos/sin table.
+        w[0...*]       :cos/sin table (double *)
+                        length of w >= sqrt(2*n)/2
+                        w[],ip[] are initialized if ip[0] == 0.
+        cdftooc returns 0, or -1 if nt is too small or a seek,
+        read or write of fp failed (then the file is undefined).
+    [remark]
+        With n = n1 * n2 (n1 = n2 or 2 * n2), the file is the
+        n1 x n2 matrix of rows of x[], and three passes run over
+        the file:
+            1. FFTs of length n1 on blocks of columns (one seek,
+               read and write per row of a block), times the
+               twiddle factors exp(+-2*pi*i*j2*k1/n),
+            2. FFTs of length n2 on blocks of rows,
+            3. transpose by pairs of square tiles.
+        In each pass the next block is read and the previous one
+        written while the FFTs of the current block run, in two
+        buffers.
+        The ip[], w[] are those of cdft of length 2*sqrt(2*n)
+        (compatible with the other routines).
+
+
+-------- Real DFT of a file --------
+    [definition]
+        as rdft in fftsg.c
+    [usage]
+        ip[0] = 0; // first time only
+        rdftooc(n, 1, fp, nt, t, ip, w);
+    [parameters]
+        n              :data length (long long)
+                        n >= 4, n = power of 2
+        isgn, fp, nt, t, ip, w
+                       :as in cdftooc, with a[0...n-1] of rdft
+                        in the file (nt >= 13*sqrt(n)+8, nt >= 136)
+        rdftooc returns 0, or -1 as cdftooc.
+    [remark]
+        cdftooc of length n and one more pass that pairs the
+        blocks at a[j] and a[n-j] (read from the front and the
+        back of the file).
+*/
+
+
+#ifndef _WIN32
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#endif
+#include <stdio.h>
+#include <math.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#define fftooc_fseek(fp, off) _fseeki64(fp, off, SEEK_SET)
+#else
+#define fftooc_fseek(fp, off) fseeko(fp, (off_t) (off), SEEK_SET)
+#endif
+
+
+/* one pass over the file: blocks 0...nblk-1 in two buffers */
+struct fftooc_arg {
+    long long n;
+    int n1, n2, isgn, nw, nbuf, nb, nblk, b, err;
+    FILE *fp;
+    double *ws, *tc, *buf[2];
+    int *ip;
+    double *w;
+    void (*io)(struct fftooc_arg *p, int b, int wr, double *x);
+    void (*fft)(struct fftooc_arg *p, int b, double *x);
+};
+
+
+int cdftooc(long long n, int isgn, FILE *fp, int nt, double *t,
+    int *ip, double *w)
+{
+    void makewt(int nw, int *ip, double *w);
+    int fftooc_pass(struct fftooc_arg *p);
+    void fftooc_cio(struct fftooc_arg *p, int b, int wr, double *x);
+    void fftooc_cfft(struct fftooc_arg *p, int b, double *x);
+    void fftooc_rio(struct fftooc_arg *p, int b, int wr, double *x);
+    void fftooc_rfft(struct fftooc_arg *p, int b, double *x);
+    void fftooc_tio(struct fftooc_arg *p, int b, int wr, double *x);
+    void fftooc_tfft(struct fftooc_arg *p, int b, double *x);
+    int j, n1, n2, nw, nb, nbt;
+    double delta;
+    struct fftooc_arg arg;
+
+    /* n/2 = n1 * n2, n1 = n2 or 2 * n2 */
+    n2 = 1;
+    while ((long long) n2 * n2 * 2 < (n >> 1)) {
+        n2 <<= 1;
+    }
+    if ((long long) n2 * n2 > (n >> 1)) {
+        n2 >>= 1;
+    }
+    n1 = (int) ((n >> 1) / n2);
+    /* t: ws[2*(n1+n2)], tc[2*n1+8], buf[0], buf[1] */
+    arg.nbuf = (nt - 2 * (n1 + n2) - (2 * n1 + 8)) / 2;
+    if (n < 4 || arg.nbuf < 4 * n1) {
+        return -1;
+    }
+    nw = ip[0];
+    if (2 * n1 > (nw << 2)) {
+        nw = n1 >> 1;
+        makewt(nw, ip, w);
+    }
+    arg.n = n;
+    arg.n1 = n1;
+    arg.n2 = n2;
+    arg.isgn = isgn;
+    arg.nw = nw;
+    arg.fp = fp;
+    arg.ws = t;
+    arg.tc = t + 2 * (n1 + n2);
+    arg.buf[0] = arg.tc + 2 * n1 + 8;
+    arg.buf[1] = arg.buf[0] + arg.nbuf;
+    arg.ip = ip;
+    arg.w = w;
+    /* ws[2*j] = exp(+-2*pi*i*j/(n/2)), 0<=j<n1,
+       ws[2*n1+2*j] = exp(+-2*pi*i*j/n2), 0<=j<n2 */
+    delta = 8 * atan(1.0) / (double) (n >> 1);
+    for (j = 0; j < n1; j++) {
+        t[2 * j] = cos(delta * j);
+        t[2 * j + 1] = isgn >= 0 ? sin(delta * j) : -sin(delta * j);
+    }
+    delta = 8 * atan(1.0) / n2;
+    for (j = 0; j < n2; j++) {
+        t[2 * n1 + 2 * j] = cos(delta * j);
+        t[2 * n1 + 2 * j + 1] = isgn >= 0 ? sin(delta * j) :
+            -sin(delta * j);
+    }
+    /* 1. columns: blocks of nb columns */
+    nb = n2;
+    while (nb > 1 && 2 * n1 * nb > arg.nbuf) {
+        nb >>= 1;
+    }
+    arg.nb = nb;
+    arg.nblk = n2 / nb;
+    arg.io = fftooc_cio;
+    arg.fft = fftooc_cfft;
+    if (fftooc_pass(&arg) != 0) {
+        return -1;
+    }
+    /* 2. rows: blocks of nb rows */
+    nb = n1;
+    while (nb > 1 && 2 * n2 * nb > arg.nbuf) {
+        nb >>= 1;
+    }
+    arg.nb = nb;
+    arg.nblk = n1 / nb;
+    arg.io = fftooc_rio;
+    arg.fft = fftooc_rfft;
+    if (fftooc_pass(&arg) != 0) {
+        return -1;
+    }
+    /* 3. transpose: pairs of nb x nb tiles (i,j), (j,i), i <= j */
+    nb = n2;
+    while (nb > 1 && 4 * nb * nb > arg.nbuf) {
+        nb >>= 1;
+    }
+    nbt = n2 / nb;
+    arg.nb = nb;
+    arg.nblk = (n1 / n2) * (nbt * (nbt + 1) / 2);
+    arg.io = fftooc_tio;
+    arg.fft = fftooc_tfft;
+    return fftooc_pass(&arg);
+}
+
+
+int rdftooc(long long n, int isgn, FILE *fp, int nt, double *t,
+    int *ip, double *w)
+{
+    int fftooc_pass(struct fftooc_arg *p);
+    void fftooc_sio(struct fftooc_arg *p, int b, int wr, double *x);
+    void fftooc_sfft(struct fftooc_arg *p, int b, double *x);
+    int j, nb;
+    double delta;
+    struct fftooc_arg arg;
+
+    if (n < 4 || nt < 136) {
+        return -1;
+    }
+    if (isgn >= 0 && cdftooc(n, 1, fp, nt, t, ip, w) != 0) {
+        return -1;
+    }
+    /* blocks of a[j], a[n-j]: t: ws[128], buf[0], buf[1] */
+    arg.n = n;
+    arg.isgn = isgn;
+    arg.fp = fp;
+    arg.ws = t;
+    arg.nbuf = (nt - 128) / 2;
+    arg.buf[0] = t + 128;
+    arg.buf[1] = arg.buf[0] + arg.nbuf;
+    nb = 2;
+    while ((long long) nb < (n >> 1) && 4 * nb <= arg.nbuf) {
+        nb <<= 1;
+    }
+    arg.nb = nb;
+    arg.nblk = (int) ((n >> 1) / nb);
+    arg.io = fftooc_sio;
+    arg.fft = fftooc_sfft;
+    /* ws[2*j] = cos(pi*2*j/n), ws[2*j+1] = sin(pi*2*j/n), j < 64 */
+    delta = 4 * atan(1.0) / (double) n;
+    for (j = 0; j < 64; j++) {
+        t[2 * j] = cos(delta * 2 * j);
+        t[2 * j + 1] = sin(delta * 2 * j);
+    }
+    if (fftooc_pass(&arg) != 0) {
+        return -1;
+    }
+    if (isgn < 0) {
+        return cdftooc(n, -1, fp, nt, t, ip, w);
+    }
+    return 0;
+}
+
+
+int fftooc_pass(struct fftooc_arg *p)
+{
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t,
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void fftooc_step(void *arg, int k0, int k1, double *t);
+    int b;
+
+    p->err = 0;
+    (*p->io)(p, 0, 0, p->buf[0]);
+    for (b = 0; b < p->nblk && p->err == 0; b++) {
+        p->b = b;
+        /* item 0: FFTs of block b, item 1: I/O of b-1 and b+1 */
+        cdft_threads_for(2, p->nbuf, 2, 0, NULL, fftooc_step, p);
+    }
+    if (p->err == 0) {
+        (*p->io)(p, p->nblk - 1, 1, p->buf[(p->nblk - 1) & 1]);
+    }
+    return p->err;
+}
+
+
+void fftooc_step(void *arg, int k0, int k1, double *t)
+{
+    struct fftooc_arg *p = (struct fftooc_arg *) arg;
+    int b, k;
+
+    b = p->b;
+    for (k = k0; k < k1; k++) {
+        if (k == 0) {
+            (*p->fft)(p, b, p->buf[b & 1]);
+        } else {
+            if (b > 0) {
+                (*p->io)(p, b - 1, 1, p->buf[(b - 1) & 1]);
+            }
+            if (b + 1 < p->nblk) {
+                (*p->io)(p, b + 1, 0, p->buf[(b + 1) & 1]);
+            }
+        }
+    }
+}
+
+
+void fftooc_rw(struct fftooc_arg *p, long long off, int len, int wr,
+    double *x)
+{
+    size_t m;
+
+    if (p->err != 0 || len <= 0) {
+        return;
+    }
+    if (fftooc_fseek(p->fp, off * (long long) sizeof(double)) != 0) {
+        p->err = -1;
+        return;
+    }
+    if (wr) {
+        m = fwrite(x, sizeof(double), len, p->fp);
+    } else {
+        m = fread(x, sizeof(double), len, p->fp);
+    }
+    if (m != (size_t) len) {
+        p->err = -1;
+    }
+}
+
+
+/* 1. columns nb*b...nb*b+nb-1 of the rows: x[n1][2*nb] */
+void fftooc_cio(struct fftooc_arg *p, int b, int wr, double *x)
+{
+    void fftooc_rw(struct fftooc_arg *p, long long off, int len,
+        int wr, double *x);
+    int i, n1, n2, nb, r, s;
+
+    n1 = p->n1;
+    n2 = p->n2;
+    nb = p->nb;
+    r = n1 / n2;
+    for (i = 0; i < n1; i++) {
+        /* the output row k1 = h*n2+k1' is stored at row k1'*r+h,
+           so that the transpose is of r square matrices */
+        s = wr ? (i & (n2 - 1)) * r + i / n2 : i;
+        fftooc_rw(p, 2 * ((long long) s * n2 + (long long) nb * b),
+            2 * nb, wr, &x[2 * nb * i]);
+    }
+}
+
+
+struct fftooc_sub {
+    struct fftooc_arg *p;
+    int b;
+    double *x;
+};
+
+
+void fftooc_cfft(struct fftooc_arg *p, int b, double *x)
+{
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t,
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void fftooc_cols(void *arg, int k0, int k1, double *t);
+    struct fftooc_sub sub;
+
+    sub.p = p;
+    sub.b = b;
+    sub.x = x;
+    cdft_threads_for(2 * p->n1, 1, p->nb, 2 * p->n1 + 8, p->tc,
+        fftooc_cols, &sub);
+}
+
+
+void fftooc_cols(void *arg, int k0, int k1, double *t)
+{
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    struct fftooc_arg *p = ((struct fftooc_sub *) arg)->p;
+    double *x = ((struct fftooc_sub *) arg)->x;
+    int i, l, m, n1, nb;
+    long long e;
+    double *wl, *wh, wr, wi, xr, xi;
+
+    n1 = p->n1;
+    nb = p->nb;
+    wl = p->ws;
+    wh = p->ws + 2 * n1;
+    m = 0;
+    while ((1 << m) < n1) {
+        m++;
+    }
+    for (l = k0; l < k1; l++) {
+        for (i = 0; i < n1; i++) {
+            t[2 * i] = x[2 * nb * i + 2 * l];
+            t[2 * i + 1] = x[2 * nb * i + 2 * l + 1];
+        }
+        if (p->isgn >= 0) {
+            cftfsub(2 * n1, t, p->ip, p->nw, p->w);
+        } else {
+            cftbsub(2 * n1, t, p->ip, p->nw, p->w);
+        }
+        for (i = 0; i < n1; i++) {
+            /* exp(+-2*pi*i*e/(n/2)), e = j2 * k1 */
+            e = ((long long) nb * ((struct fftooc_sub *) arg)->b + l) * i;
+            wr = wh[2 * (e >> m)] * wl[2 * (e & (n1 - 1))] -
+                wh[2 * (e >> m) + 1] * wl[2 * (e & (n1 - 1)) + 1];
+            wi = wh[2 * (e >> m)] * wl[2 * (e & (n1 - 1)) + 1] +
+                wh[2 * (e >> m) + 1] * wl[2 * (e & (n1 - 1))];
+            xr = t[2 * i];
+            xi = t[2 * i + 1];
+            x[2 * nb * i + 2 * l] = wr * xr - wi * xi;
+            x[2 * nb * i + 2 * l + 1] = wr * xi + wi * xr;
+        }
+    }
+}
+
+
+/* 2. rows nb*b...nb*b+nb-1: x[nb][2*n2] */
+void fftooc_rio(struct fftooc_arg *p, int b, int wr, double *x)
+{
+    void fftooc_rw(struct fftooc_arg *p, long long off, int len,
+        int wr, double *x);
+
+    fftooc_rw(p, 2 * (long long) p->nb * b * p->n2, 2 * p->nb * p->n2,
+        wr, x);
+}
+
+
+void fftooc_rfft(struct fftooc_arg *p, int b, double *x)
+{
+    void cdft_threads_for(int n, int m, int nitem, int nwk, double *t,
+        void (*func)(void *arg, int k0, int k1, double *t), void *arg);
+    void fftooc_rows(void *arg, int k0, int k1, double *t);
+    struct fftooc_sub sub;
+
+    sub.p = p;
+    sub.b = b;
+    sub.x = x;
+    cdft_threads_for(2 * p->n2, 1, p->nb, 0, NULL, fftooc_rows, &sub);
+}
+
+
+void fftooc_rows(void *arg, int k0, int k1, double *t)
+{
+    void cftfsub(int n, double *a, int *ip, int nw, double *w);
+    void cftbsub(int n, double *a, int *ip, int nw, double *w);
+    struct fftooc_arg *p = ((struct fftooc_sub *) arg)->p;
+    double *x = ((struct fftooc_sub *) arg)->x;
+    int k, n2;
+
+    n2 = p->n2;
+    for (k = k0; k < k1; k++) {
+        if (p->isgn >= 0) {
+            cftfsub(2 * n2, &x[2 * n2 * k], p->ip, p->nw, p->w);
+        } else {
+            cftbsub(2 * n2, &x[2 * n2 * k], p->ip, p->nw, p->w);
+        }
+    }
+}
+
+
+/* 3. tiles (i,j), (j,i) of the matrix h: x[2][nb][2*nb] */
+void fftooc_tile(struct fftooc_arg *p, int b, int *h, int *i, int *j)
+{
+    int k, nbt;
+
+    nbt = p->n2 / p->nb;
+    k = nbt * (nbt + 1) / 2;
+    *h = b / k;
+    b -= *h * k;
+    *i = 0;
+    while (b >= nbt - *i) {
+        b -= nbt - *i;
+        (*i)++;
+    }
+    *j = *i + b;
+}
+
+
+void fftooc_tio(struct fftooc_arg *p, int b, int wr, double *x)
+{
+    void fftooc_tile(struct fftooc_arg *p, int b, int *h, int *i,
+        int *j);
+    void fftooc_rw(struct fftooc_arg *p, long long off, int len,
+        int wr, double *x);
+    int h, i, j, k, nb;
+
+    nb = p->nb;
+    fftooc_tile(p, b, &h, &i, &j);
+    for (k = 0; k < nb; k++) {
+        fftooc_rw(p, 2 * ((long long) (nb * i + k) * p->n1 +
+            (long long) h * p->n2 + nb * j), 2 * nb, wr, &x[2 * nb * k]);
+        if (i != j) {
+            fftooc_rw(p, 2 * ((long long) (nb * j + k) * p->n1 +
+                (long long) h * p->n2 + nb * i), 2 * nb, wr,
+                &x[2 * nb * (nb + k)]);
+        }
+    }
+}
+
+
+void fftooc_tfft(struct fftooc_arg *p, int b, double *x)
+{
+    void fftooc_tile(struct fftooc_arg *p, int b, int *h, int *i,
+        int *j);
+    int h, i, j, k, l, nb;
+    double *y, xr, xi;
+
+    nb = p->nb;
+    fftooc_tile(p, b, &h, &i, &j);
+    y = i != j ? &x[2 * nb * nb] : x;
+    for (k = 0; k < nb; k++) {
+        for (l = i != j ? 0 : k + 1; l < nb; l++) {
+            xr = x[2 * nb * k + 2 * l];
+            xi = x[2 * nb * k + 2 * l + 1];
+            x[2 * nb * k + 2 * l] = y[2 * nb * l + 2 * k];
+            x[2 * nb * k + 2 * l + 1] = y[2 * nb * l + 2 * k + 1];
+            y[2 * nb * l + 2 * k] = xr;
+            y[2 * nb * l + 2 * k + 1] = xi;
+        }
+    }
+}
+
+
+/* rdft: a[j], nb*b <= j < nb*b+nb, in x[0...nb-1] and a[n-j] in
+   x[nb...2*nb-1] (x[2*nb-2-(j-nb*b)] = a[n-j]) */
+void fftooc_sio(struct fftooc_arg *p, int b, int wr, double *x)
+{
+    void fftooc_rw(struct fftooc_arg *p, long long off, int len,
+        int wr, double *x);
+    long long j;
+
+    j = (long long) p->nb * b;
+    fftooc_rw(p, j, p->nb, wr, x);
+    fftooc_rw(p, p->n - j - p->nb + 2, b == 0 ? p->nb - 2 : p->nb, wr,
+        &x[p->nb]);
+}
+
+
+void fftooc_sfft(struct fftooc_arg *p, int b, double *x)
+{
+    int j, k, l, nb;
+    double *ew, s0, c0, wkr, wki, xr, xi, yr, yi;
+
+    nb = p->nb;
+    ew = p->ws;
+    if (b == 0 && p->isgn < 0) {
+        x[1] = 0.5 * (x[0] - x[1]);
+        x[0] -= x[1];
+    }
+    for (l = 0; l < nb; l += 128) {
+        /* wkr = 0.5 - 0.5 * sin(pi*j/n), wki = 0.5 * cos(pi*j/n) */
+        s0 = 4 * atan(1.0) * ((double) nb * b + l) / (double) p->n;
+        c0 = 0.5 * cos(s0);
+        s0 = 0.5 * sin(s0);
+        for (j = b == 0 && l == 0 ? 2 : l; j < l + 128 && j < nb;
+            j += 2) {
+            k = 2 * nb - 2 - j;
+            wkr = 0.5 - (s0 * ew[j - l] + c0 * ew[j - l + 1]);
+            wki = c0 * ew[j - l] - s0 * ew[j - l + 1];
+            xr = x[j] - x[k];
+            xi = x[j + 1] + x[k + 1];
+            if (p->isgn >= 0) {
+                yr = wkr * xr - wki * xi;
+                yi = wkr * xi + wki * xr;
+            } else {
+                yr = wkr * xr + wki * xi;
+                yi = wkr * xi - wki * xr;
+            }
+            x[j] -= yr;
+            x[j + 1] -= yi;
+            x[k] += yr;
+            x[k + 1] -= yi;
+        }
+    }
+    if (b == 0 && p->isgn >= 0) {
+        xi = x[0] - x[1];
+        x[0] += x[1];
+        x[1] = xi;
+    }
+}
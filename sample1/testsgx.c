@@ -0,0 +1,753 @@
+/* test of the fftsg.c extensions (plan, batch, mixed radix, chirp-z, 
+   cdfts, strided, cdfto, rdftb, fftsg2d.c, fftsg3d.c, fftsgf.c, fftsgooc.c) */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#define MAX(x,y) ((x) > (y) ? (x) : (y))
+
+/* random number generator, 0 <= RND < 1 */
+#define RND(p) ((*(p) = (*(p) * 7141 + 54773) % 259200) * (1.0 / 259200.0))
+
+#ifndef NMAX
+#define NMAX 8192
+#define NMAXSQRT 64
+#endif
+
+void cdft(int, int, double *, int *, double *);
+void rdft(int, int, double *, int *, double *);
+void ddct(int, int, double *, int *, double *);
+void ddst(int, int, double *, int *, double *);
+void dfct(int, double *, double *, int *, double *);
+void dfst(int, double *, double *, int *, double *);
+void cdfts(int, int, double *, double *, int *, double *);
+void cdftst(int, int, double *, int, double *, int *, double *);
+void rdftst(int, int, double *, int, double *, int *, double *);
+void cdfto(int, int, double *, double *, int *, double *);
+void rdftb(int, int, double *, int *, double *);
+struct fft_plan *cdft_plan_create(int, int);
+struct fft_plan *rdft_plan_create(int, int);
+struct fft_plan *ddct_plan_create(int, int);
+struct fft_plan *ddst_plan_create(int, int);
+struct fft_plan *dfct_plan_create(int);
+struct fft_plan *dfst_plan_create(int);
+int fft_plan_exec(struct fft_plan *, double *);
+int fft_plan_exec_many(struct fft_plan *, int, double *, int, int);
+void fft_plan_destroy(struct fft_plan *);
+void cdft2d(int, int, int, double **, double *, int *, double *);
+void rdft2d(int, int, int, double **, double *, int *, double *);
+void ddct2d(int, int, int, double **, double *, int *, double *);
+void ddst2d(int, int, int, double **, double *, int *, double *);
+void cdft3d(int, int, int, int, double ***, double *, int *, double *);
+void rdft3d(int, int, int, int, double ***, double *, int *, double *);
+int cdftooc(long long, int, FILE *, int, double *, int *, double *);
+int rdftooc(long long, int, FILE *, int, double *, int *, double *);
+void cdftf(int, int, float *, int *, float *);
+void rdftf(int, int, float *, int *, float *);
+void ddctf(int, int, float *, int *, float *);
+void ddstf(int, int, float *, int *, float *);
+void dfctf(int, float *, float *, int *, float *);
+void dfstf(int, float *, float *, int *, float *);
+void putdata(int nini, int nend, double *a);
+double diffcheck(int nini, int nend, double *a, double *b);
+double plancheck(struct fft_plan *p, int n, int kind, int isgn, double *a, 
+    double *b, double *t, int *ip, double *w);
+double batchcheck(struct fft_plan *p, int n, int kind, int interleave, 
+    double *a, double *b, double *t);
+double mixcheck(int n, int kind, int isgn, double *a, double *b);
+double splitcheck(int n, int isgn, double *a, double *b, double *t, 
+    int *ip, double *w, int *ips, double *ws);
+double stridecheck(int n, int kind, int isgn, double *a, double *b, 
+    double *t, int *ip, double *w);
+double outcheck(int n, int isgn, int offset);
+double bitrevcheck(int n, int isgn, double *a, double *b, int *ip, 
+    double *w);
+double mdcheck(int n1, int n2, int n3, int kind, int isgn);
+double ooccheck(int n, int kind, int isgn, int nt, double *a, double *b, 
+    double *t, int *ip, double *w);
+void cdftref(int n1, int n2, int n3, int isgn, double *r, double *t, 
+    int *ip, double *w);
+double floatcheck(int n, int kind, int isgn, double *a, double *t, 
+    int *ip, double *w, float *af, float *tf, int *ipf, float *wf);
+
+
+int main()
+{
+    int n, j, ip[NMAXSQRT + 2], ipf[NMAXSQRT + 2], ips[1];
+    int nmix[8] = {6, 10, 14, 24, 210, 1000, 1536, 1680};
+    int nchirp[4] = {22, 194, 858, 2018};
+    double a[NMAX + 1], b[NMAX + 1], w[NMAX * 5 / 4], t[NMAX / 2 + 1], err;
+    double ws[NMAX];
+    float af[NMAX + 1], wf[NMAX * 5 / 4], tf[NMAX / 2 + 1];
+
+    printf("data length n=? (must be 2^m)\n");
+    scanf("%d", &n);
+    ip[0] = 0;
+
+    /* check of plans (against cdft, rdft, ...) */
+    err = plancheck(cdft_plan_create(n, 1), n, 0, 1, a, b, t, ip, w);
+    err = MAX(err, plancheck(cdft_plan_create(n, -1), n, 0, -1, a, b, t, ip, w));
+    printf("cdft_plan err= %g \n", err);
+    err = plancheck(rdft_plan_create(n, 1), n, 1, 1, a, b, t, ip, w);
+    err = MAX(err, plancheck(rdft_plan_create(n, -1), n, 1, -1, a, b, t, ip, w));
+    printf("rdft_plan err= %g \n", err);
+    err = plancheck(ddct_plan_create(n, 1), n, 2, 1, a, b, t, ip, w);
+    err = MAX(err, plancheck(ddct_plan_create(n, -1), n, 2, -1, a, b, t, ip, w));
+    printf("ddct_plan err= %g \n", err);
+    err = plancheck(ddst_plan_create(n, 1), n, 3, 1, a, b, t, ip, w);
+    err = MAX(err, plancheck(ddst_plan_create(n, -1), n, 3, -1, a, b, t, ip, w));
+    printf("ddst_plan err= %g \n", err);
+    err = plancheck(dfct_plan_create(n), n, 4, 1, a, b, t, ip, w);
+    printf("dfct_plan err= %g \n", err);
+    err = plancheck(dfst_plan_create(n), n, 5, 1, a, b, t, ip, w);
+    printf("dfst_plan err= %g \n", err);
+
+    /* check of batches of n/4 (against fft_plan_exec), n/4 >= 2 */
+    err = 0;
+    for (j = 0; j <= 1 && n >= 8; j++) {
+        err = MAX(err, batchcheck(cdft_plan_create(n / 4, 1), n / 4, 0, j, a, b, t));
+        err = MAX(err, batchcheck(rdft_plan_create(n / 4, 1), n / 4, 1, j, a, b, t));
+        err = MAX(err, batchcheck(ddct_plan_create(n / 4, 1), n / 4, 2, j, a, b, t));
+        err = MAX(err, batchcheck(ddst_plan_create(n / 4, 1), n / 4, 3, j, a, b, t));
+        err = MAX(err, batchcheck(dfct_plan_create(n / 4), n / 4, 4, j, a, b, t));
+        err = MAX(err, batchcheck(dfst_plan_create(n / 4), n / 4, 5, j, a, b, t));
+    }
+    printf("fft_plan_exec_many err= %g \n", err);
+
+    /* check of mixed radix plans (against the definitions) */
+    err = 0;
+    for (j = 0; j < 8; j++) {
+        err = MAX(err, mixcheck(nmix[j], 0, 1, a, b));
+        err = MAX(err, mixcheck(nmix[j], 0, -1, a, b));
+    }
+    for (j = 0; j <= 1; j++) {
+        err = MAX(err, batchcheck(cdft_plan_create(1000, 1), 1000, 0, j, a, b, t));
+    }
+    printf("cdft_plan (2^a*3^b*5^c*7^d) err= %g \n", err);
+    err = 0;
+    for (j = 0; j < 8; j++) {
+        err = MAX(err, mixcheck(nmix[j], 1, 1, a, b));
+        err = MAX(err, mixcheck(nmix[j], 1, -1, a, b));
+    }
+    for (j = 0; j <= 1; j++) {
+        err = MAX(err, batchcheck(rdft_plan_create(1000, 1), 1000, 1, j, a, b, t));
+    }
+    printf("rdft_plan (2^a*3^b*5^c*7^d) err= %g \n", err);
+
+    /* check of chirp-z plans (other n, against the definitions) */
+    err = 0;
+    for (j = 0; j < 4; j++) {
+        err = MAX(err, mixcheck(nchirp[j], 0, 1, a, b));
+        err = MAX(err, mixcheck(nchirp[j], 0, -1, a, b));
+    }
+    for (j = 0; j <= 1; j++) {
+        err = MAX(err, batchcheck(cdft_plan_create(2018, -1), 2018, 0, j, a, b, t));
+    }
+    printf("cdft_plan (chirp-z) err= %g \n", err);
+    err = 0;
+    for (j = 0; j < 4; j++) {
+        err = MAX(err, mixcheck(nchirp[j], 1, 1, a, b));
+        err = MAX(err, mixcheck(nchirp[j], 1, -1, a, b));
+    }
+    printf("rdft_plan (chirp-z) err= %g \n", err);
+
+    /* check of the split format (against cdft) */
+    ips[0] = 0;
+    err = splitcheck(n, 1, a, b, t, ip, w, ips, ws);
+    err = MAX(err, splitcheck(n, -1, a, b, t, ip, w, ips, ws));
+    printf("cdfts err= %g \n", err);
+
+    /* check of strided data of n/4 (against cdft, rdft), n/4 >= 2 */
+    err = 0;
+    if (n >= 8) {
+        err = stridecheck(n / 4, 0, 1, a, b, t, ip, w);
+        err = MAX(err, stridecheck(n / 4, 0, -1, a, b, t, ip, w));
+    }
+    printf("cdftst err= %g \n", err);
+    err = 0;
+    if (n >= 8) {
+        err = stridecheck(n / 4, 1, 1, a, b, t, ip, w);
+        err = MAX(err, stridecheck(n / 4, 1, -1, a, b, t, ip, w));
+    }
+    printf("rdftst err= %g \n", err);
+
+    /* check of the out of place cdft (against cdft): n, and 2^18 
+       with b[] on 64 bytes (bit reversal a[] -> b[]) and not */
+    err = outcheck(n, 1, 0);
+    err = MAX(err, outcheck(n, -1, 0));
+    err = MAX(err, outcheck(1 << 18, 1, 0));
+    err = MAX(err, outcheck(1 << 18, -1, 0));
+    err = MAX(err, outcheck(1 << 18, 1, 2));
+    printf("cdfto err= %g \n", err);
+
+    /* check of the bit reversed order rdft (against rdft) */
+    err = bitrevcheck(n, 1, a, b, ip, w);
+    err = MAX(err, bitrevcheck(n, -1, a, b, ip, w));
+    printf("rdftb err= %g \n", err);
+
+    /* check of the out of core versions (a file of n doubles), 
+       with the smallest and a large work area, n >= 4 */
+    j = MAX(13 * (int) (sqrt(n) + 1) + 8, 136);
+    err = 0;
+    if (n >= 4) {
+        err = MAX(ooccheck(n, 0, 1, j, a, b, t, ip, w), 
+            ooccheck(n, 0, -1, NMAX / 2, a, b, t, ip, w));
+    }
+    printf("cdftooc err= %g \n", err);
+    err = 0;
+    if (n >= 4) {
+        err = MAX(ooccheck(n, 1, 1, j, a, b, t, ip, w), 
+            ooccheck(n, 1, -1, NMAX / 2, a, b, t, ip, w));
+    }
+    printf("rdftooc err= %g \n", err);
+
+    /* check of 2D (16 x n) and 3D (4 x 8 x n) */
+    err = MAX(mdcheck(1, 16, n, 0, 1), mdcheck(1, 16, n, 0, -1));
+    printf("cdft2d err= %g \n", err);
+    err = MAX(mdcheck(1, 16, n, 1, 1), mdcheck(1, 16, n, 1, -1));
+    printf("rdft2d err= %g \n", err);
+    err = MAX(mdcheck(1, 16, n, 2, 1), mdcheck(1, 16, n, 2, -1));
+    printf("ddct2d err= %g \n", err);
+    err = MAX(mdcheck(1, 16, n, 3, 1), mdcheck(1, 16, n, 3, -1));
+    printf("ddst2d err= %g \n", err);
+    err = MAX(mdcheck(4, 8, n, 4, 1), mdcheck(4, 8, n, 4, -1));
+    printf("cdft3d err= %g \n", err);
+    err = MAX(mdcheck(4, 8, n, 5, 1), mdcheck(4, 8, n, 5, -1));
+    printf("rdft3d err= %g \n", err);
+
+    /* check of float versions (relative to the double versions) */
+    ipf[0] = 0;
+    err = floatcheck(n, 0, 1, a, t, ip, w, af, tf, ipf, wf);
+    err = MAX(err, floatcheck(n, 0, -1, a, t, ip, w, af, tf, ipf, wf));
+    printf("cdftf rel.err= %g \n", err);
+    err = floatcheck(n, 1, 1, a, t, ip, w, af, tf, ipf, wf);
+    err = MAX(err, floatcheck(n, 1, -1, a, t, ip, w, af, tf, ipf, wf));
+    printf("rdftf rel.err= %g \n", err);
+    err = floatcheck(n, 2, 1, a, t, ip, w, af, tf, ipf, wf);
+    err = MAX(err, floatcheck(n, 2, -1, a, t, ip, w, af, tf, ipf, wf));
+    printf("ddctf rel.err= %g \n", err);
+    err = floatcheck(n, 3, 1, a, t, ip, w, af, tf, ipf, wf);
+    err = MAX(err, floatcheck(n, 3, -1, a, t, ip, w, af, tf, ipf, wf));
+    printf("ddstf rel.err= %g \n", err);
+    err = floatcheck(n, 4, 1, a, t, ip, w, af, tf, ipf, wf);
+    printf("dfctf rel.err= %g \n", err);
+    err = floatcheck(n, 5, 1, a, t, ip, w, af, tf, ipf, wf);
+    printf("dfstf rel.err= %g \n", err);
+
+    return 0;
+}
+
+
+void putdata(int nini, int nend, double *a)
+{
+    int j, seed = 0;
+
+    for (j = nini; j <= nend; j++) {
+        a[j] = RND(&seed);
+    }
+}
+
+
+double diffcheck(int nini, int nend, double *a, double *b)
+{
+    int j;
+    double err = 0;
+
+    for (j = nini; j <= nend; j++) {
+        err = MAX(err, fabs(a[j] - b[j]));
+    }
+    return err;
+}
+
+
+double plancheck(struct fft_plan *p, int n, int kind, int isgn, double *a, 
+    double *b, double *t, int *ip, double *w)
+{
+    double err;
+
+    if (p == NULL) {
+        return 1;
+    }
+    putdata(0, n, a);
+    putdata(0, n, b);
+    fft_plan_exec(p, b);
+    fft_plan_destroy(p);
+    switch (kind) {
+    case 0:
+        cdft(n, isgn, a, ip, w);
+        break;
+    case 1:
+        rdft(n, isgn, a, ip, w);
+        break;
+    case 2:
+        ddct(n, isgn, a, ip, w);
+        break;
+    case 3:
+        ddst(n, isgn, a, ip, w);
+        break;
+    case 4:
+        dfct(n, a, t, ip, w);
+        break;
+    default:
+        dfst(n, a, t, ip, w);
+        break;
+    }
+    err = diffcheck(0, kind == 4 ? n : n - 1, a, b);
+    return err;
+}
+
+
+double batchcheck(struct fft_plan *p, int n, int kind, int interleave, 
+    double *a, double *b, double *t)
+{
+    int j, k, nd, nv, stride, dist;
+    double err;
+
+    if (p == NULL) {
+        return 1;
+    }
+    /* two transforms: side by side, or interleaved datum by datum */
+    nv = kind == 0 ? 2 : 1;
+    nd = kind == 0 ? n / 2 : (kind == 4 ? n + 1 : n);
+    stride = interleave ? 2 * nv : nv;
+    dist = interleave ? nv : nd * nv;
+    putdata(0, 2 * nd * nv - 1, a);
+    putdata(0, 2 * nd * nv - 1, b);
+    if (fft_plan_exec_many(p, 2, a, stride, dist) != 0) {
+        fft_plan_destroy(p);
+        return 1;
+    }
+    err = 0;
+    for (k = 0; k < 2; k++) {
+        for (j = 0; j < nd * nv; j++) {
+            t[j] = b[k * dist + j / nv * stride + j % nv];
+        }
+        fft_plan_exec(p, t);
+        for (j = 0; j < nd * nv; j++) {
+            err = MAX(err, fabs(a[k * dist + j / nv * stride + j % nv] - t[j]));
+        }
+    }
+    fft_plan_destroy(p);
+    return err;
+}
+
+
+double mixcheck(int n, int kind, int isgn, double *a, double *b)
+{
+    int j, k;
+    double err, th, xr, xi;
+    struct fft_plan *p;
+
+    p = kind == 0 ? cdft_plan_create(n, isgn) : rdft_plan_create(n, isgn);
+    if (p == NULL) {
+        return 1;
+    }
+    putdata(0, n - 1, a);
+    putdata(0, n - 1, b);
+    fft_plan_exec(p, b);
+    fft_plan_destroy(p);
+    th = (isgn >= 0 ? 8 : -8) * atan(1.0) / (kind == 0 ? n / 2 : n);
+    err = 0;
+    if (kind == 0) {
+        for (k = 0; k < n / 2; k++) {
+            xr = 0;
+            xi = 0;
+            for (j = 0; j < n / 2; j++) {
+                xr += a[2 * j] * cos(th * (j * k % (n / 2))) - 
+                    a[2 * j + 1] * sin(th * (j * k % (n / 2)));
+                xi += a[2 * j] * sin(th * (j * k % (n / 2))) + 
+                    a[2 * j + 1] * cos(th * (j * k % (n / 2)));
+            }
+            err = MAX(err, fabs(xr - b[2 * k]));
+            err = MAX(err, fabs(xi - b[2 * k + 1]));
+        }
+    } else if (isgn >= 0) {
+        for (k = 0; k <= n / 2; k++) {
+            xr = 0;
+            xi = 0;
+            for (j = 0; j < n; j++) {
+                xr += a[j] * cos(th * (j * k % n));
+                xi += a[j] * sin(th * (j * k % n));
+            }
+            err = MAX(err, fabs(xr - b[k == n / 2 ? 1 : 2 * k]));
+            if (k > 0 && k < n / 2) {
+                err = MAX(err, fabs(xi - b[2 * k + 1]));
+            }
+        }
+    } else {
+        for (k = 0; k < n; k++) {
+            xr = 0.5 * (a[0] + a[1] * (k % 2 == 0 ? 1 : -1));
+            for (j = 1; j < n / 2; j++) {
+                xr += a[2 * j] * cos(th * (j * k % n)) - 
+                    a[2 * j + 1] * sin(th * (j * k % n));
+            }
+            err = MAX(err, fabs(xr - b[k]));
+        }
+    }
+    return err;
+}
+
+
+double splitcheck(int n, int isgn, double *a, double *b, double *t, 
+    int *ip, double *w, int *ips, double *ws)
+{
+    int j;
+    double err;
+
+    putdata(0, n - 1, a);
+    for (j = 0; j < n / 2; j++) {
+        b[j] = a[2 * j];
+        t[j] = a[2 * j + 1];
+    }
+    cdft(n, isgn, a, ip, w);
+    cdfts(n / 2, isgn, b, t, ips, ws);
+    err = 0;
+    for (j = 0; j < n / 2; j++) {
+        err = MAX(err, fabs(a[2 * j] - b[j]));
+        err = MAX(err, fabs(a[2 * j + 1] - t[j]));
+    }
+    return err;
+}
+
+
+double stridecheck(int n, int kind, int isgn, double *a, double *b, 
+    double *t, int *ip, double *w)
+{
+    int j, s;
+    double err;
+
+    /* complex data 6 apart (cdft), real data 3 apart (rdft) */
+    s = kind == 0 ? 6 : 3;
+    putdata(0, n * 3 - 1, a);
+    for (j = 0; j < n; j++) {
+        b[j] = kind == 0 ? a[j / 2 * s + j % 2] : a[j * s];
+    }
+    if (kind == 0) {
+        cdft(n, isgn, b, ip, w);
+        cdftst(n, isgn, a, s, t, ip, w);
+    } else {
+        rdft(n, isgn, b, ip, w);
+        rdftst(n, isgn, a, s, t, ip, w);
+    }
+    err = 0;
+    for (j = 0; j < n; j++) {
+        err = MAX(err, fabs(b[j] - (kind == 0 ? a[j / 2 * s + j % 2] : a[j * s])));
+    }
+    return err;
+}
+
+
+double ooccheck(int n, int kind, int isgn, int nt, double *a, double *b, 
+    double *t, int *ip, double *w)
+{
+    FILE *fp;
+    int ret;
+
+    fp = tmpfile();
+    if (fp == NULL) {
+        return 0;
+    }
+    putdata(0, n - 1, a);
+    ret = (int) fwrite(a, sizeof(double), n, fp) != n;
+    if (kind == 0) {
+        ret |= cdftooc(n, isgn, fp, nt, t, ip, w);
+    } else {
+        ret |= rdftooc(n, isgn, fp, nt, t, ip, w);
+    }
+    rewind(fp);
+    ret |= (int) fread(a, sizeof(double), n, fp) != n;
+    fclose(fp);
+    if (ret != 0) {
+        printf("ooccheck: I/O error or nt too small\n");
+        return 1;
+    }
+    putdata(0, n - 1, b);
+    if (kind == 0) {
+        cdft(n, isgn, b, ip, w);
+    } else {
+        rdft(n, isgn, b, ip, w);
+    }
+    return diffcheck(0, n - 1, a, b);
+}
+
+
+double outcheck(int n, int isgn, int offset)
+{
+    int *ip;
+    double *mem, *a, *b, *c, *w, err;
+
+    /* a[], b[], c[] on 64 bytes, b[] offset doubles after that */
+    ip = (int *) malloc(sizeof(int) * ((int) sqrt(n / 2) + 2));
+    mem = (double *) malloc(sizeof(double) * (3 * n + offset + 8));
+    w = (double *) malloc(sizeof(double) * (n / 2));
+    if (ip == NULL || mem == NULL || w == NULL) {
+        printf("outcheck: out of memory\n");
+        free(ip);
+        free(mem);
+        free(w);
+        return 1;
+    }
+    a = (double *) (((size_t) mem + 63) & ~((size_t) 63));
+    c = a + n;
+    b = c + n + offset;
+    ip[0] = 0;
+    putdata(0, n - 1, a);
+    putdata(0, n - 1, c);
+    cdfto(n, isgn, a, b, ip, w);
+    cdft(n, isgn, c, ip, w);
+    err = diffcheck(0, n - 1, b, c);
+    free(ip);
+    free(mem);
+    free(w);
+    return err;
+}
+
+
+double bitrevcheck(int n, int isgn, double *a, double *b, int *ip, 
+    double *w)
+{
+    int j, k, l;
+    double err;
+
+    putdata(0, n - 1, b);
+    /* a[2*j], a[2*j+1] <-> b[2*k], b[2*k+1], k: bit reverse of j */
+    k = 0;
+    for (j = 0; j < n / 2; j++) {
+        a[2 * j] = b[2 * k];
+        a[2 * j + 1] = b[2 * k + 1];
+        l = n >> 2;
+        while ((k & l) != 0) {
+            k ^= l;
+            l >>= 1;
+        }
+        k |= l;
+    }
+    if (isgn >= 0) {
+        putdata(0, n - 1, a);
+    }
+    rdftb(n, isgn, a, ip, w);
+    rdft(n, isgn, b, ip, w);
+    err = 0;
+    k = 0;
+    for (j = 0; j < n / 2; j++) {
+        if (isgn >= 0) {
+            err = MAX(err, fabs(a[2 * j] - b[2 * k]));
+            err = MAX(err, fabs(a[2 * j + 1] - b[2 * k + 1]));
+        } else {
+            err = MAX(err, fabs(a[2 * j] - b[2 * j]));
+            err = MAX(err, fabs(a[2 * j + 1] - b[2 * j + 1]));
+        }
+        l = n >> 2;
+        while ((k & l) != 0) {
+            k ^= l;
+            l >>= 1;
+        }
+        k |= l;
+    }
+    return err;
+}
+
+
+double mdcheck(int n1, int n2, int n3, int kind, int isgn)
+{
+    int i, j, k, j1, j2, nn, nm, seed = 0, *ip;
+    double err, *a, *r, *z, *t, **a2, ***a3, *x, *y, *w;
+
+    /* kind 0...3: cdft2d, rdft2d, ddct2d, ddst2d on n2 x n3, 
+       kind 4, 5: cdft3d, rdft3d on n1 x n2 x n3 */
+    nn = n1 * n2 * n3;
+    a = (double *) malloc(sizeof(double) * nn);
+    r = (double *) malloc(sizeof(double) * nn * 2);
+    z = (double *) malloc(sizeof(double) * nn * 2);
+    t = (double *) malloc(sizeof(double) * 8 * (n3 + n2 + n1));
+    a2 = (double **) malloc(sizeof(double *) * n1 * n2);
+    a3 = (double ***) malloc(sizeof(double **) * n1);
+    /* own table: the longest transform is 2 * (largest dimension) 
+       (the references cdft 2 * n3 and cdftst 2 * n2), 
+       and ddct2d puts its table after that one */
+    nm = MAX(MAX(n1, n2), n3);
+    ip = (int *) malloc(sizeof(int) * (3 + (int) sqrt(2.0 * nm)));
+    w = (double *) malloc(sizeof(double) * nm * 5 / 2);
+    if (a == NULL || r == NULL || z == NULL || t == NULL || 
+        a2 == NULL || a3 == NULL || ip == NULL || w == NULL) {
+        return 1;
+    }
+    ip[0] = 0;
+    for (i = 0; i < n1 * n2; i++) {
+        a2[i] = &a[i * n3];
+    }
+    for (i = 0; i < n1; i++) {
+        a3[i] = &a2[i * n2];
+    }
+    for (i = 0; i < nn; i++) {
+        a[i] = RND(&seed);
+        r[i] = a[i];
+    }
+    switch (kind) {
+    case 0:
+        cdft2d(n2, n3, isgn, a2, t, ip, w);
+        cdftref(1, n2, n3, isgn, r, t, ip, w);
+        break;
+    case 2:
+    case 3:
+        if (kind == 2) {
+            ddct2d(n2, n3, isgn, a2, t, ip, w);
+        } else {
+            ddst2d(n2, n3, isgn, a2, t, ip, w);
+        }
+        for (i = 0; i < n2; i++) {
+            if (kind == 2) {
+                ddct(n3, isgn, &r[i * n3], ip, w);
+            } else {
+                ddst(n3, isgn, &r[i * n3], ip, w);
+            }
+        }
+        for (j = 0; j < n3; j++) {
+            for (i = 0; i < n2; i++) {
+                t[i] = r[i * n3 + j];
+            }
+            if (kind == 2) {
+                ddct(n2, isgn, t, ip, w);
+            } else {
+                ddst(n2, isgn, t, ip, w);
+            }
+            for (i = 0; i < n2; i++) {
+                r[i * n3 + j] = t[i];
+            }
+        }
+        break;
+    case 4:
+        cdft3d(n1, n2, n3, isgn, a3, t, ip, w);
+        cdftref(n1, n2, n3, isgn, r, t, ip, w);
+        break;
+    default:
+        if (kind == 1) {
+            n1 = n2;
+            n2 = 1;
+        }
+        if (isgn < 0) {
+            /* inverse of the forward transform */
+            if (n2 == 1) {
+                rdft2d(n1, n3, 1, a2, t, ip, w);
+                rdft2d(n1, n3, -1, a2, t, ip, w);
+            } else {
+                rdft3d(n1, n2, n3, 1, a3, t, ip, w);
+                rdft3d(n1, n2, n3, -1, a3, t, ip, w);
+            }
+            for (i = 0; i < nn; i++) {
+                r[i] *= 0.5 * nn;
+            }
+            break;
+        }
+        if (n2 == 1) {
+            rdft2d(n1, n3, 1, a2, t, ip, w);
+        } else {
+            rdft3d(n1, n2, n3, 1, a3, t, ip, w);
+        }
+        /* the complex DFT of the real data, packed as rdft3d */
+        for (i = 0; i < nn; i++) {
+            z[2 * i] = r[i];
+            z[2 * i + 1] = 0;
+        }
+        cdftref(n1, n2, 2 * n3, 1, z, t, ip, w);
+        for (i = 0; i < n1 * n2; i++) {
+            x = &r[i * n3];
+            y = &z[i * 2 * n3];
+            for (k = 2; k < n3; k++) {
+                x[k] = y[k];
+            }
+            j1 = (n1 - i / n2) & (n1 - 1);
+            j2 = (n2 - i % n2) & (n2 - 1);
+            j = j1 * n2 + j2;
+            if (j == i) {
+                x[0] = y[0];
+                x[1] = y[n3];
+            } else if (j > i) {
+                x[0] = y[0];
+                x[1] = y[1];
+                r[j * n3 + 1] = y[n3];
+                r[j * n3] = -y[n3 + 1];
+            }
+        }
+        break;
+    }
+    err = 0;
+    for (i = 0; i < nn; i++) {
+        err = MAX(err, fabs(a[i] - r[i]));
+    }
+    free(w);
+    free(ip);
+    free(a3);
+    free(a2);
+    free(t);
+    free(z);
+    free(r);
+    free(a);
+    return err;
+}
+
+
+void cdftref(int n1, int n2, int n3, int isgn, double *r, double *t, 
+    int *ip, double *w)
+{
+    int i, j;
+
+    /* cdft along each axis of r[n1][n2][n3] */
+    for (i = 0; i < n1 * n2; i++) {
+        cdft(n3, isgn, &r[i * n3], ip, w);
+    }
+    for (i = 0; i < n1; i++) {
+        for (j = 0; j < n3; j += 2) {
+            cdftst(2 * n2, isgn, &r[i * n2 * n3 + j], n3, t, ip, w);
+        }
+    }
+    for (j = 0; j < n2 * n3; j += 2) {
+        cdftst(2 * n1, isgn, &r[j], n2 * n3, t, ip, w);
+    }
+}
+
+
+double floatcheck(int n, int kind, int isgn, double *a, double *t, 
+    int *ip, double *w, float *af, float *tf, int *ipf, float *wf)
+{
+    int j;
+    double err, amax;
+
+    putdata(0, n, a);
+    for (j = 0; j <= n; j++) {
+        af[j] = (float) a[j];
+    }
+    switch (kind) {
+    case 0:
+        cdft(n, isgn, a, ip, w);
+        cdftf(n, isgn, af, ipf, wf);
+        break;
+    case 1:
+        rdft(n, isgn, a, ip, w);
+        rdftf(n, isgn, af, ipf, wf);
+        break;
+    case 2:
+        ddct(n, isgn, a, ip, w);
+        ddctf(n, isgn, af, ipf, wf);
+        break;
+    case 3:
+        ddst(n, isgn, a, ip, w);
+        ddstf(n, isgn, af, ipf, wf);
+        break;
+    case 4:
+        dfct(n, a, t, ip, w);
+        dfctf(n, af, tf, ipf, wf);
+        break;
+    default:
+        dfst(n, a, t, ip, w);
+        dfstf(n, af, tf, ipf, wf);
+        break;
+    }
+    err = 0;
+    amax = 0;
+    for (j = 0; j <= (kind == 4 ? n : n - 1); j++) {
+        err = MAX(err, fabs(a[j] - af[j]));
+        amax = MAX(amax, fabs(a[j]));
+    }
+    return amax > 0 ? err / amax : err;
+}
@@ -11,6 +11,20 @@ Example compilation:
     Microsoft: cl /O2 /G6 pi_fft.c fft4g.c /Fepi_fft4g.exe
     ...
     etc.
+
+Usage:
+    pi_fftsg nfft [ntt] [bin] : PI by FFTs of length nfft (>= 128) in pi.dat
+    pi_fftsg mt [ntt] [bin]   : benchmark of mt (< 128) threads
+    With "ntt", the multiplications are exact number theoretic
+    transforms (three primes, CRT) instead of rdft: the radix is
+    then 10^9 (nfft <= 2^26), not limited by the rounding errors.
+    With "bin", the radix is the largest 2^k (<= 2^29) passing the
+    error test at the radix itself (the digits are balanced by
+    mp_mul_i2d), so more digits are packed per FFT element; the
+    result is converted to decimal by mp_bin2dec only for pi.dat.
+    PI of nfft is computed with the additions, subtractions and 
+    divisions by integers split over the processors (or over 
+    MP_MAX_THREADS threads); the benchmark keeps them serial.
 */
 
 /* Please check the following macros before compiling */
@@ -18,6 +32,12 @@ Example compilation:
 #define DBL_ERROR_MARGIN 0.3  /* must be < 0.5 */
 #endif
 
+/* fftsg.c only: the spectra are multiplied element by element, 
+   so they can be left in the bit reversed order of rdftb */
+#ifdef USE_RDFTB
+#define rdft rdftb
+#endif
+
 
 #include <math.h>
 #include <limits.h>
@@ -71,6 +91,26 @@ float get_time() {
     }
 }
 
+/* work area of one transform of mp_mul: d[nfft + 2] for the rdft, 
+   or (mp_ntt_init) the header hd[2] and the residues a[3 * nfft] 
+   of the NTT; only the part of the backend in use is allocated */
+struct mp_mul_buf {
+    double *d;
+    long long hd[2];
+    unsigned int *a;
+};
+
+/* operand in[] (digits from in[shift + 2], shift = 0: upper part) 
+   with its spectrum *fft of length nfft: the spectrum is reused, 
+   not transformed again, while in[] is not changed (in = NULL: none) */
+struct mp_fft {
+    int *in;
+    int shift;
+    int nfft;
+    struct mp_mul_buf *fft;
+};
+
+int mp_threads_init(int nthread);
 void mp_load_0(int n, int radix, int out[]);
 void mp_load_1(int n, int radix, int out[]);
 void mp_copy(int n, int radix, int in[], int out[]);
@@ -83,26 +123,40 @@ int mp_idiv(int n, int radix, int in1[], int in2, int out[]);
 void mp_idiv_2(int n, int radix, int in[], int out[]);
 double mp_mul_radix_test(int n, int radix, int nfft, 
         double tmpfft[], int ip[], double w[]);
-void mp_mul(int n, int radix, int in1[], int in2[], int out[], 
-        int tmp[], int nfft, double tmp1fft[], double tmp2fft[], 
-        double tmp3fft[], int ip[], double w[]);
+int mp_ntt_init(int nfft);
+int mp_mul_buf_alloc(struct mp_mul_buf *b, int nfft, int ntt);
+void mp_mul_buf_free(struct mp_mul_buf *b);
+double mp_ntt_radix_test(int nfft, int radix);
+void mp_mul(int n, int radix, int in1[], int in2[], int out[], int tmp[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+        struct mp_mul_buf *tmp3fft, int ip[], double w[]);
 void mp_squ(int n, int radix, int in[], int out[], int tmp[], 
-        int nfft, double tmp1fft[], double tmp2fft[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
         int ip[], double w[]);
 void mp_mulh(int n, int radix, int in1[], int in2[], int out[], 
-        int nfft, double in1fft[], double outfft[], 
+        int nfft, struct mp_mul_buf *in1fft, struct mp_mul_buf *outfft, 
         int ip[], double w[]);
 void mp_squh(int n, int radix, int in[], int out[], 
-        int nfft, double inoutfft[], int ip[], double w[]);
-int mp_inv(int n, int radix, int in[], int out[], 
-        int tmp1[], int tmp2[], int nfft, 
-        double tmp1fft[], double tmp2fft[], int ip[], double w[]);
-int mp_sqrt(int n, int radix, int in[], int out[], 
-        int tmp1[], int tmp2[], int nfft, 
-        double tmp1fft[], double tmp2fft[], int ip[], double w[]);
+        int nfft, struct mp_mul_buf *inoutfft, int ip[], double w[]);
+void mp_mul_fft(int n, int radix, int in1[], int in2[], struct mp_fft *h2, 
+        int out[], int tmp[], int nfft, struct mp_mul_buf *tmp1fft, 
+        struct mp_mul_buf *tmp3fft, int ip[], double w[]);
+void mp_squ_fft(int n, int radix, int in[], struct mp_fft *h, 
+        int out[], int tmp[], int nfft, struct mp_mul_buf *tmp2fft, 
+        int ip[], double w[]);
+int mp_inv(int n, int radix, int in[], int out[], int tmp1[], int tmp2[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+        int ip[], double w[]);
+int mp_sqrt(int n, int radix, int in[], int out[], int tmp1[], int tmp2[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+        int ip[], double w[]);
 void mp_sprintf(int n, int log10_radix, int in[], char out[]);
 void mp_sscanf(int n, int log10_radix, char in[], int out[]);
 void mp_fprintf(int n, int log10_radix, int in[], FILE *fout);
+int mp_bin2dec(int n, int radix, int in[], int n_dec, int log10_radix, 
+        int out[], int tmp[], int nfft, struct mp_mul_buf *tmp1fft, 
+        struct mp_mul_buf *tmp2fft, struct mp_mul_buf *tmp3fft, int ip[], 
+        double w[]);
 
 float base_indices[] = {
       0.0,   // 0
@@ -190,11 +244,13 @@ int is_done()
 }
 
 
-int mp_pi(int nfft, int radix, int log10_radix, int do_print,
+int mp_pi(int nfft, int radix, int do_print,
            int *a, int *b, int *c, int *e, int *i1, int *i2, int *ip,
-           double *d1, double *d2, double *d3, double *w, int after_time)
+           struct mp_mul_buf *d1, struct mp_mul_buf *d2, 
+           struct mp_mul_buf *d3, double *w, int after_time)
 {
     int n, npow, nprc;
+    struct mp_fft ha = {NULL, 0, 0, NULL};
     
     if (do_print) {
         printf("PI calculation to estimate the FFT benchmarks\n");
@@ -247,16 +303,19 @@ int mp_pi(int nfft, int radix, int log10_radix, int do_print,
      *      98-HPC-74, 1998.
      */
     /* ---- c = sqrt(0.125) ---- */
-    mp_sscanf(n, log10_radix, "0.125", a);
+    mp_load_1(n, radix, a);
+    mp_idiv(n, radix, a, 8, a);
     mp_sqrt(n, radix, a, c, i1, i2, nfft, d1, d2, ip, w);
     /* ---- a = 1 + 3 * c ---- */
     mp_imul(n, radix, c, 3, e);
-    mp_sscanf(n, log10_radix, "1", a);
+    mp_load_1(n, radix, a);
     mp_add(n, radix, a, e, a);
     /* ---- b = sqrt(a) ---- */
     mp_sqrt(n, radix, a, b, i1, i2, nfft, d1, d2, ip, w);
     /* ---- e = b - 0.625 ---- */
-    mp_sscanf(n, log10_radix, "0.625", e);
+    mp_load_1(n, radix, e);
+    mp_imul(n, radix, e, 5, e);
+    mp_idiv(n, radix, e, 8, e);
     mp_sub(n, radix, b, e, e);
     /* ---- b = 2 * b ---- */
     mp_add(n, radix, b, b, b);
@@ -295,7 +354,8 @@ int mp_pi(int nfft, int radix, int log10_radix, int do_print,
             nprc = n;
         }
         if (do_print) {
-            printf("precision= %d\n", 4 * nprc * log10_radix);
+            printf("precision= %d\n", 
+                    (int) (4 * nprc * log10((double) radix) + 0.5));
         }
         if (after_time) {
             if (is_done()) {
@@ -309,10 +369,12 @@ int mp_pi(int nfft, int radix, int log10_radix, int do_print,
     /* ---- a = a + b ---- */
     mp_add(n, radix, a, b, a);
     /* ---- a = (a * a - e - e / 2) / (a * c - e) / npow ---- */
-    mp_mul(n, radix, a, c, c, i1, nfft, d1, d2, d3, ip, w);
+    /*      (the spectrum of (upper) a is used for c and a) */
+    ha.fft = d2;
+    mp_mul_fft(n, radix, c, a, &ha, c, i1, nfft, d1, d3, ip, w);
+    mp_squ_fft(n, radix, a, &ha, a, i1, nfft, d3, ip, w);
     mp_sub(n, radix, c, e, c);
     mp_inv(n, radix, c, b, i1, i2, nfft, d1, d2, ip, w);
-    mp_squ(n, radix, a, a, i1, nfft, d1, d2, ip, w);
     mp_sub(n, radix, a, e, a);
     mp_idiv_2(n, radix, e, e);
     mp_sub(n, radix, a, e, a);
@@ -325,8 +387,9 @@ struct pi_context {
     int nfft;
     int log2_nfft;
     int radix;
-    int log10_radix;
+    int log10_radix;    /* 0: radix is a power of 2 */
     int do_print;
+    int ntt;
     int *a;
     int *b;
     int *c;
@@ -334,10 +397,11 @@ struct pi_context {
     int *i1;
     int *i2;
     int *ip;
-    double *d1;
-    double *d2;
-    double *d3;
+    struct mp_mul_buf d1;
+    struct mp_mul_buf d2;
+    struct mp_mul_buf d3;
     double *w;
+    int own_table;
     int run_cnt;
     float duration;
     pthread_t thread;
@@ -345,45 +409,88 @@ struct pi_context {
 };
 
 
-void pi_context_alloc(struct pi_context *ctx, int nfft)
+/*
+  The cos/sin table (ip, w) is written by rdft() only when a larger
+  transform than before is requested.  Once pi_context_init() has run
+  the radix test at nfft, no rdft() of the context rewrites it, so
+  copies of the context share it read-only instead of keeping their own.
+*/
+void pi_context_alloc(struct pi_context *ctx, int nfft, struct pi_context *share)
 {
     int n;
     n = nfft + 2;
     ctx->nfft = nfft;
-    ctx->ip = (int *) malloc((3 + (int) sqrt(0.5 * nfft)) * sizeof(int));
-    ctx->w = (double *) malloc(nfft / 2 * sizeof(double));
+    if (share == NULL) {
+        ctx->ip = (int *) malloc((3 + (int) sqrt(0.5 * nfft)) * sizeof(int));
+        ctx->w = (double *) malloc(nfft / 2 * sizeof(double));
+        ctx->own_table = 1;
+    } else {
+        ctx->ip = share->ip;
+        ctx->w = share->w;
+        ctx->own_table = 0;
+    }
     ctx->a = (int *) malloc((n + 2) * sizeof(int));
     ctx->b = (int *) malloc((n + 2) * sizeof(int));
     ctx->c = (int *) malloc((n + 2) * sizeof(int));
     ctx->e = (int *) malloc((n + 2) * sizeof(int));
     ctx->i1 = (int *) malloc((n + 2) * sizeof(int));
     ctx->i2 = (int *) malloc((n + 2) * sizeof(int));
-    ctx->d1 = (double *) malloc((nfft + 2) * sizeof(double));
-    ctx->d2 = (double *) malloc((nfft + 2) * sizeof(double));
-    ctx->d3 = (double *) malloc((nfft + 2) * sizeof(double));
-    if (ctx->d3 == NULL) {
+    if (mp_mul_buf_alloc(&ctx->d1, nfft, ctx->ntt) != 0 || 
+        mp_mul_buf_alloc(&ctx->d2, nfft, ctx->ntt) != 0 || 
+        mp_mul_buf_alloc(&ctx->d3, nfft, ctx->ntt) != 0 || 
+        ctx->w == NULL) {
         printf("Allocation Failure!\n");
         exit(1);
     }
-    ctx->ip[0] = 0;
-   
+    if (share == NULL) {
+        ctx->ip[0] = 0;
+    }
 }
 
-void pi_context_init(struct pi_context *ctx, int nfft, int do_print)
+void pi_context_init(struct pi_context *ctx, int nfft, int do_print, int ntt, 
+        int bin)
 {
     int n;
-    double err;
+    double err, margin;
     for (ctx->log2_nfft = 1; (1 << ctx->log2_nfft) < nfft; ctx->log2_nfft++);
     ctx->nfft = 1 << ctx->log2_nfft;
     n = nfft + 2;
     ctx->do_print = do_print;
-    ctx->log10_radix = 1;
-    ctx->radix = 10;
-    pi_context_alloc(ctx, nfft);
+    ctx->ntt = ntt;
+    ctx->log10_radix = bin ? 0 : 1;
+    ctx->radix = bin ? 2 : 10;
+    pi_context_alloc(ctx, nfft, NULL);
+    if (mp_ntt_init(ntt ? nfft : 0) != 0) {
+        printf("NTT Length Failure (nfft > 2^26)!\n");
+        exit(1);
+    }
     // radix test
-    err = mp_mul_radix_test(nfft+2, ctx->radix, nfft, ctx->d1, ctx->ip, ctx->w);
-    err += DBL_EPSILON * (n * ctx->radix * ctx->radix / 4);
-    while (100 * err < DBL_ERROR_MARGIN && ctx->radix <= INT_MAX / 20) {
+    if (ntt) {
+        /* exact while the convolution is below p0*p1*p2/2 */
+        err = mp_ntt_radix_test(nfft, ctx->radix);
+        margin = 1;
+    } else {
+        err = mp_mul_radix_test(nfft+2, ctx->radix, nfft, ctx->d1.d, ctx->ip, ctx->w);
+        err += DBL_EPSILON * (n * ctx->radix * ctx->radix / 4);
+        margin = DBL_ERROR_MARGIN;
+    }
+    if (bin) {
+        /* radix 2^k (<= 2^29, mp_add stays below INT_MAX): the error, 
+           extrapolated as radix^2, is checked at the radix itself */
+        while (4 * err < margin && ctx->radix <= INT_MAX / 4) {
+            err *= 4;
+            ctx->radix *= 2;
+        }
+        while (!ntt && ctx->radix > 2) {
+            err = mp_mul_radix_test(nfft+2, ctx->radix, nfft, ctx->d1.d, ctx->ip, ctx->w);
+            err += DBL_EPSILON * n * ((double) ctx->radix * ctx->radix / 4);
+            if (err < margin) {
+                break;
+            }
+            ctx->radix /= 2;
+        }
+    }
+    while (!bin && 100 * err < margin && ctx->radix <= INT_MAX / 20) {
         err *= 100;
         ctx->log10_radix++;
         ctx->radix *= 10;
@@ -400,43 +507,81 @@ void pi_context_copy(struct pi_context *dst, struct pi_context *src)
     dst->radix = src->radix;
     dst->log10_radix = src->log10_radix;
     dst->do_print = src->do_print;
-    pi_context_alloc(dst, src->nfft);
+    dst->ntt = src->ntt;
+    pi_context_alloc(dst, src->nfft, src);
 }
 
 void pi_context_free(struct pi_context *ctx)
 {
-    free(ctx->d3);
-    free(ctx->d2);
-    free(ctx->d1);
+    mp_mul_buf_free(&ctx->d3);
+    mp_mul_buf_free(&ctx->d2);
+    mp_mul_buf_free(&ctx->d1);
     free(ctx->i2);
     free(ctx->i1);
     free(ctx->e);
     free(ctx->c);
     free(ctx->b);
     free(ctx->a);
-    free(ctx->w);
-    free(ctx->ip);
+    if (ctx->own_table) {
+        free(ctx->w);
+        free(ctx->ip);
+    }
 }
 
 int pi_context_run(struct pi_context *ctx, int after_time)
 {
-    return mp_pi(ctx->nfft, ctx->radix, ctx->log10_radix, ctx->do_print,
+    return mp_pi(ctx->nfft, ctx->radix, ctx->do_print,
           ctx->a, ctx->b, ctx->c, ctx->e, ctx->i1, ctx->i2, ctx->ip,
-          ctx->d1, ctx->d2, ctx->d3, ctx->w, after_time);
+          &ctx->d1, &ctx->d2, &ctx->d3, ctx->w, after_time);
 }
 
-void run_mp_pi(int nfft, int do_print)
+void run_mp_pi(int nfft, int do_print, int ntt, int bin)
 {
-    struct pi_context ctx;
+    struct pi_context ctx, dec;
+    int n_dec, nfft_dec;
+    double digits;
 
-    pi_context_init(&ctx, nfft, do_print);
+    /* ---- mp_add etc. of one PI on all processors ---- */
+    if (mp_threads_init(0) != 0) {
+        printf("PThread Create Failure!\n");
+        exit(1);
+    }
+    pi_context_init(&ctx, nfft, do_print, ntt, bin);
     pi_context_run(&ctx, 0);
 
     /* ---- output ---- */
     if (do_print) {
-        FILE *f_out = fopen("pi.dat", "w");
+        FILE *f_out;
+        if (bin) {
+            /* radix 2^k -> 10^log10_radix by FFTs of nfft_dec >= n_dec */
+            digits = (nfft + 1) * log10((double) ctx.radix);
+            nfft_dec = nfft;
+            for (;;) {
+                pi_context_init(&dec, nfft_dec, 0, ntt, 0);
+                n_dec = (int) (digits / dec.log10_radix);
+                if (n_dec <= nfft_dec) {
+                    break;
+                }
+                pi_context_free(&dec);
+                nfft_dec *= 2;
+            }
+            printf("converting to radix=%d (length of FFT =%d)...\n", 
+                    dec.radix, nfft_dec);
+            if (mp_bin2dec(nfft + 1, ctx.radix, ctx.a, 
+                    n_dec, dec.log10_radix, dec.a, dec.i1, nfft_dec, 
+                    &dec.d1, &dec.d2, &dec.d3, dec.ip, dec.w) != 0) {
+                printf("Allocation Failure!\n");
+                exit(1);
+            }
+        }
+        f_out = fopen("pi.dat", "w");
         printf("writing pi.dat...\n");
-        mp_fprintf(ctx.nfft+1, ctx.log10_radix, ctx.a, f_out);
+        if (bin) {
+            mp_fprintf(n_dec, dec.log10_radix, dec.a, f_out);
+            pi_context_free(&dec);
+        } else {
+            mp_fprintf(ctx.nfft+1, ctx.log10_radix, ctx.a, f_out);
+        }
         fprintf(f_out, "\n");
         fclose(f_out);
     }
@@ -498,7 +643,7 @@ void mp_pi_bench_new_thread(struct pi_context *ctx)
 }
 
 
-void benchmark_mp_pi(int nfft, int mt)
+void benchmark_mp_pi(int nfft, int mt, int ntt, int bin)
 {
     struct pi_context *ctx;
     double n_op;
@@ -508,7 +653,7 @@ void benchmark_mp_pi(int nfft, int mt)
 
     ctx = (struct pi_context*) malloc(sizeof(struct pi_context)*mt);
 
-    pi_context_init(&ctx[0], nfft, 0);
+    pi_context_init(&ctx[0], nfft, 0, ntt, bin);
 
     if (mt > 1) {
         for (i = 1; i < mt; i++) {
@@ -551,16 +696,23 @@ void benchmark_mp_pi(int nfft, int mt)
 
 int main(int argc, char** argv)
 {
-    int nfft, arg1 = 1;
+    int nfft, arg1 = 1, ntt = 0, bin = 0, i;
     if (argc > 1) {
         arg1 = atoi(argv[1]);
     }
+    for (i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "ntt") == 0) {
+            ntt = 1;
+        } else if (strcmp(argv[i], "bin") == 0) {
+            bin = 1;
+        }
+    }
     if (arg1 >= 128) {
-        run_mp_pi(arg1, 1);
+        run_mp_pi(arg1, 1, ntt, bin);
     } else {
         printf("mt  nfft   run_cnt     nops  duration     rate     mflops   index\n");
         for (nfft = 512; nfft <= 2097152; nfft*=2) {
-            benchmark_mp_pi(nfft, arg1);
+            benchmark_mp_pi(nfft, arg1, ntt, bin);
         }
     }
 
@@ -581,7 +733,32 @@ int main(int argc, char** argv)
     data[0]       : sign (1;data>0, -1;data<0, 0;data==0)
     data[1]       : exponent (0;data==0)
     data[2...n+1] : digits
+   ---- work areas (struct mp_mul_buf) ----
+    struct mp_mul_buf b;
+    mp_mul_buf_alloc(&b, nfft, ntt);
+        -- tmp1fft, ... of the mp_mul routines: nfft + 2 doubles of 
+           the rdft, or (ntt != 0, mp_ntt_init(nfft)) the residues 
+           of the NTT; returns -1 if out of memory
+    mp_mul_buf_free(&b);
+   ---- transformed operand (struct mp_fft h) ----
+    struct mp_fft h = {NULL, 0, 0, NULL};
+    h.fft = (work area as tmp1fft);
+        -- no spectrum yet
+    mp_mul_fft(n, radix, in1, in2, &h, out, ...);
+        -- h.fft = spectrum of (upper) in2, kept after the call
+    mp_squ_fft(n, radix, in2, &h, out, ...);
+        -- in2 is not transformed again (h.fft is used up)
+    The spectrum is valid while in2[] is not changed; 
+    out[] must not be in2[] if h is used again.
+   ---- threads ----
+    mp_threads_init(nthread);
+        -- mp_add, mp_sub, mp_imul, mp_idiv, mp_idiv_2 of more than 
+           MP_THREADS_CHUNK_N digits run on up to nthread threads 
+           (0: MP_MAX_THREADS in the environment, or the number of 
+           processors; 1: no threads); do not call mp routines 
+           from two threads at once after this
    ---- function prototypes ----
+    int mp_threads_init(int nthread);
     void mp_load_0(int n, int radix, int out[]);
     void mp_load_1(int n, int radix, int out[]);
     void mp_copy(int n, int radix, int in[], int out[]);
@@ -594,30 +771,238 @@ int main(int argc, char** argv)
     void mp_idiv_2(int n, int radix, int in[], int out[]);
     double mp_mul_radix_test(int n, int radix, int nfft, 
             double tmpfft[], int ip[], double w[]);
-    void mp_mul(int n, int radix, int in1[], int in2[], int out[], 
-            int tmp[], int nfft, double tmp1fft[], double tmp2fft[], 
-            double tmp3fft[], int ip[], double w[]);
+    int mp_ntt_init(int nfft);
+    int mp_mul_buf_alloc(struct mp_mul_buf *b, int nfft, int ntt);
+    void mp_mul_buf_free(struct mp_mul_buf *b);
+    double mp_ntt_radix_test(int nfft, int radix);
+    void mp_mul(int n, int radix, int in1[], int in2[], int out[], int tmp[], 
+            int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+            struct mp_mul_buf *tmp3fft, int ip[], double w[]);
     void mp_squ(int n, int radix, int in[], int out[], int tmp[], 
-            int nfft, double tmp1fft[], double tmp2fft[], 
+            int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
             int ip[], double w[]);
     void mp_mulh(int n, int radix, int in1[], int in2[], int out[], 
-            int nfft, double in1fft[], double outfft[], 
+            int nfft, struct mp_mul_buf *in1fft, struct mp_mul_buf *outfft, 
             int ip[], double w[]);
     void mp_squh(int n, int radix, int in[], int out[], 
-            int nfft, double inoutfft[], int ip[], double w[]);
-    int mp_inv(int n, int radix, int in[], int out[], 
-            int tmp1[], int tmp2[], int nfft, 
-            double tmp1fft[], double tmp2fft[], int ip[], double w[]);
-    int mp_sqrt(int n, int radix, int in[], int out[], 
-            int tmp1[], int tmp2[], int nfft, 
-            double tmp1fft[], double tmp2fft[], int ip[], double w[]);
+            int nfft, struct mp_mul_buf *inoutfft, int ip[], double w[]);
+    void mp_mul_fft(int n, int radix, int in1[], int in2[], struct mp_fft *h2, 
+            int out[], int tmp[], int nfft, struct mp_mul_buf *tmp1fft, 
+            struct mp_mul_buf *tmp3fft, int ip[], double w[]);
+    void mp_squ_fft(int n, int radix, int in[], struct mp_fft *h, 
+            int out[], int tmp[], int nfft, struct mp_mul_buf *tmp2fft, 
+            int ip[], double w[]);
+    int mp_inv(int n, int radix, int in[], int out[], int tmp1[], int tmp2[], 
+            int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+            int ip[], double w[]);
+    int mp_sqrt(int n, int radix, int in[], int out[], int tmp1[], int tmp2[], 
+            int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+            int ip[], double w[]);
     void mp_sprintf(int n, int log10_radix, int in[], char out[]);
     void mp_sscanf(int n, int log10_radix, char in[], int out[]);
     void mp_fprintf(int n, int log10_radix, int in[], FILE *fout);
+    int mp_bin2dec(int n, int radix, int in[], int n_dec, int log10_radix, 
+            int out[], int tmp[], int nfft, struct mp_mul_buf *tmp1fft, 
+            struct mp_mul_buf *tmp2fft, struct mp_mul_buf *tmp3fft, int ip[], 
+            double w[]);
    ----
 */
 
 
+/* -------- mp_threads routines -------- */
+
+
+/* mp_add, mp_sub, mp_imul, mp_idiv, mp_idiv_2: the digits are split 
+   into ranges of at least MP_THREADS_CHUNK_N digits, one per thread; 
+   the carries between the ranges are resolved afterwards */
+#ifndef MP_THREADS_CHUNK_N
+#define MP_THREADS_CHUNK_N 16384
+#endif
+#define MP_THREADS_MAX 64
+#define MP_THREADS_EDGE 4  /* digits read across a range boundary */
+
+
+/* ---- worker threads (mp_threads_init), nthread == 1: none ---- */
+struct mp_thread_table {
+    int nthread;
+    int nstart;
+    int job;
+    int nbusy;
+    int nchunk;
+    void (*func)(void *arg, int k);
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+} mp_threads = {
+    1, 1, 0, 0, 0, NULL, NULL, PTHREAD_MUTEX_INITIALIZER, 
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER
+};
+
+
+/* ---- digits j0...j1-1 of one operation in nchunk ranges ---- */
+struct mp_thread_job {
+    int nchunk;
+    int j0;
+    int j1;
+    int radix;
+    int expdif;
+    int shift;
+    double dradix;
+    double din2;
+    int *in1;
+    int *in2;
+    int *out;
+    int carry[MP_THREADS_MAX];
+    int edge[MP_THREADS_MAX][MP_THREADS_EDGE];
+};
+
+
+int mp_threads_init(int nthread)
+{
+    void *mp_threads_worker(void *arg);
+    pthread_t thread;
+    char *s;
+    
+    if (nthread <= 0) {
+        s = getenv("MP_MAX_THREADS");
+        nthread = s != NULL ? atoi(s) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (nthread > MP_THREADS_MAX) {
+        nthread = MP_THREADS_MAX;
+    }
+    if (nthread < 1) {
+        nthread = 1;
+    }
+    pthread_mutex_lock(&mp_threads.lock);
+    while (mp_threads.nstart < nthread) {
+        if (pthread_create(&thread, NULL, mp_threads_worker, 
+                (void *) (long) mp_threads.nstart) != 0) {
+            nthread = -1;
+            break;
+        }
+        pthread_detach(thread);
+        mp_threads.nstart++;
+        mp_threads.nbusy++;
+    }
+    /* ---- wait until the new threads have taken the job count ---- */
+    while (mp_threads.nbusy > 0) {
+        pthread_cond_wait(&mp_threads.done, &mp_threads.lock);
+    }
+    pthread_mutex_unlock(&mp_threads.lock);
+    if (nthread < 0) {
+        mp_threads.nthread = mp_threads.nstart;
+        return -1;
+    }
+    mp_threads.nthread = nthread;
+    return 0;
+}
+
+
+/* -------- mp_threads child routines -------- */
+
+
+void *mp_threads_worker(void *arg)
+{
+    int k, job;
+    void (*func)(void *arg, int k);
+    
+    k = (int) (long) arg;
+    pthread_mutex_lock(&mp_threads.lock);
+    job = mp_threads.job;
+    if (--mp_threads.nbusy == 0) {
+        pthread_cond_signal(&mp_threads.done);
+    }
+    for (;;) {
+        while (mp_threads.job == job) {
+            pthread_cond_wait(&mp_threads.start, &mp_threads.lock);
+        }
+        job = mp_threads.job;
+        if (k < mp_threads.nchunk) {
+            func = mp_threads.func;
+            arg = mp_threads.arg;
+            pthread_mutex_unlock(&mp_threads.lock);
+            (*func)(arg, k);
+            pthread_mutex_lock(&mp_threads.lock);
+            if (--mp_threads.nbusy == 0) {
+                pthread_cond_signal(&mp_threads.done);
+            }
+        }
+    }
+    return NULL;
+}
+
+
+int mp_threads_split(int n)
+{
+    int nchunk;
+    
+    nchunk = n / MP_THREADS_CHUNK_N;
+    if (nchunk > mp_threads.nthread) {
+        nchunk = mp_threads.nthread;
+    }
+    if (nchunk < 1) {
+        nchunk = 1;
+    }
+    return nchunk;
+}
+
+
+void mp_threads_range(struct mp_thread_job *job, int k, int *j0, int *j1)
+{
+    int n;
+    
+    n = job->j1 - job->j0;
+    *j0 = job->j0 + (int) ((long long) n * k / job->nchunk);
+    *j1 = job->j0 + (int) ((long long) n * (k + 1) / job->nchunk);
+}
+
+
+void mp_threads_exec(int nchunk, void (*func)(void *arg, int k), 
+        void *arg)
+{
+    /* ---- func(arg, k), k = 0...nchunk-1 (0: this thread) ---- */
+    if (nchunk > 1) {
+        pthread_mutex_lock(&mp_threads.lock);
+        mp_threads.func = func;
+        mp_threads.arg = arg;
+        mp_threads.nchunk = nchunk;
+        mp_threads.nbusy = nchunk - 1;
+        mp_threads.job++;
+        pthread_cond_broadcast(&mp_threads.start);
+        pthread_mutex_unlock(&mp_threads.lock);
+    }
+    (*func)(arg, 0);
+    if (nchunk > 1) {
+        pthread_mutex_lock(&mp_threads.lock);
+        while (mp_threads.nbusy > 0) {
+            pthread_cond_wait(&mp_threads.done, &mp_threads.lock);
+        }
+        pthread_mutex_unlock(&mp_threads.lock);
+    }
+}
+
+
+int mp_threads_carry(int radix, int carry, int j0, int j1, int out[])
+{
+    int j, x;
+    
+    /* ---- carry into out[j1 - 1], propagated down to out[j0]; 
+            returns the carry into out[j0 - 1] ---- */
+    for (j = j1 - 1; j >= j0 && carry != 0; j--) {
+        x = out[j] + carry;
+        carry = x / radix;
+        x -= carry * radix;
+        if (x < 0) {
+            x += radix;
+            carry--;
+        }
+        out[j] = x;
+    }
+    return carry;
+}
+
+
 /* -------- mp_load routines -------- */
 
 
@@ -827,38 +1212,63 @@ int mp_unsgn_cmp(int n, int in1[], int in2[])
 int mp_unexp_add(int n, int radix, int expdif, 
         int in1[], int in2[], int out[])
 {
-    int j, x, carry;
+    int mp_threads_split(int n);
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    void mp_threads_exec(int nchunk, void (*func)(void *arg, int k), 
+            void *arg);
+    int mp_threads_carry(int radix, int carry, int j0, int j1, 
+            int out[]);
+    void mp_unexp_add_chunk(void *arg, int k);
+    struct mp_thread_job job;
+    int j, k, j0, j1, x, carry;
     
     carry = 0;
+    job.shift = 0;
+    job.j1 = n;
     if (expdif == 0 && in1[0] + in2[0] >= radix) {
+        /* ---- out[j + 1] = in1[j] + in2[j] ---- */
         x = in1[n - 1] + in2[n - 1];
         carry = x >= radix ? -1 : 0;
-        for (j = n - 1; j > 0; j--) {
-            x = in1[j - 1] + in2[j - 1] - carry;
-            carry = x >= radix ? -1 : 0;
-            out[j] = x - (radix & carry);
+        job.shift = 1;
+        job.j1 = n - 1;
+    } else if (expdif > n) {
+        expdif = n;
+    }
+    job.nchunk = mp_threads_split(n);
+    if (out == in2 && expdif > 0) {
+        /* in2[j - expdif] may be already overwritten in an other range */
+        job.nchunk = 1;
+    }
+    job.j0 = 0;
+    job.radix = radix;
+    job.expdif = expdif;
+    job.in1 = in1;
+    job.in2 = in2;
+    job.out = out;
+    for (k = 0; k < job.nchunk; k++) {
+        job.carry[k] = 0;
+        if (k > 0 && job.shift > 0) {
+            /* in1[j0] is overwritten by out[j0] of range k - 1 */
+            mp_threads_range(&job, k, &j0, &j1);
+            job.edge[k][0] = in1[j0] + in2[j0];
         }
+    }
+    job.carry[job.nchunk - 1] = -carry;
+    mp_threads_exec(job.nchunk, mp_unexp_add_chunk, &job);
+    for (k = job.nchunk - 1; k > 0; k--) {
+        mp_threads_range(&job, k - 1, &j0, &j1);
+        job.carry[k - 1] += mp_threads_carry(radix, job.carry[k], 
+                j0 + job.shift, j1 + job.shift, out);
+    }
+    carry = -job.carry[0];
+    if (job.shift > 0) {
         out[0] = -carry;
-    } else {
-        if (expdif > n) {
-            expdif = n;
-        }
-        for (j = n - 1; j >= expdif; j--) {
-            x = in1[j] + in2[j - expdif] - carry;
-            carry = x >= radix ? -1 : 0;
-            out[j] = x - (radix & carry);
-        }
-        for (j = expdif - 1; j >= 0; j--) {
-            x = in1[j] - carry;
-            carry = x >= radix ? -1 : 0;
-            out[j] = x - (radix & carry);
-        }
-        if (carry != 0) {
-            for (j = n - 1; j > 0; j--) {
-                out[j] = out[j - 1];
-            }
-            out[0] = -carry;
+    } else if (carry != 0) {
+        for (j = n - 1; j > 0; j--) {
+            out[j] = out[j - 1];
         }
+        out[0] = -carry;
     }
     return -carry;
 }
@@ -867,21 +1277,36 @@ int mp_unexp_add(int n, int radix, int expdif,
 int mp_unexp_sub(int n, int radix, int expdif, 
         int in1[], int in2[], int out[])
 {
-    int j, x, borrow, ncancel;
+    int mp_threads_split(int n);
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    void mp_threads_exec(int nchunk, void (*func)(void *arg, int k), 
+            void *arg);
+    int mp_threads_carry(int radix, int carry, int j0, int j1, 
+            int out[]);
+    void mp_unexp_sub_chunk(void *arg, int k);
+    struct mp_thread_job job;
+    int j, k, j0, j1, ncancel;
     
     if (expdif > n) {
         expdif = n;
     }
-    borrow = 0;
-    for (j = n - 1; j >= expdif; j--) {
-        x = in1[j] - in2[j - expdif] + borrow;
-        borrow = x < 0 ? -1 : 0;
-        out[j] = x + (radix & borrow);
-    }
-    for (j = expdif - 1; j >= 0; j--) {
-        x = in1[j] + borrow;
-        borrow = x < 0 ? -1 : 0;
-        out[j] = x + (radix & borrow);
+    job.nchunk = mp_threads_split(n);
+    if (out == in2 && expdif > 0) {
+        job.nchunk = 1;
+    }
+    job.j0 = 0;
+    job.j1 = n;
+    job.radix = radix;
+    job.expdif = expdif;
+    job.in1 = in1;
+    job.in2 = in2;
+    job.out = out;
+    mp_threads_exec(job.nchunk, mp_unexp_sub_chunk, &job);
+    for (k = job.nchunk - 1; k > 0; k--) {
+        mp_threads_range(&job, k - 1, &j0, &j1);
+        job.carry[k - 1] += mp_threads_carry(radix, job.carry[k], 
+                j0, j1, out);
     }
     ncancel = 0;
     for (j = 0; j < n && out[j] == 0; j++) {
@@ -899,6 +1324,71 @@ int mp_unexp_sub(int n, int radix, int expdif,
 }
 
 
+void mp_unexp_add_chunk(void *arg, int k)
+{
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    struct mp_thread_job *job = (struct mp_thread_job *) arg;
+    int j, j0, j1, jedge, x, carry, radix, expdif, shift;
+    int *in1, *in2, *out;
+    
+    mp_threads_range(job, k, &j0, &j1);
+    radix = job->radix;
+    expdif = job->expdif;
+    shift = job->shift;
+    in1 = job->in1;
+    in2 = job->in2;
+    out = &job->out[shift];
+    jedge = k > 0 ? j0 + shift : j0;
+    carry = -job->carry[k];
+    for (j = j1 - 1; j >= jedge && j >= expdif; j--) {
+        x = in1[j] + in2[j - expdif] - carry;
+        carry = x >= radix ? -1 : 0;
+        out[j] = x - (radix & carry);
+    }
+    for (; j >= jedge; j--) {
+        x = in1[j] - carry;
+        carry = x >= radix ? -1 : 0;
+        out[j] = x - (radix & carry);
+    }
+    if (jedge > j0) {
+        x = job->edge[k][0] - carry;
+        carry = x >= radix ? -1 : 0;
+        out[j0] = x - (radix & carry);
+    }
+    job->carry[k] = -carry;
+}
+
+
+void mp_unexp_sub_chunk(void *arg, int k)
+{
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    struct mp_thread_job *job = (struct mp_thread_job *) arg;
+    int j, j0, j1, x, borrow, radix, expdif;
+    int *in1, *in2, *out;
+    
+    mp_threads_range(job, k, &j0, &j1);
+    radix = job->radix;
+    expdif = job->expdif;
+    in1 = job->in1;
+    in2 = job->in2;
+    out = job->out;
+    borrow = 0;
+    for (j = j1 - 1; j >= j0 && j >= expdif; j--) {
+        x = in1[j] - in2[j - expdif] + borrow;
+        borrow = x < 0 ? -1 : 0;
+        out[j] = x + (radix & borrow);
+    }
+    for (; j >= j0; j--) {
+        x = in1[j] + borrow;
+        borrow = x < 0 ? -1 : 0;
+        out[j] = x + (radix & borrow);
+    }
+    job->carry[k] = borrow;
+}
+
+
 /* -------- mp_imul routines -------- */
 
 
@@ -948,7 +1438,14 @@ int mp_idiv(int n, int radix, int in1[], int in2, int out[])
 
 void mp_idiv_2(int n, int radix, int in[], int out[])
 {
-    int j, ix, carry, shift;
+    int mp_threads_split(int n);
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    void mp_threads_exec(int nchunk, void (*func)(void *arg, int k), 
+            void *arg);
+    void mp_idiv_2_chunk(void *arg, int k);
+    struct mp_thread_job job;
+    int k, j0, j1, carry, shift;
     
     out[0] = in[0];
     shift = 0;
@@ -956,15 +1453,54 @@ void mp_idiv_2(int n, int radix, int in[], int out[])
         shift = 1;
     }
     out[1] = in[1] - shift;
-    carry = -shift;
-    for (j = 2; j <= n + 1 - shift; j++) {
+    /* ---- an even radix: the carry into out[j] is the parity 
+            of in[j - 1 + shift] ---- */
+    job.nchunk = radix % 2 == 0 ? mp_threads_split(n) : 1;
+    job.j0 = 2;
+    job.j1 = n + 2 - shift;
+    job.radix = radix;
+    job.shift = shift;
+    job.in1 = in;
+    job.out = out;
+    for (k = 0; k < job.nchunk; k++) {
+        mp_threads_range(&job, k, &j0, &j1);
+        job.carry[k] = k > 0 ? -(in[j0 - 1 + shift] & 1) : -shift;
+        job.edge[k][0] = in[j1 - 1 + shift];
+    }
+    mp_threads_exec(job.nchunk, mp_idiv_2_chunk, &job);
+    carry = job.carry[job.nchunk - 1];
+    if (shift > 0) {
+        out[n + 1] = (radix & carry) >> 1;
+    }
+}
+
+
+void mp_idiv_2_chunk(void *arg, int k)
+{
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    struct mp_thread_job *job = (struct mp_thread_job *) arg;
+    int j, j0, j1, ix, carry, radix, shift;
+    int *in, *out;
+    
+    mp_threads_range(job, k, &j0, &j1);
+    radix = job->radix;
+    shift = job->shift;
+    in = job->in1;
+    out = job->out;
+    carry = job->carry[k];
+    for (j = j0; j < j1 - 1; j++) {
         ix = in[j + shift] + (radix & carry);
         carry = -(ix & 1);
         out[j] = ix >> 1;
     }
-    if (shift > 0) {
-        out[n + 1] = (radix & carry) >> 1;
+    /* in[j1 - 1 + shift] may be out[j1] of range k + 1 */
+    if (j1 > j0) {
+        ix = job->edge[k][0] + (radix & carry);
+        carry = -(ix & 1);
+        out[j1 - 1] = ix >> 1;
     }
+    job->carry[k] = carry;
 }
 
 
@@ -974,16 +1510,33 @@ void mp_idiv_2(int n, int radix, int in[], int out[])
 void mp_unsgn_imul(int n, double dradix, int in1[], double din2, 
         int out[])
 {
-    int j, carry, shift;
+    int mp_threads_split(int n);
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    void mp_threads_exec(int nchunk, void (*func)(void *arg, int k), 
+            void *arg);
+    int mp_threads_carry(int radix, int carry, int j0, int j1, 
+            int out[]);
+    void mp_unsgn_imul_chunk(void *arg, int k);
+    struct mp_thread_job job;
+    int j, k, j0, j1, carry, shift;
     double x, d1_radix;
     
     d1_radix = 1.0 / dradix;
-    carry = 0;
-    for (j = n; j >= 1; j--) {
-        x = din2 * in1[j] + carry + 0.5;
-        carry = (int) (d1_radix * x);
-        out[j] = (int) (x - dradix * carry);
-    }
+    job.nchunk = mp_threads_split(n);
+    job.j0 = 1;
+    job.j1 = n + 1;
+    job.dradix = dradix;
+    job.din2 = din2;
+    job.in1 = in1;
+    job.out = out;
+    mp_threads_exec(job.nchunk, mp_unsgn_imul_chunk, &job);
+    for (k = job.nchunk - 1; k > 0; k--) {
+        mp_threads_range(&job, k - 1, &j0, &j1);
+        job.carry[k - 1] += mp_threads_carry((int) dradix, 
+                job.carry[k], j0, j1, out);
+    }
+    carry = job.carry[0];
     shift = 0;
     x = carry + 0.5;
     while (x > 1) {
@@ -1011,7 +1564,16 @@ void mp_unsgn_imul(int n, double dradix, int in1[], double din2,
 void mp_unsgn_idiv(int n, double dradix, int in1[], double din2, 
         int out[])
 {
-    int j, ix, carry, shift;
+    int mp_threads_split(int n);
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    void mp_threads_exec(int nchunk, void (*func)(void *arg, int k), 
+            void *arg);
+    void mp_unsgn_idiv_rem(void *arg, int k);
+    void mp_unsgn_idiv_chunk(void *arg, int k);
+    struct mp_thread_job job;
+    int k, j0, j1, ix, carry, shift;
+    long long d, r, p, pow_radix;
     double x, d1_in2;
     
     d1_in2 = 1.0 / din2;
@@ -1033,14 +1595,124 @@ void mp_unsgn_idiv(int n, double dradix, int in1[], double din2,
     if (shift >= n) {
         shift = n - 1;
     }
-    for (j = 2; j <= n - shift; j++) {
+    job.nchunk = mp_threads_split(n);
+    if (shift > MP_THREADS_EDGE) {
+        job.nchunk = 1;
+    }
+    job.j0 = 2;
+    job.j1 = n + 1;
+    job.shift = shift;
+    job.dradix = dradix;
+    job.din2 = din2;
+    job.in1 = in1;
+    job.out = out;
+    if (job.nchunk > 1) {
+        /* ---- the remainders of the ranges, then the carry into 
+                range k + 1: (carry into k) * radix^len + rem ---- */
+        mp_threads_exec(job.nchunk, mp_unsgn_idiv_rem, &job);
+        d = (long long) din2;
+        for (k = 0; k < job.nchunk - 1; k++) {
+            mp_threads_range(&job, k, &j0, &j1);
+            p = 1;
+            pow_radix = (long long) dradix % d;
+            for (j1 -= j0; j1 > 0; j1 >>= 1) {
+                if (j1 & 1) {
+                    p = p * pow_radix % d;
+                }
+                pow_radix = pow_radix * pow_radix % d;
+            }
+            r = job.carry[k];
+            job.carry[k] = carry;
+            carry = (int) ((carry * p + r) % d);
+        }
+    }
+    job.carry[job.nchunk - 1] = carry;
+    mp_threads_exec(job.nchunk, mp_unsgn_idiv_chunk, &job);
+}
+
+
+void mp_unsgn_imul_chunk(void *arg, int k)
+{
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    struct mp_thread_job *job = (struct mp_thread_job *) arg;
+    int j, j0, j1, carry;
+    int *in1, *out;
+    double x, dradix, d1_radix, din2;
+    
+    mp_threads_range(job, k, &j0, &j1);
+    dradix = job->dradix;
+    d1_radix = 1.0 / dradix;
+    din2 = job->din2;
+    in1 = job->in1;
+    out = job->out;
+    carry = 0;
+    for (j = j1 - 1; j >= j0; j--) {
+        x = din2 * in1[j] + carry + 0.5;
+        carry = (int) (d1_radix * x);
+        out[j] = (int) (x - dradix * carry);
+    }
+    job->carry[k] = carry;
+}
+
+
+void mp_unsgn_idiv_rem(void *arg, int k)
+{
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    struct mp_thread_job *job = (struct mp_thread_job *) arg;
+    int j, j0, j1, ix, carry, shift, n;
+    int *in1;
+    double x, dradix, din2, d1_in2;
+    
+    mp_threads_range(job, k, &j0, &j1);
+    n = job->j1 - 1;
+    shift = job->shift;
+    dradix = job->dradix;
+    din2 = job->din2;
+    d1_in2 = 1.0 / din2;
+    in1 = job->in1;
+    /* ---- in1[j1...j1+shift-1] may be out[] of range k + 1 ---- */
+    for (j = 0; j < shift; j++) {
+        job->edge[k][j] = j1 + j <= n ? in1[j1 + j] : 0;
+    }
+    carry = 0;
+    for (j = j0; j < j1; j++) {
+        x = (j + shift <= n ? in1[j + shift] : 0) + dradix * carry + 0.5;
+        ix = (int) (d1_in2 * x);
+        carry = (int) (x - din2 * ix);
+    }
+    job->carry[k] = carry;
+}
+
+
+void mp_unsgn_idiv_chunk(void *arg, int k)
+{
+    void mp_threads_range(struct mp_thread_job *job, int k, 
+            int *j0, int *j1);
+    struct mp_thread_job *job = (struct mp_thread_job *) arg;
+    int j, j0, j1, ix, carry, shift, n;
+    int *in1, *out;
+    double x, dradix, din2, d1_in2;
+    
+    mp_threads_range(job, k, &j0, &j1);
+    n = job->j1 - 1;
+    shift = job->shift;
+    dradix = job->dradix;
+    din2 = job->din2;
+    d1_in2 = 1.0 / din2;
+    in1 = job->in1;
+    out = job->out;
+    carry = job->carry[k];
+    for (j = j0; j < j1 - shift; j++) {
         x = in1[j + shift] + dradix * carry + 0.5;
         ix = (int) (d1_in2 * x);
         carry = (int) (x - din2 * ix);
         out[j] = ix;
     }
-    for (j = n - shift + 1; j <= n; j++) {
-        x = dradix * carry + 0.5;
+    for (; j < j1; j++) {
+        x = (job->nchunk > 1 ? job->edge[k][j + shift - j1] : 
+                j + shift <= n ? in1[j + shift] : 0) + dradix * carry + 0.5;
         ix = (int) (d1_in2 * x);
         carry = (int) (x - din2 * ix);
         out[j] = ix;
@@ -1051,6 +1723,39 @@ void mp_unsgn_idiv(int n, double dradix, int in1[], double din2,
 /* -------- mp_mul routines -------- */
 
 
+/* ---- NTT tables (mp_ntt_init), use == 0: rdft ---- */
+struct mp_ntt_table {
+    int use;
+    int nmax;
+    unsigned int *w;
+} mp_ntt = {0, 0, NULL};
+
+
+int mp_mul_buf_alloc(struct mp_mul_buf *b, int nfft, int ntt)
+{
+    b->d = NULL;
+    b->hd[0] = 0;
+    b->hd[1] = 0;
+    b->a = NULL;
+    if (ntt) {
+        b->a = (unsigned int *) malloc(3 * (size_t) nfft * 
+                sizeof(unsigned int));
+        return b->a == NULL ? -1 : 0;
+    }
+    b->d = (double *) malloc((nfft + 2) * sizeof(double));
+    return b->d == NULL ? -1 : 0;
+}
+
+
+void mp_mul_buf_free(struct mp_mul_buf *b)
+{
+    free(b->a);
+    free(b->d);
+    b->a = NULL;
+    b->d = NULL;
+}
+
+
 double mp_mul_radix_test(int n, int radix, int nfft, 
         double tmpfft[], int ip[], double w[])
 {
@@ -1081,19 +1786,77 @@ double mp_mul_radix_test(int n, int radix, int nfft,
 }
 
 
-void mp_mul(int n, int radix, int in1[], int in2[], int out[], 
-        int tmp[], int nfft, double tmp1fft[], double tmp2fft[], 
-        double tmp3fft[], int ip[], double w[])
+void mp_mul(int n, int radix, int in1[], int in2[], int out[], int tmp[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+        struct mp_mul_buf *tmp3fft, int ip[], double w[])
+{
+    void mp_mul_fft(int n, int radix, int in1[], int in2[], struct mp_fft *h2, 
+            int out[], int tmp[], int nfft, struct mp_mul_buf *tmp1fft, 
+            struct mp_mul_buf *tmp3fft, int ip[], double w[]);
+    struct mp_fft h2 = {NULL, 0, 0, NULL};
+    
+    h2.fft = tmp2fft;
+    mp_mul_fft(n, radix, in1, in2, &h2, out, tmp, nfft, 
+            tmp1fft, tmp3fft, ip, w);
+}
+
+
+void mp_squ(int n, int radix, int in[], int out[], int tmp[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+        int ip[], double w[])
+{
+    void mp_squ_fft(int n, int radix, int in[], struct mp_fft *h, 
+            int out[], int tmp[], int nfft, struct mp_mul_buf *tmp2fft, 
+            int ip[], double w[]);
+    struct mp_fft h = {NULL, 0, 0, NULL};
+    
+    h.fft = tmp1fft;
+    mp_squ_fft(n, radix, in, &h, out, tmp, nfft, tmp2fft, ip, w);
+}
+
+
+void mp_mulh(int n, int radix, int in1[], int in2[], int out[], int nfft, 
+        struct mp_mul_buf *in1fft, struct mp_mul_buf *outfft, int ip[], 
+        double w[])
+{
+    void mp_mulh_fft(int n, int radix, int in1[], struct mp_fft *h1, 
+            int shift, int in2[], int out[], int nfft, 
+            struct mp_mul_buf *outfft, int ip[], double w[]);
+    struct mp_fft h1 = {NULL, 0, 0, NULL};
+    
+    h1.fft = in1fft;
+    mp_mulh_fft(n, radix, in1, &h1, 0, in2, out, nfft, outfft, ip, w);
+}
+
+
+void mp_squh(int n, int radix, int in[], int out[], 
+        int nfft, struct mp_mul_buf *inoutfft, int ip[], double w[])
+{
+    void mp_squh_fft(int n, int radix, int in[], struct mp_fft *h, 
+            int out[], int nfft, int ip[], double w[]);
+    struct mp_fft h = {NULL, 0, 0, NULL};
+    
+    h.fft = inoutfft;
+    mp_squh_fft(n, radix, in, &h, out, nfft, ip, w);
+}
+
+
+void mp_mul_fft(int n, int radix, int in1[], int in2[], struct mp_fft *h2, 
+        int out[], int tmp[], int nfft, struct mp_mul_buf *tmp1fft, 
+        struct mp_mul_buf *tmp3fft, int ip[], double w[])
 {
     void mp_copy(int n, int radix, int in[], int out[]);
     void mp_add(int n, int radix, int in1[], int in2[], int out[]);
-    void rdft(int n, int isgn, double *a, int *ip, double *w);
-    void mp_mul_i2d(int n, int radix, int nfft, int shift, 
-            int in[], double dout[]);
-    void mp_mul_cmul(int nfft, double din[], double dinout[]);
-    void mp_mul_cmuladd(int nfft, double din1[], double din2[], 
-            double dinout[]);
-    void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[]);
+    void mp_mul_fwd(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_mul_buf *dout, int ip[], double w[]);
+    void mp_mul_fwd_fft(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_fft *h, int ip[], double w[]);
+    void mp_mul_pmul(int nfft, struct mp_mul_buf *din, 
+            struct mp_mul_buf *dinout);
+    void mp_mul_pmuladd(int nfft, struct mp_mul_buf *din1, 
+            struct mp_mul_buf *din2, struct mp_mul_buf *dinout);
+    void mp_mul_inv(int n, int radix, int nfft, struct mp_mul_buf *din, 
+            int out[], int ip[], double w[]);
     int n_h, shift;
     
     shift = (nfft >> 1) + 1;
@@ -1108,24 +1871,18 @@ void mp_mul(int n, int radix, int in1[], int in2[], int out[],
         n_h = n - shift;
     }
     /* ---- tmp3fft = (upper) in1 * (lower) in2 ---- */
-    mp_mul_i2d(n, radix, nfft, 0, in1, tmp1fft);
-    rdft(nfft, 1, &tmp1fft[1], ip, w);
-    mp_mul_i2d(n, radix, nfft, shift, in2, tmp3fft);
-    rdft(nfft, 1, &tmp3fft[1], ip, w);
-    mp_mul_cmul(nfft, tmp1fft, tmp3fft);
+    mp_mul_fwd(n, radix, nfft, 0, in1, tmp1fft, ip, w);
+    mp_mul_fwd(n, radix, nfft, shift, in2, tmp3fft, ip, w);
+    mp_mul_pmul(nfft, tmp1fft, tmp3fft);
     /* ---- tmp = (upper) in1 * (upper) in2 ---- */
-    mp_mul_i2d(n, radix, nfft, 0, in2, tmp2fft);
-    rdft(nfft, 1, &tmp2fft[1], ip, w);
-    mp_mul_cmul(nfft, tmp2fft, tmp1fft);
-    rdft(nfft, -1, &tmp1fft[1], ip, w);
-    mp_mul_d2i(n, radix, nfft, tmp1fft, tmp);
+    mp_mul_fwd_fft(n, radix, nfft, 0, in2, h2, ip, w);
+    mp_mul_pmul(nfft, h2->fft, tmp1fft);
+    mp_mul_inv(n, radix, nfft, tmp1fft, tmp, ip, w);
     /* ---- tmp3fft += (upper) in2 * (lower) in1 ---- */
-    mp_mul_i2d(n, radix, nfft, shift, in1, tmp1fft);
-    rdft(nfft, 1, &tmp1fft[1], ip, w);
-    mp_mul_cmuladd(nfft, tmp1fft, tmp2fft, tmp3fft);
+    mp_mul_fwd(n, radix, nfft, shift, in1, tmp1fft, ip, w);
+    mp_mul_pmuladd(nfft, tmp1fft, h2->fft, tmp3fft);
     /* ---- out = tmp + tmp3fft ---- */
-    rdft(nfft, -1, &tmp3fft[1], ip, w);
-    mp_mul_d2i(n_h, radix, nfft, tmp3fft, out);
+    mp_mul_inv(n_h, radix, nfft, tmp3fft, out, ip, w);
     if (out[0] != 0) {
         mp_add(n, radix, out, tmp, out);
     } else {
@@ -1134,17 +1891,20 @@ void mp_mul(int n, int radix, int in1[], int in2[], int out[],
 }
 
 
-void mp_squ(int n, int radix, int in[], int out[], int tmp[], 
-        int nfft, double tmp1fft[], double tmp2fft[], 
+void mp_squ_fft(int n, int radix, int in[], struct mp_fft *h, 
+        int out[], int tmp[], int nfft, struct mp_mul_buf *tmp2fft, 
         int ip[], double w[])
 {
     void mp_add(int n, int radix, int in1[], int in2[], int out[]);
-    void rdft(int n, int isgn, double *a, int *ip, double *w);
-    void mp_mul_i2d(int n, int radix, int nfft, int shift, 
-            int in[], double dout[]);
-    void mp_mul_cmul(int nfft, double din[], double dinout[]);
-    void mp_mul_csqu(int nfft, double dinout[]);
-    void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[]);
+    void mp_mul_fwd(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_mul_buf *dout, int ip[], double w[]);
+    void mp_mul_fwd_fft(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_fft *h, int ip[], double w[]);
+    void mp_mul_pmul(int nfft, struct mp_mul_buf *din, 
+            struct mp_mul_buf *dinout);
+    void mp_mul_psqu(int nfft, struct mp_mul_buf *dinout);
+    void mp_mul_inv(int n, int radix, int nfft, struct mp_mul_buf *din, 
+            int out[], int ip[], double w[]);
     int n_h, shift;
     
     shift = (nfft >> 1) + 1;
@@ -1159,17 +1919,14 @@ void mp_squ(int n, int radix, int in[], int out[], int tmp[],
         n_h = n - shift;
     }
     /* ---- tmp = (upper) in * (lower) in ---- */
-    mp_mul_i2d(n, radix, nfft, 0, in, tmp1fft);
-    rdft(nfft, 1, &tmp1fft[1], ip, w);
-    mp_mul_i2d(n, radix, nfft, shift, in, tmp2fft);
-    rdft(nfft, 1, &tmp2fft[1], ip, w);
-    mp_mul_cmul(nfft, tmp1fft, tmp2fft);
-    rdft(nfft, -1, &tmp2fft[1], ip, w);
-    mp_mul_d2i(n_h, radix, nfft, tmp2fft, tmp);
+    mp_mul_fwd_fft(n, radix, nfft, 0, in, h, ip, w);
+    mp_mul_fwd(n, radix, nfft, shift, in, tmp2fft, ip, w);
+    mp_mul_pmul(nfft, h->fft, tmp2fft);
+    mp_mul_inv(n_h, radix, nfft, tmp2fft, tmp, ip, w);
     /* ---- out = 2 * tmp + ((upper) in)^2 ---- */
-    mp_mul_csqu(nfft, tmp1fft);
-    rdft(nfft, -1, &tmp1fft[1], ip, w);
-    mp_mul_d2i(n, radix, nfft, tmp1fft, out);
+    mp_mul_psqu(nfft, h->fft);
+    h->in = NULL;
+    mp_mul_inv(n, radix, nfft, h->fft, out, ip, w);
     if (tmp[0] != 0) {
         mp_add(n_h, radix, tmp, tmp, tmp);
         mp_add(n, radix, out, tmp, out);
@@ -1177,35 +1934,19 @@ void mp_squ(int n, int radix, int in[], int out[], int tmp[],
 }
 
 
-void mp_mulh(int n, int radix, int in1[], int in2[], int out[], 
-        int nfft, double in1fft[], double outfft[], int ip[], double w[])
+void mp_mulh_fft(int n, int radix, int in1[], struct mp_fft *h1, 
+        int shift, int in2[], int out[], int nfft, 
+        struct mp_mul_buf *outfft, int ip[], double w[])
 {
-    void rdft(int n, int isgn, double *a, int *ip, double *w);
-    void mp_mul_i2d(int n, int radix, int nfft, int shift, 
-            int in[], double dout[]);
-    void mp_mul_cmul(int nfft, double din[], double dinout[]);
-    void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[]);
-    
-    mp_mul_i2d(n, radix, nfft, 0, in1, in1fft);
-    rdft(nfft, 1, &in1fft[1], ip, w);
-    mp_mul_i2d(n, radix, nfft, 0, in2, outfft);
-    rdft(nfft, 1, &outfft[1], ip, w);
-    mp_mul_cmul(nfft, in1fft, outfft);
-    rdft(nfft, -1, &outfft[1], ip, w);
-    mp_mul_d2i(n, radix, nfft, outfft, out);
-}
-
-
-void mp_mulh_use_in1fft(int n, int radix, double in1fft[], 
-        int shift, int in2[], int out[], int nfft, double outfft[], 
-        int ip[], double w[])
-{
-    void rdft(int n, int isgn, double *a, int *ip, double *w);
-    void mp_mul_i2d(int n, int radix, int nfft, int shift, 
-            int in[], double dout[]);
-    void mp_mul_cmul(int nfft, double din[], double dinout[]);
-    void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[]);
-    int n_h;
+    void mp_mul_fwd(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_mul_buf *dout, int ip[], double w[]);
+    void mp_mul_fwd_fft(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_fft *h, int ip[], double w[]);
+    void mp_mul_pmul(int nfft, struct mp_mul_buf *din, 
+            struct mp_mul_buf *dinout);
+    void mp_mul_inv(int n, int radix, int nfft, struct mp_mul_buf *din, 
+            int out[], int ip[], double w[]);
+    int n_h;
     
     while (n > shift) {
         if (in2[shift + 2] != 0) {
@@ -1217,45 +1958,88 @@ void mp_mulh_use_in1fft(int n, int radix, double in1fft[],
     if (n_h < n - shift) {
         n_h = n - shift;
     }
-    mp_mul_i2d(n, radix, nfft, shift, in2, outfft);
-    rdft(nfft, 1, &outfft[1], ip, w);
-    mp_mul_cmul(nfft, in1fft, outfft);
-    rdft(nfft, -1, &outfft[1], ip, w);
-    mp_mul_d2i(n_h, radix, nfft, outfft, out);
+    mp_mul_fwd_fft(n, radix, nfft, 0, in1, h1, ip, w);
+    mp_mul_fwd(n, radix, nfft, shift, in2, outfft, ip, w);
+    mp_mul_pmul(nfft, h1->fft, outfft);
+    mp_mul_inv(n_h, radix, nfft, outfft, out, ip, w);
 }
 
 
-void mp_squh(int n, int radix, int in[], int out[], 
-        int nfft, double inoutfft[], int ip[], double w[])
+void mp_squh_fft(int n, int radix, int in[], struct mp_fft *h, 
+        int out[], int nfft, int ip[], double w[])
+{
+    void mp_mul_fwd_fft(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_fft *h, int ip[], double w[]);
+    void mp_mul_psqu(int nfft, struct mp_mul_buf *dinout);
+    void mp_mul_inv(int n, int radix, int nfft, struct mp_mul_buf *din, 
+            int out[], int ip[], double w[]);
+    
+    mp_mul_fwd_fft(n, radix, nfft, 0, in, h, ip, w);
+    mp_mul_psqu(nfft, h->fft);
+    h->in = NULL;
+    mp_mul_inv(n, radix, nfft, h->fft, out, ip, w);
+}
+
+
+/* -------- mp_mul child routines -------- */
+
+
+/* mp_mul_d2i: the carries are resolved in MP_D2I_LANES lanes 
+   (independent chains, overlapped by the CPU) of at least 
+   MP_D2I_MINLEN digits, then by a short fix-up between lanes */
+#define MP_D2I_LANES 8
+#define MP_D2I_MINLEN 64
+
+
+void mp_mul_fwd(int n, int radix, int nfft, int shift, 
+        int in[], struct mp_mul_buf *dout, int ip[], double w[])
 {
     void rdft(int n, int isgn, double *a, int *ip, double *w);
     void mp_mul_i2d(int n, int radix, int nfft, int shift, 
             int in[], double dout[]);
-    void mp_mul_csqu(int nfft, double dinout[]);
-    void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[]);
+    void mp_mul_i2n(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_mul_buf *dout);
     
-    mp_mul_i2d(n, radix, nfft, 0, in, inoutfft);
-    rdft(nfft, 1, &inoutfft[1], ip, w);
-    mp_mul_csqu(nfft, inoutfft);
-    rdft(nfft, -1, &inoutfft[1], ip, w);
-    mp_mul_d2i(n, radix, nfft, inoutfft, out);
+    if (mp_ntt.use) {
+        mp_mul_i2n(n, radix, nfft, shift, in, dout);
+        return;
+    }
+    mp_mul_i2d(n, radix, nfft, shift, in, dout->d);
+    rdft(nfft, 1, &dout->d[1], ip, w);
 }
 
 
-void mp_squh_use_in1fft(int n, int radix, double inoutfft[], int out[], 
-        int nfft, int ip[], double w[])
+void mp_mul_fwd_fft(int n, int radix, int nfft, int shift, 
+        int in[], struct mp_fft *h, int ip[], double w[])
 {
-    void rdft(int n, int isgn, double *a, int *ip, double *w);
-    void mp_mul_csqu(int nfft, double dinout[]);
-    void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[]);
+    void mp_mul_fwd(int n, int radix, int nfft, int shift, 
+            int in[], struct mp_mul_buf *dout, int ip[], double w[]);
     
-    mp_mul_csqu(nfft, inoutfft);
-    rdft(nfft, -1, &inoutfft[1], ip, w);
-    mp_mul_d2i(n, radix, nfft, inoutfft, out);
+    if (h->in == in && h->shift == shift && h->nfft == nfft) {
+        return;
+    }
+    mp_mul_fwd(n, radix, nfft, shift, in, h->fft, ip, w);
+    h->in = in;
+    h->shift = shift;
+    h->nfft = nfft;
 }
 
 
-/* -------- mp_mul child routines -------- */
+void mp_mul_inv(int n, int radix, int nfft, struct mp_mul_buf *din, 
+        int out[], int ip[], double w[])
+{
+    void rdft(int n, int isgn, double *a, int *ip, double *w);
+    void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[]);
+    void mp_mul_n2i(int n, int radix, int nfft, struct mp_mul_buf *din, 
+            int out[]);
+    
+    if (mp_ntt.use) {
+        mp_mul_n2i(n, radix, nfft, din, out);
+        return;
+    }
+    rdft(nfft, -1, &din->d[1], ip, w);
+    mp_mul_d2i(n, radix, nfft, din->d, out);
+}
 
 
 void mp_mul_i2d(int n, int radix, int nfft, int shift, 
@@ -1276,22 +2060,70 @@ void mp_mul_i2d(int n, int radix, int nfft, int shift,
     for (j = nfft; j > ndata; j--) {
         dout[j] = 0;
     }
-    /* ---- abs(dout[j]) <= radix/2 (to keep FFT precision) ---- */
+    /* ---- abs(dout[j]) <= radix/2 (to keep FFT precision): 
+            the carry depends on in[j + shift] only, not on the 
+            carry below it (x = radix/2 is left as it is), so 
+            there is no carry chain ---- */
     if (ndata > 1) {
         radix_2 = radix / 2;
         carry = 0;
         for (j = ndata + 1; j > 3; j--) {
-            x = in[j + shift] - carry;
-            carry = x >= radix_2 ? -1 : 0;
-            dout[j - 1] = x - (radix & carry);
+            x = in[j + shift];
+            dout[j - 1] = x + carry - (x >= radix_2 ? radix : 0);
+            carry = x >= radix_2 ? 1 : 0;
         }
-        dout[2] = in[shift + 3] - carry;
+        dout[2] = in[shift + 3] + carry;
     }
     dout[1] = topdgt;
     dout[0] = in[1] - shift;
 }
 
 
+void mp_mul_pmul(int nfft, struct mp_mul_buf *din, 
+        struct mp_mul_buf *dinout)
+{
+    void mp_mul_cmul(int nfft, double din[], double dinout[]);
+    void mp_mul_nmul(int nfft, struct mp_mul_buf *din1, 
+            struct mp_mul_buf *din2, struct mp_mul_buf *dinout);
+    
+    if (mp_ntt.use) {
+        mp_mul_nmul(nfft, din, dinout, dinout);
+        return;
+    }
+    mp_mul_cmul(nfft, din->d, dinout->d);
+}
+
+
+void mp_mul_pmuladd(int nfft, struct mp_mul_buf *din1, 
+        struct mp_mul_buf *din2, struct mp_mul_buf *dinout)
+{
+    void mp_mul_cmuladd(int nfft, double din1[], double din2[], 
+            double dinout[]);
+    void mp_mul_nmuladd(int nfft, struct mp_mul_buf *din1, 
+            struct mp_mul_buf *din2, struct mp_mul_buf *dinout);
+    
+    if (mp_ntt.use) {
+        mp_mul_nmuladd(nfft, din1, din2, dinout);
+        return;
+    }
+    mp_mul_cmuladd(nfft, din1->d, din2->d, dinout->d);
+}
+
+
+void mp_mul_psqu(int nfft, struct mp_mul_buf *dinout)
+{
+    void mp_mul_csqu(int nfft, double dinout[]);
+    void mp_mul_nmul(int nfft, struct mp_mul_buf *din1, 
+            struct mp_mul_buf *din2, struct mp_mul_buf *dinout);
+    
+    if (mp_ntt.use) {
+        mp_mul_nmul(nfft, dinout, dinout, dinout);
+        return;
+    }
+    mp_mul_csqu(nfft, dinout->d);
+}
+
+
 void mp_mul_cmul(int nfft, double din[], double dinout[])
 {
     int j;
@@ -1352,7 +2184,10 @@ void mp_mul_csqu(int nfft, double dinout[])
 
 void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[])
 {
-    int j, carry, carry1, carry2, shift, ndata;
+    void mp_mul_d2i_fix(int radix, int j, int jend, int carry, 
+            int carry2, int *lcarry, int *lcarry2, int out[]);
+    int j, k, m, len, carry, carry1, carry2, shift, ndata;
+    int lcarry[MP_D2I_LANES], lcarry2[MP_D2I_LANES];
     double x, scale, d1_radix, d1_radix2, pow_radix, topdgt;
     
     scale = 2.0 / nfft;
@@ -1385,7 +2220,40 @@ void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[])
     x = d1_radix2 * (scale * x + 0.5);
     carry2 = ((int) x) - 1;
     carry = (int) (radix * (x - carry2) + 0.5);
-    for (j = ndata; j > 1; j--) {
+    /* ---- MP_D2I_LANES lanes of len digits (lane 0: the lowest) 
+            with independent carry chains, run side by side ---- */
+    len = (ndata - 1) / MP_D2I_LANES;
+    if (len >= MP_D2I_MINLEN) {
+        for (k = 0; k < MP_D2I_LANES; k++) {
+            lcarry[k] = 0;
+            lcarry2[k] = 0;
+        }
+        lcarry[0] = carry;
+        lcarry2[0] = carry2;
+        for (m = 0; m < len; m++) {
+            for (k = 0; k < MP_D2I_LANES; k++) {
+                j = ndata - k * len - m;
+                x = d1_radix2 * (scale * din[j - shift] + lcarry[k] + 0.5);
+                carry = lcarry2[k];
+                lcarry2[k] = ((int) x) - 1;
+                x = radix * (x - lcarry2[k]);
+                carry1 = (int) x;
+                out[j + 1] = (int) (radix * (x - carry1));
+                lcarry[k] = carry + carry1;
+            }
+        }
+        /* ---- fix-up: carry of lane k - 1 into lane k ---- */
+        for (k = 1; k < MP_D2I_LANES; k++) {
+            mp_mul_d2i_fix(radix, ndata - k * len, 
+                ndata - (k + 1) * len + 1, lcarry[k - 1], lcarry2[k - 1], 
+                &lcarry[k], &lcarry2[k], out);
+        }
+        carry = lcarry[MP_D2I_LANES - 1];
+        carry2 = lcarry2[MP_D2I_LANES - 1];
+    } else {
+        len = 0;
+    }
+    for (j = ndata - MP_D2I_LANES * len; j > 1; j--) {
         x = d1_radix2 * (scale * din[j - shift] + carry + 0.5);
         carry = carry2;
         carry2 = ((int) x) - 1;
@@ -1419,6 +2287,32 @@ void mp_mul_d2i(int n, int radix, int nfft, double din[], int out[])
 }
 
 
+void mp_mul_d2i_fix(int radix, int j, int jend, int carry, 
+        int carry2, int *lcarry, int *lcarry2, int out[])
+{
+    int x, q;
+    
+    /* ---- carry + radix * carry2 into out[j + 1] (digit j), 
+            propagated down to digit jend; the rest goes to 
+            the carries of the lane ---- */
+    while (j >= jend && (carry != 0 || carry2 != 0)) {
+        x = out[j + 1] + carry;
+        q = x / radix;
+        if (x < q * radix) {
+            q--;
+        }
+        out[j + 1] = x - q * radix;
+        carry = carry2 + q;
+        carry2 = 0;
+        j--;
+    }
+    if (j < jend) {
+        *lcarry += carry;
+        *lcarry2 += carry2;
+    }
+}
+
+
 double mp_mul_d2i_test(int radix, int nfft, double din[])
 {
     int j, carry, carry1, carry2;
@@ -1456,18 +2350,742 @@ double mp_mul_d2i_test(int radix, int nfft, double din[])
 }
 
 
+/* -------- mp_mul NTT routines -------- */
+/*
+    Exact cyclic convolution of length nfft by the number theoretic 
+    transforms modulo three primes p_k < 2^31 (Montgomery products of 
+    64 bits) and the Chinese remainder theorem (Garner), in place of 
+    rdft when mp_ntt_init(nfft) has been called.  The convolution is 
+    exact while 2 * (nfft + 2) * radix^2 < p0 * p1 * p2 (about 1.7e27, 
+    radix = 10^9 for any nfft <= 2^26).  The transforms are radix 4 
+    (one radix 2 pass for odd log2(nfft)): the passes over more than 
+    MP_NTT_BLOCK elements are split over the mp_threads by butterflies, 
+    the rest is done block by block, the blocks of the three primes 
+    split over the mp_threads.  The backward transform (mp_ntt_dit) 
+    uses the forward twiddles too: it gives the convolution at 
+    element (nfft - j) mod nfft, read so by mp_ntt_crt.
+    data of mp_mul_i2n, ..., mp_mul_n2i (struct mp_mul_buf d):
+        d->hd[0]          : exponent
+        d->hd[1]          : sign * top digit (products)
+        d->a[k*nfft+j]    : element j of mp_mul_i2d (d[j+1]) modulo 
+                            p_k, in the bit reversed order after the 
+                            forward transform
+*/
+
+
+#define MP_NTT_P0 2013265921U  /* 15 * 2^27 + 1, primitive root 31 */
+#define MP_NTT_P1 469762049U   /* 7 * 2^26 + 1, primitive root 3 */
+#define MP_NTT_P2 1811939329U  /* 27 * 2^26 + 1, primitive root 13 */
+#define MP_NTT_NMAX (1 << 26)
+#ifndef MP_NTT_BLOCK
+#define MP_NTT_BLOCK 16384  /* elements of one prime in the cache */
+#endif
+
+unsigned int mp_ntt_p[3] = {MP_NTT_P0, MP_NTT_P1, MP_NTT_P2};
+unsigned int mp_ntt_g[3] = {31, 3, 13};
+
+
+/* ---- one transform of the three primes: pass r (radix 4, 2; 
+        0: the blocks of nb) of span m, split into nchunk ranges ---- */
+struct mp_ntt_job {
+    int nchunk;
+    int n;
+    int nb;
+    int isgn;
+    int r;
+    int m;
+    unsigned int *a;
+};
+
+
+int mp_ntt_init(int nfft)
+{
+    unsigned int mp_ntt_pow(unsigned int x, unsigned int e, unsigned int p);
+    unsigned int mp_ntt_mont(unsigned int x, unsigned int p);
+    int k, m, j;
+    unsigned int p, wm, wj;
+    
+    mp_ntt.use = 0;
+    if (nfft <= 0) {
+        return 0;
+    }
+    if (nfft > MP_NTT_NMAX) {
+        return -1;
+    }
+    if (nfft > mp_ntt.nmax) {
+        free(mp_ntt.w);
+        mp_ntt.nmax = 0;
+        mp_ntt.w = (unsigned int *) malloc(3 * (size_t) nfft * 
+                sizeof(unsigned int));
+        if (mp_ntt.w == NULL) {
+            return -1;
+        }
+        /* w[k*nmax+m+j] = exp(2*pi*i*j/(2*m)) mod p_k, 0<=j<m 
+           (Montgomery form, x * 2^32 mod p_k) */
+        for (k = 0; k < 3; k++) {
+            p = mp_ntt_p[k];
+            for (m = 1; m < nfft; m <<= 1) {
+                wm = mp_ntt_pow(mp_ntt_g[k], (p - 1) / (2 * m), p);
+                wj = 1;
+                for (j = 0; j < m; j++) {
+                    mp_ntt.w[k * nfft + m + j] = mp_ntt_mont(wj, p);
+                    wj = (unsigned int) ((unsigned long long) wj * wm % p);
+                }
+            }
+        }
+        mp_ntt.nmax = nfft;
+    }
+    mp_ntt.use = 1;
+    return 0;
+}
+
+
+double mp_ntt_radix_test(int nfft, int radix)
+{
+    return 2.0 * (nfft + 2) * radix * radix / 
+        ((double) MP_NTT_P0 * MP_NTT_P1 * MP_NTT_P2);
+}
+
+
+void mp_mul_i2n(int n, int radix, int nfft, int shift, 
+        int in[], struct mp_mul_buf *dout)
+{
+    void mp_ntt_set(int nfft, unsigned int a[], int j, int x);
+    void mp_ntt_fft(int n, int isgn, unsigned int a[]);
+    int j, k, x, carry, ndata, radix_2, topdgt;
+    long long *hd;
+    unsigned int *a;
+    
+    hd = dout->hd;
+    a = dout->a;
+    ndata = 0;
+    topdgt = 0;
+    if (n > shift) {
+        topdgt = in[shift + 2];
+        ndata = (nfft >> 1) + 1;
+        if (ndata > n - shift) {
+            ndata = n - shift;
+        }
+    }
+    hd[0] = in[1] - shift;
+    hd[1] = (long long) in[0] * topdgt;
+    for (k = 0; k < 3; k++) {
+        for (j = nfft - 1; j >= ndata; j--) {
+            a[k * nfft + j] = 0;
+        }
+    }
+    /* ---- the digits of mp_mul_i2d, abs(x) <= radix/2 ---- */
+    if (ndata > 1) {
+        radix_2 = radix / 2;
+        carry = 0;
+        for (j = ndata + 1; j > 3; j--) {
+            x = in[j + shift];
+            mp_ntt_set(nfft, a, j - 2, 
+                x + carry - (x >= radix_2 ? radix : 0));
+            carry = x >= radix_2 ? 1 : 0;
+        }
+        mp_ntt_set(nfft, a, 1, in[shift + 3] + carry);
+    }
+    mp_ntt_set(nfft, a, 0, topdgt);
+    mp_ntt_fft(nfft, 1, a);
+}
+
+
+void mp_mul_nmul(int nfft, struct mp_mul_buf *din1, 
+        struct mp_mul_buf *din2, struct mp_mul_buf *dinout)
+{
+    unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+            unsigned int p, unsigned int pinv);
+    unsigned int mp_ntt_pinv(unsigned int p);
+    int j, k;
+    unsigned int *a1, *a2, *a, p, pinv;
+    
+    dinout->hd[0] = din1->hd[0] + din2->hd[0];
+    dinout->hd[1] = din1->hd[1] * din2->hd[1];
+    a1 = din1->a;
+    a2 = din2->a;
+    a = dinout->a;
+    for (k = 0; k < 3; k++) {
+        p = mp_ntt_p[k];
+        pinv = mp_ntt_pinv(p);
+        for (j = k * nfft; j < (k + 1) * nfft; j++) {
+            a[j] = mp_ntt_mul(a1[j], a2[j], p, pinv);
+        }
+    }
+}
+
+
+void mp_mul_nmuladd(int nfft, struct mp_mul_buf *din1, 
+        struct mp_mul_buf *din2, struct mp_mul_buf *dinout)
+{
+    unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+            unsigned int p, unsigned int pinv);
+    unsigned int mp_ntt_pinv(unsigned int p);
+    int j, k;
+    unsigned int *a1, *a2, *a, p, pinv, x;
+    
+    dinout->hd[1] += din1->hd[1] * din2->hd[1];
+    a1 = din1->a;
+    a2 = din2->a;
+    a = dinout->a;
+    for (k = 0; k < 3; k++) {
+        p = mp_ntt_p[k];
+        pinv = mp_ntt_pinv(p);
+        for (j = k * nfft; j < (k + 1) * nfft; j++) {
+            x = a[j] + mp_ntt_mul(a1[j], a2[j], p, pinv);
+            a[j] = x >= p ? x - p : x;
+        }
+    }
+}
+
+
+void mp_mul_n2i(int n, int radix, int nfft, struct mp_mul_buf *din, int out[])
+{
+    void mp_ntt_fft(int n, int isgn, unsigned int a[]);
+    void mp_ntt_crt(int nfft, unsigned int a[], int j, unsigned int s[], 
+            long long radix, long long *q, long long *r);
+    unsigned int mp_ntt_pow(unsigned int x, unsigned int e, unsigned int p);
+    unsigned int mp_ntt_pinv(unsigned int p);
+    unsigned int mp_ntt_mont(unsigned int x, unsigned int p);
+    int j, k, shift, last;
+    long long *hd, q, r, q0, r0, tq, tr, carry, t, lr;
+    unsigned int *a, p, sc[9];
+    unsigned long long top;
+    
+    hd = din->hd;
+    a = din->a;
+    mp_ntt_fft(nfft, -1, a);
+    for (k = 0; k < 3; k++) {
+        /* 2^64/nfft: the 1/nfft of the inverse and the 2^-32 of the 
+           Montgomery product of the spectra */
+        p = mp_ntt_p[k];
+        sc[k] = mp_ntt_mont(mp_ntt_mont(mp_ntt_pow(nfft, p - 2, p), p), p);
+        sc[3 + k] = mp_ntt_pinv(p);
+    }
+    /* the Garner constants 1/p0 mod p1, 1/p0 mod p2, 1/p1 mod p2 
+       (Montgomery form) */
+    sc[6] = mp_ntt_mont(mp_ntt_pow(MP_NTT_P0, MP_NTT_P1 - 2, MP_NTT_P1), 
+            MP_NTT_P1);
+    sc[7] = mp_ntt_mont(mp_ntt_pow(MP_NTT_P0, MP_NTT_P2 - 2, MP_NTT_P2), 
+            MP_NTT_P2);
+    sc[8] = mp_ntt_mont(mp_ntt_pow(MP_NTT_P1, MP_NTT_P2 - 2, MP_NTT_P2), 
+            MP_NTT_P2);
+    /* ---- correction of cyclic convolution of element 0 ---- */
+    top = hd[1] < 0 ? -hd[1] : hd[1];
+    tq = (long long) (top / radix);
+    tr = (long long) (top % radix);
+    mp_ntt_crt(nfft, a, 0, sc, radix, &q0, &r0);
+    q0 -= tq;
+    r0 -= tr;
+    if (r0 < 0) {
+        r0 += radix;
+        q0--;
+    }
+    /* ---- output of digits: element j to out[j + 2 + shift] ---- */
+    shift = top >= (unsigned long long) radix ? 1 : 0;
+    for (j = n + 1; j > nfft + 2 + shift; j--) {
+        out[j] = 0;
+    }
+    last = 0;
+    carry = 0;
+    for (j = nfft; j >= 0; j--) {
+        if (j == nfft) {
+            q = q0;
+            r = r0;
+        } else if (j == 0) {
+            q = tq;
+            r = tr;
+        } else {
+            mp_ntt_crt(nfft, a, j, sc, radix, &q, &r);
+        }
+        t = r + carry;
+        lr = t / radix;
+        t -= lr * radix;
+        if (t < 0) {
+            t += radix;
+            lr--;
+        }
+        carry = q + lr;
+        if (j + 2 + shift <= n + 1) {
+            out[j + 2 + shift] = (int) t;
+        } else if (j + 2 + shift == n + 2) {
+            last = (int) t;
+        }
+    }
+    if (shift == 0 && carry > 0) {
+        for (j = n + 1; j > 2; j--) {
+            out[j] = out[j - 1];
+        }
+        out[2] = (int) carry;
+        shift = 1;
+    } else if (shift > 0) {
+        out[2] = (int) carry;
+        if (carry == 0) {
+            for (j = 2; j < n + 1; j++) {
+                out[j] = out[j + 1];
+            }
+            out[n + 1] = last;
+            shift = 0;
+        }
+    }
+    /* ---- output of exp, sgn ---- */
+    out[1] = (int) hd[0] + shift;
+    out[0] = hd[1] > 0 ? 1 : -1;
+    if (out[2] == 0) {
+        out[0] = 0;
+        out[1] = 0;
+    }
+}
+
+
+void mp_ntt_fft(int n, int isgn, unsigned int a[])
+{
+    int mp_threads_split(int n);
+    void mp_ntt_pass(struct mp_ntt_job *job, int nchunk, int r, int m);
+    struct mp_ntt_job job;
+    int nchunk, m;
+    
+    /* ---- isgn >= 0: mp_ntt_dif, else mp_ntt_dit of the three 
+            primes a[k * n ... k * n + n - 1] ---- */
+    nchunk = mp_threads_split(3 * n);
+    job.n = n;
+    job.nb = n < MP_NTT_BLOCK ? n : MP_NTT_BLOCK;
+    job.isgn = isgn;
+    job.a = a;
+    if (isgn < 0) {
+        mp_ntt_pass(&job, nchunk, 0, 0);
+    }
+    /* ---- the passes of span >= nb (mp_ntt_dif, mp_ntt_dit of n/nb 
+            points of nb apart) ---- */
+    for (m = job.nb; 4 * m <= n; m *= 4);
+    if (isgn >= 0) {
+        if (m < n) {
+            mp_ntt_pass(&job, nchunk, 2, n >> 1);
+        }
+        for (m >>= 2; m >= job.nb; m >>= 2) {
+            mp_ntt_pass(&job, nchunk, 4, m);
+        }
+        mp_ntt_pass(&job, nchunk, 0, 0);
+    } else {
+        for (m = job.nb; 4 * m <= n; m *= 4) {
+            mp_ntt_pass(&job, nchunk, 4, m);
+        }
+        if (m < n) {
+            mp_ntt_pass(&job, nchunk, 2, m);
+        }
+    }
+}
+
+
+/* -------- mp_mul NTT child routines -------- */
+
+
+unsigned int mp_ntt_pow(unsigned int x, unsigned int e, unsigned int p)
+{
+    unsigned long long y, z;
+    
+    y = 1;
+    z = x % p;
+    while (e > 0) {
+        if (e & 1) {
+            y = y * z % p;
+        }
+        z = z * z % p;
+        e >>= 1;
+    }
+    return (unsigned int) y;
+}
+
+
+unsigned int mp_ntt_pinv(unsigned int p)
+{
+    int i;
+    unsigned int x;
+    
+    /* ---- -1/p mod 2^32 (Newton) ---- */
+    x = p;
+    for (i = 0; i < 5; i++) {
+        x *= 2 - p * x;
+    }
+    return -x;
+}
+
+
+unsigned int mp_ntt_mont(unsigned int x, unsigned int p)
+{
+    /* ---- x * 2^32 mod p (Montgomery form) ---- */
+    return (unsigned int) (((unsigned long long) x << 32) % p);
+}
+
+
+unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+        unsigned int p, unsigned int pinv)
+{
+    unsigned long long t;
+    unsigned int z;
+    
+    /* ---- x * y / 2^32 mod p, x * y < p * 2^32 ---- */
+    t = (unsigned long long) x * y;
+    z = (unsigned int) ((t + (unsigned long long) ((unsigned int) t * pinv) 
+            * p) >> 32);
+    return z >= p ? z - p : z;
+}
+
+
+void mp_ntt_set(int nfft, unsigned int a[], int j, int x)
+{
+    int k, y;
+    
+    for (k = 0; k < 3; k++) {
+        y = x % (int) mp_ntt_p[k];
+        a[k * nfft + j] = y < 0 ? y + mp_ntt_p[k] : y;
+    }
+}
+
+
+void mp_ntt_pass(struct mp_ntt_job *job, int nchunk, int r, int m)
+{
+    void mp_threads_exec(int nchunk, void (*func)(void *arg, int k), 
+            void *arg);
+    void mp_ntt_pass_chunk(void *arg, int k);
+    int nitem;
+    
+    nitem = 3 * (r == 0 ? job->n / job->nb : job->n / r);
+    job->nchunk = nchunk < nitem ? nchunk : nitem;
+    job->r = r;
+    job->m = m;
+    mp_threads_exec(job->nchunk, mp_ntt_pass_chunk, job);
+}
+
+
+void mp_ntt_pass_chunk(void *arg, int k)
+{
+    void mp_ntt_dif(int n, unsigned int a[], int k);
+    void mp_ntt_dit(int n, unsigned int a[], int k);
+    void mp_ntt_dif2(int m, int i0, int i1, unsigned int a[], int k);
+    void mp_ntt_dit2(int m, int i0, int i1, unsigned int a[], int k);
+    void mp_ntt_dif4(int m, int i0, int i1, unsigned int a[], int k);
+    void mp_ntt_dit4(int m, int i0, int i1, unsigned int a[], int k);
+    struct mp_ntt_job *job = (struct mp_ntt_job *) arg;
+    int n, nitem, i, i0, i1, kp, b0, b1;
+    unsigned int *a;
+    
+    /* ---- items i0...i1-1 of the pass, nitem of each prime ---- */
+    n = job->n;
+    nitem = job->r == 0 ? n / job->nb : n / job->r;
+    i0 = (int) ((long long) 3 * nitem * k / job->nchunk);
+    i1 = (int) ((long long) 3 * nitem * (k + 1) / job->nchunk);
+    for (kp = i0 / nitem; kp < 3 && kp * nitem < i1; kp++) {
+        b0 = i0 > kp * nitem ? i0 - kp * nitem : 0;
+        b1 = i1 < (kp + 1) * nitem ? i1 - kp * nitem : nitem;
+        a = &job->a[kp * n];
+        if (job->r == 0) {
+            for (i = b0; i < b1; i++) {
+                if (job->isgn >= 0) {
+                    mp_ntt_dif(job->nb, &a[i * job->nb], kp);
+                } else {
+                    mp_ntt_dit(job->nb, &a[i * job->nb], kp);
+                }
+            }
+        } else if (job->r == 4) {
+            if (job->isgn >= 0) {
+                mp_ntt_dif4(job->m, b0, b1, a, kp);
+            } else {
+                mp_ntt_dit4(job->m, b0, b1, a, kp);
+            }
+        } else {
+            if (job->isgn >= 0) {
+                mp_ntt_dif2(job->m, b0, b1, a, kp);
+            } else {
+                mp_ntt_dit2(job->m, b0, b1, a, kp);
+            }
+        }
+    }
+}
+
+
+void mp_ntt_dif(int n, unsigned int a[], int k)
+{
+    void mp_ntt_dif2(int m, int i0, int i1, unsigned int a[], int k);
+    void mp_ntt_dif4(int m, int i0, int i1, unsigned int a[], int k);
+    int m;
+    
+    for (m = 1; 4 * m <= n; m *= 4);
+    if (m < n) {
+        mp_ntt_dif2(n >> 1, 0, n >> 1, a, k);
+    }
+    for (m >>= 2; m >= 1; m >>= 2) {
+        mp_ntt_dif4(m, 0, n >> 2, a, k);
+    }
+}
+
+
+void mp_ntt_dit(int n, unsigned int a[], int k)
+{
+    void mp_ntt_dit2(int m, int i0, int i1, unsigned int a[], int k);
+    void mp_ntt_dit4(int m, int i0, int i1, unsigned int a[], int k);
+    int m;
+    
+    for (m = 1; 4 * m <= n; m *= 4) {
+        mp_ntt_dit4(m, 0, n >> 2, a, k);
+    }
+    if (m < n) {
+        mp_ntt_dit2(m, 0, n >> 1, a, k);
+    }
+}
+
+
+void mp_ntt_dif2(int m, int i0, int i1, unsigned int a[], int k)
+{
+    unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+            unsigned int p, unsigned int pinv);
+    unsigned int mp_ntt_pinv(unsigned int p);
+    int i, j, l, jj, jn;
+    unsigned int p, pinv, x0, x1, *w;
+    
+    /* ---- butterflies i0...i1-1 of span m, butterfly i at 
+            j = l + jj (l = 2 * (i - jj), jj = i % m) ---- */
+    p = mp_ntt_p[k];
+    pinv = mp_ntt_pinv(p);
+    w = &mp_ntt.w[k * mp_ntt.nmax + m];
+    jj = i0 % m;
+    l = 2 * (i0 - jj);
+    for (i = i0; i < i1; i += jn, jj = 0, l += 2 * m) {
+        jn = m - jj < i1 - i ? m - jj : i1 - i;
+#ifdef __GNUC__
+#pragma GCC ivdep  /* a[j + m] is not a[j] */
+#endif
+        for (j = l + jj; j < l + jj + jn; j++) {
+            x0 = a[j] + a[j + m];
+            x1 = a[j] - a[j + m] + p;
+            a[j] = x0 >= p ? x0 - p : x0;
+            a[j + m] = mp_ntt_mul(x1, w[j - l], p, pinv);
+        }
+    }
+}
+
+
+void mp_ntt_dit2(int m, int i0, int i1, unsigned int a[], int k)
+{
+    unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+            unsigned int p, unsigned int pinv);
+    unsigned int mp_ntt_pinv(unsigned int p);
+    int i, j, l, jj, jn;
+    unsigned int p, pinv, x0, x1, *w;
+    
+    p = mp_ntt_p[k];
+    pinv = mp_ntt_pinv(p);
+    w = &mp_ntt.w[k * mp_ntt.nmax + m];
+    jj = i0 % m;
+    l = 2 * (i0 - jj);
+    for (i = i0; i < i1; i += jn, jj = 0, l += 2 * m) {
+        jn = m - jj < i1 - i ? m - jj : i1 - i;
+#ifdef __GNUC__
+#pragma GCC ivdep  /* a[j + m] is not a[j] */
+#endif
+        for (j = l + jj; j < l + jj + jn; j++) {
+            x1 = mp_ntt_mul(a[j + m], w[j - l], p, pinv);
+            x0 = a[j] + x1;
+            x1 = a[j] - x1 + p;
+            a[j] = x0 >= p ? x0 - p : x0;
+            a[j + m] = x1 >= p ? x1 - p : x1;
+        }
+    }
+}
+
+
+void mp_ntt_dif4(int m, int i0, int i1, unsigned int a[], int k)
+{
+    unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+            unsigned int p, unsigned int pinv);
+    unsigned int mp_ntt_pinv(unsigned int p);
+    int i, j, l, jj, jn;
+    unsigned int p, pinv, x0, x1, x2, x3, y0, y1, y2, y3, *w;
+    
+    /* ---- the radix 2 passes of span 2 * m and m in one: 
+            butterflies i0...i1-1 at j = l + jj (l = 4 * (i - jj)) ---- */
+    p = mp_ntt_p[k];
+    pinv = mp_ntt_pinv(p);
+    w = &mp_ntt.w[k * mp_ntt.nmax];
+    if (m == 1) {
+        /* ---- the twiddles 1, 1, w[3]: one product ---- */
+        for (l = 4 * i0; l < 4 * i1; l += 4) {
+            x0 = a[l];
+            x1 = a[l + 1];
+            x2 = a[l + 2];
+            x3 = a[l + 3];
+            y0 = x0 + x2;
+            y0 = y0 >= p ? y0 - p : y0;
+            y2 = x0 - x2 + p;
+            y2 = y2 >= p ? y2 - p : y2;
+            y1 = x1 + x3;
+            y1 = y1 >= p ? y1 - p : y1;
+            y3 = mp_ntt_mul(x1 - x3 + p, w[3], p, pinv);
+            x0 = y0 + y1;
+            a[l] = x0 >= p ? x0 - p : x0;
+            x1 = y0 - y1 + p;
+            a[l + 1] = x1 >= p ? x1 - p : x1;
+            x2 = y2 + y3;
+            a[l + 2] = x2 >= p ? x2 - p : x2;
+            x3 = y2 - y3 + p;
+            a[l + 3] = x3 >= p ? x3 - p : x3;
+        }
+        return;
+    }
+    jj = i0 % m;
+    l = 4 * (i0 - jj);
+    for (i = i0; i < i1; i += jn, jj = 0, l += 4 * m) {
+        jn = m - jj < i1 - i ? m - jj : i1 - i;
+#ifdef __GNUC__
+#pragma GCC ivdep  /* a[j + m] is not a[j] */
+#endif
+        for (j = l + jj; j < l + jj + jn; j++) {
+            x0 = a[j];
+            x1 = a[j + m];
+            x2 = a[j + 2 * m];
+            x3 = a[j + 3 * m];
+            y0 = x0 + x2;
+            y0 = y0 >= p ? y0 - p : y0;
+            y2 = mp_ntt_mul(x0 - x2 + p, w[2 * m + j - l], p, pinv);
+            y1 = x1 + x3;
+            y1 = y1 >= p ? y1 - p : y1;
+            y3 = mp_ntt_mul(x1 - x3 + p, w[3 * m + j - l], p, pinv);
+            x0 = y0 + y1;
+            a[j] = x0 >= p ? x0 - p : x0;
+            a[j + m] = mp_ntt_mul(y0 - y1 + p, w[m + j - l], p, pinv);
+            x2 = y2 + y3;
+            a[j + 2 * m] = x2 >= p ? x2 - p : x2;
+            a[j + 3 * m] = mp_ntt_mul(y2 - y3 + p, w[m + j - l], p, pinv);
+        }
+    }
+}
+
+
+void mp_ntt_dit4(int m, int i0, int i1, unsigned int a[], int k)
+{
+    unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+            unsigned int p, unsigned int pinv);
+    unsigned int mp_ntt_pinv(unsigned int p);
+    int i, j, l, jj, jn;
+    unsigned int p, pinv, x0, x1, x2, x3, y0, y1, y2, y3, t, *w;
+    
+    /* ---- the radix 2 passes of span m and 2 * m in one ---- */
+    p = mp_ntt_p[k];
+    pinv = mp_ntt_pinv(p);
+    w = &mp_ntt.w[k * mp_ntt.nmax];
+    if (m == 1) {
+        /* ---- the twiddles 1, 1, w[3]: one product ---- */
+        for (l = 4 * i0; l < 4 * i1; l += 4) {
+            x0 = a[l];
+            x1 = a[l + 1];
+            x2 = a[l + 2];
+            x3 = a[l + 3];
+            y0 = x0 + x1;
+            y0 = y0 >= p ? y0 - p : y0;
+            y1 = x0 - x1 + p;
+            y1 = y1 >= p ? y1 - p : y1;
+            y2 = x2 + x3;
+            y2 = y2 >= p ? y2 - p : y2;
+            y3 = x2 - x3 + p;
+            t = mp_ntt_mul(y3, w[3], p, pinv);
+            x0 = y0 + y2;
+            a[l] = x0 >= p ? x0 - p : x0;
+            x2 = y0 - y2 + p;
+            a[l + 2] = x2 >= p ? x2 - p : x2;
+            x1 = y1 + t;
+            a[l + 1] = x1 >= p ? x1 - p : x1;
+            x3 = y1 - t + p;
+            a[l + 3] = x3 >= p ? x3 - p : x3;
+        }
+        return;
+    }
+    jj = i0 % m;
+    l = 4 * (i0 - jj);
+    for (i = i0; i < i1; i += jn, jj = 0, l += 4 * m) {
+        jn = m - jj < i1 - i ? m - jj : i1 - i;
+#ifdef __GNUC__
+#pragma GCC ivdep  /* a[j + m] is not a[j] */
+#endif
+        for (j = l + jj; j < l + jj + jn; j++) {
+            x0 = a[j];
+            t = mp_ntt_mul(a[j + m], w[m + j - l], p, pinv);
+            y0 = x0 + t;
+            y0 = y0 >= p ? y0 - p : y0;
+            y1 = x0 - t + p;
+            y1 = y1 >= p ? y1 - p : y1;
+            x2 = a[j + 2 * m];
+            t = mp_ntt_mul(a[j + 3 * m], w[m + j - l], p, pinv);
+            y2 = x2 + t;
+            y2 = y2 >= p ? y2 - p : y2;
+            y3 = x2 - t + p;
+            t = mp_ntt_mul(y2, w[2 * m + j - l], p, pinv);
+            x0 = y0 + t;
+            a[j] = x0 >= p ? x0 - p : x0;
+            x2 = y0 - t + p;
+            a[j + 2 * m] = x2 >= p ? x2 - p : x2;
+            t = mp_ntt_mul(y3, w[3 * m + j - l], p, pinv);
+            x1 = y1 + t;
+            a[j + m] = x1 >= p ? x1 - p : x1;
+            x3 = y1 - t + p;
+            a[j + 3 * m] = x3 >= p ? x3 - p : x3;
+        }
+    }
+}
+
+
+void mp_ntt_crt(int nfft, unsigned int a[], int j, unsigned int s[], 
+        long long radix, long long *q, long long *r)
+{
+    unsigned int mp_ntt_mul(unsigned int x, unsigned int y, 
+            unsigned int p, unsigned int pinv);
+    int jr;
+    unsigned int x0, x1, x2, x3, v1, v2;
+    unsigned long long y, u;
+    long long z, zq;
+    
+    /* ---- the inverse is the forward dit read backward ---- */
+    jr = (nfft - j) & (nfft - 1);
+    /* ---- s[0...2]: scale, s[3...5]: pinv, s[6...8]: Garner ---- */
+    x0 = mp_ntt_mul(a[jr], s[0], MP_NTT_P0, s[3]);
+    x1 = mp_ntt_mul(a[nfft + jr], s[1], MP_NTT_P1, s[4]);
+    x2 = mp_ntt_mul(a[2 * nfft + jr], s[2], MP_NTT_P2, s[5]);
+    /* ---- x = x0 + p0 * (v1 + p1 * v2) (Garner): x0 < 5 * p1, 
+            x0 < 2 * p2, the products < p * 2^32 ---- */
+    v1 = mp_ntt_mul(x1 + 5 * MP_NTT_P1 - x0, s[6], MP_NTT_P1, s[4]);
+    x3 = x0 >= MP_NTT_P2 ? x0 - MP_NTT_P2 : x0;
+    v2 = mp_ntt_mul(x2 + MP_NTT_P2 - x3, s[7], MP_NTT_P2, s[5]);
+    v2 = mp_ntt_mul(v2 + MP_NTT_P2 - v1, s[8], MP_NTT_P2, s[5]);
+    y = v1 + (unsigned long long) MP_NTT_P1 * v2;
+    /* ---- x - p0 * p1 * p2 if x > p0 * p1 * p2 / 2 ---- */
+    z = (long long) y;
+    if (y > (unsigned long long) MP_NTT_P1 * MP_NTT_P2 / 2) {
+        z = (long long) (y - (unsigned long long) MP_NTT_P1 * MP_NTT_P2);
+    }
+    /* ---- x = q * radix + r, 0 <= r < radix (q in 64 bits) ---- */
+    zq = z / radix;
+    if (z - zq * radix < 0) {
+        zq--;
+    }
+    u = x0 + (unsigned long long) MP_NTT_P0 * (unsigned long long) 
+        (z - zq * radix);
+    *q = (long long) ((unsigned long long) MP_NTT_P0 * 
+        (unsigned long long) zq + u / radix);
+    *r = (long long) (u % radix);
+}
+
+
 /* -------- mp_inv routines -------- */
 
 
-int mp_inv(int n, int radix, int in[], int out[], 
-        int tmp1[], int tmp2[], int nfft, 
-        double tmp1fft[], double tmp2fft[], int ip[], double w[])
+int mp_inv(int n, int radix, int in[], int out[], int tmp1[], int tmp2[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+        int ip[], double w[])
 {
     int mp_get_nfft_init(int radix, int nfft_max);
     void mp_inv_init(int n, int radix, int in[], int out[]);
     int mp_inv_newton(int n, int radix, int in[], int inout[], 
-            int tmp1[], int tmp2[], int nfft, double tmp1fft[], 
-            double tmp2fft[], int ip[], double w[]);
+            int tmp1[], int tmp2[], int nfft, struct mp_mul_buf *tmp1fft, 
+            struct mp_mul_buf *tmp2fft, int ip[], double w[]);
     int n_nwt, nfft_nwt, thr, prc;
     
     if (in[0] == 0) {
@@ -1503,17 +3121,18 @@ int mp_inv(int n, int radix, int in[], int out[],
 }
 
 
-int mp_sqrt(int n, int radix, int in[], int out[], 
-        int tmp1[], int tmp2[], int nfft, 
-        double tmp1fft[], double tmp2fft[], int ip[], double w[])
+int mp_sqrt(int n, int radix, int in[], int out[], int tmp1[], int tmp2[], 
+        int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+        int ip[], double w[])
 {
     void mp_load_0(int n, int radix, int out[]);
     int mp_get_nfft_init(int radix, int nfft_max);
     void mp_sqrt_init(int n, int radix, int in[], int out[], int out_rev[]);
     int mp_sqrt_newton(int n, int radix, int in[], int inout[], 
-            int inout_rev[], int tmp[], int nfft, double tmp1fft[], 
-            double tmp2fft[], int ip[], double w[], int *n_tmp1fft);
-    int n_nwt, nfft_nwt, thr, prc, n_tmp1fft;
+            int inout_rev[], int tmp[], int nfft, struct mp_fft *h, 
+            struct mp_mul_buf *tmp2fft, int ip[], double w[]);
+    int n_nwt, nfft_nwt, thr, prc;
+    struct mp_fft h = {NULL, 0, 0, NULL};
     
     if (in[0] < 0) {
         return -1;
@@ -1527,7 +3146,7 @@ int mp_sqrt(int n, int radix, int in[], int out[],
         n_nwt = n;
     }
     mp_sqrt_init(n_nwt, radix, in, out, tmp1);
-    n_tmp1fft = 0;
+    h.fft = tmp1fft;
     thr = 8;
     do {
         n_nwt = nfft_nwt + 2;
@@ -1535,8 +3154,7 @@ int mp_sqrt(int n, int radix, int in[], int out[],
             n_nwt = n;
         }
         prc = mp_sqrt_newton(n_nwt, radix, in, out, 
-                tmp1, tmp2, nfft_nwt, tmp1fft, tmp2fft, 
-                ip, w, &n_tmp1fft);
+                tmp1, tmp2, nfft_nwt, &h, tmp2fft, ip, w);
         if (thr * nfft_nwt >= nfft) {
             thr = 0;
             if (2 * prc <= n_nwt - 2) {
@@ -1655,21 +3273,20 @@ double mp_unexp_mp2d(int n, int radix, int in[])
 
 
 int mp_inv_newton(int n, int radix, int in[], int inout[], 
-        int tmp1[], int tmp2[], int nfft, double tmp1fft[], 
-        double tmp2fft[], int ip[], double w[])
+        int tmp1[], int tmp2[], int nfft, struct mp_mul_buf *tmp1fft, 
+        struct mp_mul_buf *tmp2fft, int ip[], double w[])
 {
     void mp_load_1(int n, int radix, int out[]);
     void mp_round(int n, int radix, int m, int inout[]);
     void mp_add(int n, int radix, int in1[], int in2[], int out[]);
     void mp_sub(int n, int radix, int in1[], int in2[], int out[]);
-    void mp_mulh(int n, int radix, int in1[], int in2[], int out[], 
-            int nfft, double in1fft[], double outfft[], 
-            int ip[], double w[]);
-    void mp_mulh_use_in1fft(int n, int radix, double in1fft[], 
-            int shift, int in2[], int out[], int nfft, double outfft[], 
-            int ip[], double w[]);
+    void mp_mulh_fft(int n, int radix, int in1[], struct mp_fft *h1, 
+            int shift, int in2[], int out[], int nfft, 
+            struct mp_mul_buf *outfft, int ip[], double w[]);
     int n_h, shift, prc;
+    struct mp_fft h = {NULL, 0, 0, NULL};
     
+    h.fft = tmp1fft;
     shift = (nfft >> 1) + 1;
     n_h = n / 2 + 1;
     if (n_h < n - shift) {
@@ -1677,13 +3294,13 @@ int mp_inv_newton(int n, int radix, int in[], int inout[],
     }
     /* ---- tmp1 = inout * (upper) in (half to normal precision) ---- */
     mp_round(n, radix, shift, inout);
-    mp_mulh(n, radix, inout, in, tmp1, 
-            nfft, tmp1fft, tmp2fft, ip, w);
+    mp_mulh_fft(n, radix, inout, &h, 0, in, tmp1, 
+            nfft, tmp2fft, ip, w);
     /* ---- tmp2 = 1 - tmp1 ---- */
     mp_load_1(n, radix, tmp2);
     mp_sub(n, radix, tmp2, tmp1, tmp2);
     /* ---- tmp2 -= inout * (lower) in (half precision) ---- */
-    mp_mulh_use_in1fft(n, radix, tmp1fft, shift, in, tmp1, 
+    mp_mulh_fft(n, radix, inout, &h, shift, in, tmp1, 
             nfft, tmp2fft, ip, w);
     mp_sub(n_h, radix, tmp2, tmp1, tmp2);
     /* ---- get precision ---- */
@@ -1692,7 +3309,7 @@ int mp_inv_newton(int n, int radix, int in[], int inout[],
         prc = nfft + 1;
     }
     /* ---- tmp2 *= inout (half precision) ---- */
-    mp_mulh_use_in1fft(n_h, radix, tmp1fft, 0, tmp2, tmp2, 
+    mp_mulh_fft(n_h, radix, inout, &h, 0, tmp2, tmp2, 
             nfft, tmp2fft, ip, w);
     /* ---- inout += tmp2 ---- */
     if (tmp2[0] != 0) {
@@ -1703,20 +3320,18 @@ int mp_inv_newton(int n, int radix, int in[], int inout[],
 
 
 int mp_sqrt_newton(int n, int radix, int in[], int inout[], 
-        int inout_rev[], int tmp[], int nfft, double tmp1fft[], 
-        double tmp2fft[], int ip[], double w[], int *n_tmp1fft)
+        int inout_rev[], int tmp[], int nfft, struct mp_fft *h, 
+        struct mp_mul_buf *tmp2fft, int ip[], double w[])
 {
     void mp_round(int n, int radix, int m, int inout[]);
     void mp_add(int n, int radix, int in1[], int in2[], int out[]);
     void mp_sub(int n, int radix, int in1[], int in2[], int out[]);
     void mp_idiv_2(int n, int radix, int in[], int out[]);
-    void mp_mulh(int n, int radix, int in1[], int in2[], int out[], 
-            int nfft, double in1fft[], double outfft[], 
-            int ip[], double w[]);
-    void mp_squh(int n, int radix, int in[], int out[], 
-            int nfft, double inoutfft[], int ip[], double w[]);
-    void mp_squh_use_in1fft(int n, int radix, double inoutfft[], int out[], 
-            int nfft, int ip[], double w[]);
+    void mp_mulh_fft(int n, int radix, int in1[], struct mp_fft *h1, 
+            int shift, int in2[], int out[], int nfft, 
+            struct mp_mul_buf *outfft, int ip[], double w[]);
+    void mp_squh_fft(int n, int radix, int in[], struct mp_fft *h, 
+            int out[], int nfft, int ip[], double w[]);
     int n_h, nfft_h, shift, prc;
     
     nfft_h = nfft >> 1;
@@ -1730,23 +3345,16 @@ int mp_sqrt_newton(int n, int radix, int in[], int inout[],
     }
     /* ---- tmp = inout_rev^2 (1/4 to half precision) ---- */
     mp_round(n_h, radix, (nfft_h >> 1) + 1, inout_rev);
-    if (*n_tmp1fft != nfft_h) {
-        mp_squh(n_h, radix, inout_rev, tmp, 
-                nfft_h, tmp1fft, ip, w);
-    } else {
-        mp_squh_use_in1fft(n_h, radix, tmp1fft, tmp, 
-                nfft_h, ip, w);
-    }
+    mp_squh_fft(n_h, radix, inout_rev, h, tmp, nfft_h, ip, w);
     /* ---- tmp = inout_rev - inout * tmp (half precision) ---- */
     mp_round(n, radix, shift, inout);
-    mp_mulh(n_h, radix, inout, tmp, tmp, 
-            nfft, tmp1fft, tmp2fft, ip, w);
+    mp_mulh_fft(n_h, radix, inout, h, 0, tmp, tmp, 
+            nfft, tmp2fft, ip, w);
     mp_sub(n_h, radix, inout_rev, tmp, tmp);
     /* ---- inout_rev += tmp ---- */
     mp_add(n_h, radix, inout_rev, tmp, inout_rev);
     /* ---- tmp = in - inout^2 (half to normal precision) ---- */
-    mp_squh_use_in1fft(n, radix, tmp1fft, tmp, 
-            nfft, ip, w);
+    mp_squh_fft(n, radix, inout, h, tmp, nfft, ip, w);
     mp_sub(n, radix, in, tmp, tmp);
     /* ---- get precision ---- */
     prc = in[1] - tmp[1];
@@ -1758,9 +3366,8 @@ int mp_sqrt_newton(int n, int radix, int in[], int inout[],
     }
     /* ---- tmp = tmp * inout_rev / 2 (half precision) ---- */
     mp_round(n_h, radix, shift, inout_rev);
-    mp_mulh(n_h, radix, inout_rev, tmp, tmp, 
-            nfft, tmp1fft, tmp2fft, ip, w);
-    *n_tmp1fft = nfft;
+    mp_mulh_fft(n_h, radix, inout_rev, h, 0, tmp, tmp, 
+            nfft, tmp2fft, ip, w);
     mp_idiv_2(n_h, radix, tmp, tmp);
     /* ---- inout += tmp ---- */
     if (tmp[0] != 0) {
@@ -1936,3 +3543,222 @@ void mp_fprintf(int n, int log10_radix, int in[], FILE *fout)
 }
 
 
+/* -------- mp_bin2dec routines -------- */
+/*
+    out (radix 10^log10_radix, n_dec digits) = in (radix R = 2^k, n digits)
+        in = R^(in[1] + 1 - M) * N, 
+        N = in[2] * R^(M-1) + in[3] * R^(M-2) + ... (integer, M >= n)
+    N is converted exactly by a divide and conquer of its digits:
+        N(j0, 2*m) = N(j0, m) * R^m + N(j0 + m, m), 
+    from blocks of MP_B2D_BLOCK digits (Horner's rule), with FFT 
+    multiplies of length <= nfft (n_dec <= nfft).  The upper levels 
+    are rounded to n_dec + 2 digits (each part of N is <= N).  Then 
+    N is multiplied by 1 / R^M (mp_inv) and R^(in[1] + 1).
+    return: 0 (-1: radix is not a power of 2, n_dec > nfft, 
+               or allocation failure)
+*/
+
+
+#define MP_B2D_BLOCK 32
+
+
+int mp_bin2dec(int n, int radix, int in[], int n_dec, int log10_radix, 
+        int out[], int tmp[], int nfft, struct mp_mul_buf *tmp1fft, 
+        struct mp_mul_buf *tmp2fft, struct mp_mul_buf *tmp3fft, int ip[], 
+        double w[])
+{
+    void mp_load_0(int n, int radix, int out[]);
+    void mp_load_1(int n, int radix, int out[]);
+    void mp_add(int n, int radix, int in1[], int in2[], int out[]);
+    void mp_imul(int n, int radix, int in1[], int in2, int out[]);
+    void mp_mul(int n, int radix, int in1[], int in2[], int out[], int tmp[], 
+            int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+            struct mp_mul_buf *tmp3fft, int ip[], double w[]);
+    void mp_squ(int n, int radix, int in[], int out[], int tmp[], 
+            int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+            int ip[], double w[]);
+    int mp_inv(int n, int radix, int in[], int out[], int tmp1[], int tmp2[], 
+            int nfft, struct mp_mul_buf *tmp1fft, struct mp_mul_buf *tmp2fft, 
+            int ip[], double w[]);
+    int mp_bin2dec_prc(double f, int m, int n_dec);
+    int mp_bin2dec_nfft(int n);
+    void mp_bin2dec_pow2(int n, int radix, int inout[], int e);
+    void mp_bin2dec_ext(int p, int q, int in[], int out[]);
+    int radix_dec, log2_radix, m, nb, nt, t, i, j, p, q, s0, s, np, nf;
+    int *lv, *pw, *pt, *x, *y, *z, *in1, *in2;
+    double f;
+    
+    radix_dec = 1;
+    for (j = 0; j < log10_radix; j++) {
+        radix_dec *= 10;
+    }
+    for (log2_radix = 0; (1 << log2_radix) < radix; log2_radix++);
+    if ((1 << log2_radix) != radix || n_dec > nfft) {
+        return -1;
+    }
+    if (in[0] == 0) {
+        mp_load_0(n_dec, radix_dec, out);
+        return 0;
+    }
+    /* ---- decimal digits per binary digit, blocks, levels ---- */
+    f = log2_radix * log10(2.0) / log10_radix;
+    m = MP_B2D_BLOCK;
+    nb = 1;
+    nt = 0;
+    while (nb * m < n) {
+        nb <<= 1;
+        nt++;
+    }
+    nf = n_dec + 2;
+    s0 = mp_bin2dec_prc(f, m, n_dec) + 2;
+    np = 0;
+    for (t = 1; t <= nt; t++) {
+        np += mp_bin2dec_prc(f, m << t, n_dec) + 2;
+    }
+    lv = (int *) malloc(((size_t) nb * s0 + np + 3 * (nf + 2)) * 
+            sizeof(int));
+    if (lv == NULL) {
+        return -1;
+    }
+    pw = &lv[(size_t) nb * s0];
+    x = &pw[np];
+    y = &x[nf + 2];
+    z = &y[nf + 2];
+    /* ---- blocks: N = N * R + in[j] (j = j0, ..., j0+m-1) ---- */
+    p = s0 - 2;
+    for (i = 0; i < nb; i++) {
+        pt = &lv[(size_t) i * s0];
+        mp_load_0(p, radix_dec, pt);
+        for (j = i * m; j < i * m + m; j++) {
+            mp_bin2dec_pow2(p, radix_dec, pt, log2_radix);
+            if (j < n && in[j + 2] != 0) {
+                mp_load_1(p, radix_dec, y);
+                mp_imul(p, radix_dec, y, in[j + 2], y);
+                mp_add(p, radix_dec, pt, y, pt);
+            }
+        }
+    }
+    /* ---- pw = R^m, R^(2*m), ..., R^(M/2) ---- */
+    pt = pw;
+    for (t = 0; t < nt; t++) {
+        q = mp_bin2dec_prc(f, m << (t + 1), n_dec);
+        if (t == 0) {
+            mp_load_1(q, radix_dec, pt);
+            mp_bin2dec_pow2(q, radix_dec, pt, log2_radix * m);
+        } else {
+            mp_bin2dec_ext(p, q, &pt[-(p + 2)], pt);
+            mp_squ(q, radix_dec, pt, pt, tmp, mp_bin2dec_nfft(q), 
+                    tmp1fft, tmp2fft, ip, w);
+        }
+        p = q;
+        pt += q + 2;
+    }
+    /* ---- levels: N(j0, 2*m') = N(j0, m') * R^m' + N(j0 + m', m') ---- */
+    pt = pw;
+    for (t = 0; t < nt; t++) {
+        p = mp_bin2dec_prc(f, m << t, n_dec);
+        q = mp_bin2dec_prc(f, m << (t + 1), n_dec);
+        s = s0 << t;
+        for (i = 0; i < nb >> t; i += 2) {
+            in1 = &lv[(size_t) i * s];
+            in2 = &lv[(size_t) (i + 1) * s];
+            y[0] = 0;
+            if (in1[0] != 0) {
+                mp_bin2dec_ext(p, q, in1, y);
+                mp_mul(q, radix_dec, y, pt, y, tmp, mp_bin2dec_nfft(q), 
+                        tmp1fft, tmp2fft, tmp3fft, ip, w);
+            }
+            mp_bin2dec_ext(p, q, in2, in1);
+            if (y[0] != 0) {
+                mp_add(q, radix_dec, in1, y, in1);
+            }
+        }
+        pt += q + 2;
+    }
+    /* ---- x = 1 / R^M ---- */
+    if (nt == 0) {
+        mp_load_1(nf, radix_dec, y);
+        mp_bin2dec_pow2(nf, radix_dec, y, log2_radix * m);
+    } else {
+        pt -= q + 2;
+        mp_bin2dec_ext(q, nf, pt, y);
+        mp_squ(nf, radix_dec, y, y, tmp, mp_bin2dec_nfft(nf), 
+                tmp1fft, tmp2fft, ip, w);
+    }
+    mp_inv(nf, radix_dec, y, x, tmp, z, mp_bin2dec_nfft(nf), 
+            tmp1fft, tmp2fft, ip, w);
+    /* ---- out = sign * R^(in[1] + 1) * N * x ---- */
+    p = mp_bin2dec_prc(f, m << nt, n_dec);
+    mp_bin2dec_ext(p, nf, lv, y);
+    mp_mul(nf, radix_dec, y, x, out, tmp, mp_bin2dec_nfft(nf), 
+            tmp1fft, tmp2fft, tmp3fft, ip, w);
+    mp_bin2dec_pow2(nf, radix_dec, out, log2_radix * (in[1] + 1));
+    out[0] = in[0];
+    free(lv);
+    return 0;
+}
+
+
+/* -------- mp_bin2dec child routines -------- */
+
+
+int mp_bin2dec_prc(double f, int m, int n_dec)
+{
+    int prc;
+    
+    /* ---- N < R^m is exact in f*m+2 digits ---- */
+    prc = (int) (f * m) + 2;
+    if (prc > n_dec + 2) {
+        prc = n_dec + 2;
+    }
+    return prc;
+}
+
+
+int mp_bin2dec_nfft(int n)
+{
+    int nfft;
+    
+    nfft = 8;
+    while (nfft + 2 < n) {
+        nfft <<= 1;
+    }
+    return nfft;
+}
+
+
+void mp_bin2dec_pow2(int n, int radix, int inout[], int e)
+{
+    void mp_imul(int n, int radix, int in1[], int in2, int out[]);
+    int mp_idiv(int n, int radix, int in1[], int in2, int out[]);
+    int k;
+    
+    /* ---- steps of 2^16 (radix * 2^16 < 2^53 in mp_unsgn_i*) ---- */
+    while (e != 0) {
+        k = e < 0 ? -e : e;
+        if (k > 16) {
+            k = 16;
+        }
+        if (e > 0) {
+            mp_imul(n, radix, inout, 1 << k, inout);
+            e -= k;
+        } else {
+            mp_idiv(n, radix, inout, 1 << k, inout);
+            e += k;
+        }
+    }
+}
+
+
+void mp_bin2dec_ext(int p, int q, int in[], int out[])
+{
+    int j;
+    
+    /* ---- out (q digits) = in (p digits), out may overlap in ---- */
+    for (j = 0; j < p + 2; j++) {
+        out[j] = in[j];
+    }
+    for (j = p + 2; j < q + 2; j++) {
+        out[j] = 0;
+    }
+}